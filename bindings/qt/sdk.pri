@@ -37,6 +37,7 @@ SOURCES += src/arguments.cpp \
     src/attrmap.cpp \
     src/backofftimer.cpp \
     src/base64.cpp \
+    src/bufferpool.cpp \
     src/command.cpp \
     src/commands.cpp \
     src/db.cpp \
@@ -441,6 +442,7 @@ HEADERS  += include/mega.h \
             include/mega/attrmap.h \
             include/mega/backofftimer.h \
             include/mega/base64.h \
+            include/mega/bufferpool.h \
             include/mega/command.h \
             include/mega/console.h \
             include/mega/db.h \
@@ -26,6 +26,33 @@ else()
     check_include_file(glob.h HAVE_GLOB_H)
     check_function_exists(aio_write, HAVE_AIO_RT)
 
+    if (USE_IO_URING)
+        # The ring is set up with the raw syscalls, so only the kernel header is needed (no liburing)
+        check_include_file(linux/io_uring.h HAVE_LINUX_IO_URING_H)
+        if (NOT HAVE_LINUX_IO_URING_H)
+            message(WARNING "linux/io_uring.h not found. Disabling USE_IO_URING")
+            set(USE_IO_URING OFF)
+        endif()
+    endif()
+
+    if (USE_EPOLL)
+        check_include_file(sys/epoll.h HAVE_SYS_EPOLL_H)
+        if (NOT HAVE_SYS_EPOLL_H)
+            message(WARNING "sys/epoll.h not found. Disabling USE_EPOLL")
+            set(USE_EPOLL OFF)
+        endif()
+    endif()
+
+    if (USE_FANOTIFY)
+        # Events with the directory handle and the entry name need the headers of Linux 5.9 or later
+        include(CheckSymbolExists)
+        check_symbol_exists(FAN_REPORT_DFID_NAME sys/fanotify.h HAVE_FAN_REPORT_DFID_NAME)
+        if (NOT HAVE_FAN_REPORT_DFID_NAME)
+            message(WARNING "FAN_REPORT_DFID_NAME not found in sys/fanotify.h. Disabling USE_FANOTIFY")
+            set(USE_FANOTIFY OFF)
+        endif()
+    endif()
+
     # Check if our toolchain supports TI emulation mode.
     try_compile(SUPPORTS_TI_EMULATION_MODE
                 "${CMAKE_BINARY_DIR}"
@@ -8,6 +8,11 @@ option(USE_FREEIMAGE "Used to create previews/thumbnails for photos/pictures" ON
 option(USE_FFMPEG "Used to create previews/thumbnails for video files" ON)
 option(USE_LIBUV "Includes the library and turns on internal web and ftp server functionality" OFF)
 option(USE_PDFIUM "Used to create previews/thumbnails for PDF files" ON)
+if (UNIX AND NOT APPLE)
+    option(USE_IO_URING "Use io_uring for asynchronous file reads and writes when the kernel supports it. Otherwise POSIX AIO is used" OFF)
+    option(USE_EPOLL "Use epoll with a persistent interest set to wait for sockets and other file descriptors. Otherwise select() is used" OFF)
+    option(USE_FANOTIFY "Use fanotify to monitor whole filesystems for syncs when permitted (CAP_SYS_ADMIN). Otherwise inotify watches every directory" OFF)
+endif()
 option(USE_C_ARES "If set, the SDK will manage DNS lookups and ipv4/ipv6 itself, using the c-ares library.  Otherwise we rely on cURL" ON)
 if (WIN32 OR IOS)
     option(USE_READLINE "Use the readline library for the console" OFF)
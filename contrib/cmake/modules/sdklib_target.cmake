@@ -16,6 +16,7 @@ set(SDKLIB_HEADERS
     include/mega/thread.h
     include/mega/json.h
     include/mega/base64.h
+    include/mega/bufferpool.h
     include/mega/mega_utf8proc.h
     include/mega/gfx.h
     include/mega/proxy.h
@@ -84,6 +85,7 @@ set(SDKLIB_SOURCES
     src/autocomplete.cpp
     src/backofftimer.cpp
     src/base64.cpp
+    src/bufferpool.cpp
     src/command.cpp
     src/commands.cpp
     src/db.cpp
@@ -219,6 +221,13 @@ target_sources_conditional(SDKlib
     src/posix/net.cpp
 )
 
+target_sources_conditional(SDKlib
+    FLAG USE_IO_URING
+    PRIVATE
+    include/mega/posix/megaiouring.h
+    src/posix/iouring.cpp
+)
+
 target_sources_conditional(SDKlib
     FLAG APPLE
     PRIVATE
@@ -0,0 +1,112 @@
+/**
+ * @file mega/bufferpool.h
+ * @brief Pool of reusable buffers for transfer data
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_BUFFERPOOL_H
+#define MEGA_BUFFERPOOL_H 1
+
+#include "types.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mega {
+
+// Process-wide pool of page-aligned buffers for transfer data (download chunks and RAID pieces).
+// Buffers are grouped in size classes (four per power of two), so chunks of similar sizes reuse
+// the same memory instead of allocating and page-faulting several MB per request.
+// Released buffers are kept idle up to a ceiling, beyond it they are freed, and all of them
+// are freed once the pool hasn't been used for IDLE_TRIM_DELAY (see trimIfIdle()).
+class MEGA_API BufferPool
+{
+public:
+    struct Stats
+    {
+        // acquisitions served from idle buffers / that allocated memory
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        // releases that freed the buffer because of the ceiling
+        uint64_t discards = 0;
+
+        size_t idleBytes = 0;
+        size_t inUseBytes = 0;
+        size_t peakInUseBytes = 0;
+    };
+
+    static constexpr size_t ALIGNMENT = 4096;
+    static const size_t DEFAULT_MAX_IDLE_BYTES;
+    static constexpr std::chrono::seconds IDLE_TRIM_DELAY{30};
+
+    static BufferPool& instance();
+
+    explicit BufferPool(size_t maxIdleBytes = DEFAULT_MAX_IDLE_BYTES);
+    ~BufferPool();
+
+    MEGA_DISABLE_COPY_MOVE(BufferPool)
+
+    // Returns a page-aligned buffer of capacityFor(size) bytes (nullptr if size is 0)
+    byte* acquire(size_t size);
+
+    // Gives back a buffer returned by acquire() (nullptr is ignored)
+    void release(byte* buffer);
+
+    void setMaxIdleBytes(size_t bytes);
+    size_t maxIdleBytes() const;
+
+    // Frees all the idle buffers
+    void trim();
+
+    // Frees all the idle buffers if no buffer was acquired or released during the last
+    // IDLE_TRIM_DELAY, returns whether there were idle buffers to free
+    bool trimIfIdle(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    Stats stats() const;
+
+    // Capacity of the size class for buffers of 'size' bytes
+    static size_t capacityFor(size_t size);
+
+private:
+    static byte* allocate(size_t capacity);
+    static void deallocate(byte* buffer);
+
+    void trimTo(size_t maxIdleBytes);
+
+    mutable std::mutex mMutex;
+
+    // idle buffers by capacity
+    std::map<size_t, std::vector<byte*>> mIdle;
+
+    // capacity of the acquired buffers
+    std::unordered_map<byte*, size_t> mInUse;
+
+    size_t mMaxIdleBytes;
+    Stats mStats;
+
+    // last acquire() or release()
+    std::chrono::steady_clock::time_point mLastUse;
+};
+
+} // namespace
+
+#endif
@@ -63,6 +63,10 @@ public:
     // true if the command processing has been updated to use the URI v3 system, where successful state updates arrive via actionpackets.
     bool mV3 = true;
 
+    // true if the command is a query that never returns a seqtag and whose result doesn't depend on the order
+    // of the other commands of this client, so it can be sent in a batch on a parallel connection (see RequestDispatcher::setPipelining)
+    bool mIndependent = false;
+
     // true if the command returns strings, arrays or objects, but a seqtag is (optionally) also required. In example: ["seqtag"/error, <JSON from before v3>]
     bool mSeqtagArray = false;
 
@@ -140,6 +140,11 @@ private:
                      const byte* key, const size_t keylength, const byte* tag, const size_t taglen, const byte* iv,
                      const size_t ivlen, byte* result, const size_t resultSize);
 
+    // expanded AES-128 key for the AES-NI ctr_crypt() kernel (only set if the CPU supports it)
+    alignas(16) byte mRoundKeys[11 * CryptoPP::AES::BLOCKSIZE] = {};
+
+    void ctr_crypt_aesni(byte* data, unsigned len, byte* ctr, byte* mac, bool encrypt);
+
 public:
     static byte zeroiv[CryptoPP::AES::BLOCKSIZE];
 
@@ -427,6 +432,11 @@ public:
 
     void ctr_crypt(byte *, unsigned, m_off_t, ctr_iv, byte *mac, bool encrypt, bool initmac = true);
 
+    // ctr_crypt() encrypts and computes the chunk MAC in a single pass with AES-NI when the CPU supports it.
+    // The output is identical to the Crypto++ path, which can be forced (for tests and benchmarks) by disabling it.
+    static bool hardwareCtrAvailable();
+    static void setHardwareCtr(bool enable);
+
     static void setint64(int64_t, byte*);
 
     static void xorblock(const byte*, byte*);
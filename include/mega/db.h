@@ -51,9 +51,8 @@ using DBErrorCallback = std::function<void(DBError)>;
 
 class MEGA_API DbTable
 {
-    PrnGen &rng;
-
 protected:
+    PrnGen &rng;
     bool mCheckAlwaysTransacted = false;
     DBTableTransactionCommitter* mTransactionCommitter = nullptr;
     DBErrorCallback mDBErrorCallBack;
@@ -224,6 +223,19 @@ public:
     virtual void updateCounterAndFlags(NodeHandle nodeHandle, uint64_t flags, const std::string& nodeCounterBlob) = 0;
 
     virtual void createIndexes() = 0;
+
+    // Prepare the table for the insertion of a whole tree of nodes: indexes created by createIndexes()
+    // are dropped until it's called again. If relaxedSync is true, durability is relaxed until the next
+    // commit (it must be called out of any transaction)
+    virtual void startBulkLoad(bool relaxedSync) = 0;
+
+    // Counter increased by every change to the nodes (committed or not)
+    virtual uint64_t getNodesVersion() const = 0;
+
+    // Separate read-only connection to the nodes, which can be used from any thread without blocking
+    // writes. It only sees committed changes, so nullptr is returned when there are uncommitted
+    // changes (or no connection is available). 'version' is set to the current getNodesVersion().
+    virtual std::shared_ptr<DBTableNodes> getReadOnlyTable(uint64_t& version) = 0;
 };
 
 class MEGA_API DBTableTransactionCommitter
@@ -151,15 +151,24 @@ public:
     void updateCounter(NodeHandle nodeHandle, const std::string& nodeCounterBlob) override;
     void updateCounterAndFlags(NodeHandle nodeHandle, uint64_t flags, const std::string& nodeCounterBlob) override;
     void createIndexes() override;
+    void startBulkLoad(bool relaxedSync) override;
+    uint64_t getNodesVersion() const override;
+    std::shared_ptr<DBTableNodes> getReadOnlyTable(uint64_t& version) override;
 
+    void commit() override;
+    void abort() override;
     void remove() override;
-    SqliteAccountState(PrnGen &rng, sqlite3*, FileSystemAccess &fsAccess, const mega::LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack);
+    SqliteAccountState(PrnGen &rng, sqlite3*, FileSystemAccess &fsAccess, const mega::LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack, const bool hasFullTextIndex = false);
     void finalise();
     virtual ~SqliteAccountState();
 
     // Callback registered by some long-time running queries, so they can be canceled
     // If the progress callback returns non-zero, the operation is interrupted
     static int progressHandler(void *);
+
+    // Registers the functions and collations used by queries on table 'nodes'
+    static bool registerUserFunctions(sqlite3* db);
+
     static void userRegexp(sqlite3_context* context, int argc, sqlite3_value** argv);
 
     // Method called when query use method 'ismimetype'
@@ -177,6 +186,13 @@ public:
     //(string with the tags delimited by TAG_DELIMITER - argv[1]).
     static void userMatchTag(sqlite3_context* context, int argc, sqlite3_value** argv);
 
+    // True if the table 'nodesfts' (FTS5 with trigram tokenizer) is available and kept in sync
+    bool hasFullTextIndex() const;
+
+    // Enable/disable the use of 'nodesfts' to pre-filter searches by name, description and tags
+    // (the index is kept up to date regardless). Enabled by default when available.
+    void useFullTextIndex(bool enable);
+
 private:
     // Iterate over a SQL query row by row and fill the map
     // Allow at least the following containers:
@@ -202,6 +218,7 @@ private:
     sqlite3_stmt* mStmtNumChildren = nullptr;
     std::map<size_t, sqlite3_stmt*> mStmtGetChildren;
     std::map<size_t, sqlite3_stmt*> mStmtSearchNodes;
+    std::map<size_t, sqlite3_stmt*> mStmtSearchNodesRecursive;
     sqlite3_stmt* mStmtAllNodeTags = nullptr;
 
     /** @deprecated */
@@ -219,14 +236,71 @@ private:
     /** @deprecated */
     sqlite3_stmt* mStmtNodeByMimeTypeExcludeRecursiveFlags = nullptr;
 
+    /** @deprecated */
+    sqlite3_stmt* mStmtNodeByMimeTypeInSubtree = nullptr;
+
     sqlite3_stmt* mStmtNodesByFp = nullptr;
     sqlite3_stmt* mStmtNodeByFp = nullptr;
     sqlite3_stmt* mStmtNodeByOrigFp = nullptr;
     sqlite3_stmt* mStmtChildNode = nullptr;
-    sqlite3_stmt* mStmtIsAncestor = nullptr;
     sqlite3_stmt* mStmtNumChild = nullptr;
     sqlite3_stmt* mStmtRecents = nullptr;
     sqlite3_stmt* mStmtFavourites = nullptr;
+    sqlite3_stmt* mStmtPutNodeFullText = nullptr;
+    sqlite3_stmt* mStmtGetAncestry = nullptr;
+    sqlite3_stmt* mStmtUpdateAncestry = nullptr;
+
+    // Path of handles from the topmost ancestor in DB to the node (see 'ancestry' column)
+    bool getAncestry(NodeHandle nodeHandle, std::string& ancestry);
+
+    // Replaces 'oldPrefix' by 'newPrefix' in the ancestry of every node below 'oldPrefix'
+    bool updateDescendantsAncestry(const std::string& oldPrefix, const std::string& newPrefix);
+
+    // shadow index of 'nodes' (name, description, tags) used to speed up substring searches
+    bool mHasFullTextIndex = false;
+    bool mUseFullTextIndex = true;
+
+    // Binds the full-text query for 'filter' to the parameters 'flagIndex' (0 if index can't be used)
+    // and 'queryIndex'. Only to be called when the statement was built with the full-text condition.
+    int bindFullTextQuery(sqlite3_stmt* stmt, const NodeSearchFilter& filter, int flagIndex, int queryIndex, std::string& query) const;
+
+    // Binds the values of 'nodes.mimetype' matching 'category' to 4 parameters from 'firstIndex'
+    static int bindCategory(sqlite3_stmt* stmt, int category, int firstIndex);
+
+    // SQL condition that keeps only nodes found by the full-text index, when available
+    std::string fullTextCondition(int flagIndex, int queryIndex) const;
+
+    void putFullText(Node* node, const std::string& name, const std::string* description, const std::string* tags);
+
+    // Marks 'nodesfts' as in sync with 'nodes' for the next time the table is opened. Called
+    // before every commit, so the marker is stored along with the changes to both tables.
+    void markFullTextIndexInSync();
+
+    // Value of 'PRAGMA synchronous' to be restored at the end of the transaction of a bulk load
+    // with relaxed sync (-1 if durability isn't relaxed)
+    int mSynchronousToRestore = -1;
+    void restoreSynchronous();
+
+    // Changes to table 'nodes' (see getNodesVersion()), and the last of them already committed
+    std::atomic<uint64_t> mNodesVersion{0};
+    std::atomic<uint64_t> mCommittedNodesVersion{0};
+    void nodesChanged();
+
+    // Read-only connections not in use. Shared with the deleters of the tables returned by
+    // getReadOnlyTable(), so they are given back here when released
+    struct ReadOnlyConnections
+    {
+        std::mutex mMutex;
+        std::vector<std::unique_ptr<SqliteAccountState>> mIdle;
+        size_t mOpened = 0;
+    };
+    std::shared_ptr<ReadOnlyConnections> mReadOnlyConnections = std::make_shared<ReadOnlyConnections>();
+    static const size_t MAX_READ_ONLY_CONNECTIONS = 4;
+
+    std::unique_ptr<SqliteAccountState> openReadOnlyTable();
+
+    // Resets statements left in progress, so the next query doesn't read from an old snapshot
+    void resetStatements();
 
     // how many SQLite instructions will be executed between callbacks to the progress handler
     // (tests with a value of 1000 results on a callback every 1.2ms on a desktop PC)
@@ -259,6 +333,9 @@ public:
 
     const LocalPath& rootPath() const override;
 
+    // Number of times the full-text index of 'nodes' was (re)populated when opening tables
+    unsigned fullTextIndexBuilds() const { return mFullTextIndexBuilds; }
+
 private:
     bool openDBAndCreateStatecache(sqlite3 **db, FileSystemAccess& fsAccess, const string& name, mega::LocalPath &dbPath, const int flags);
     bool renameDBFiles(mega::FileSystemAccess& fsAccess, mega::LocalPath& legacyPath, mega::LocalPath& dbPath);
@@ -335,6 +412,8 @@ private:
         // Method to extract info from NodeData and add it to vector
         std::function<bool(NodeData&, std::vector<std::unique_ptr<MigrateType>>&)>
             migrateOperation;
+        // SQL expression to populate the column from other columns, when it's added
+        string populateExpression = {};
 
         template<typename T>
         static bool extractDataFromNodeData(NodeData& nd,
@@ -350,7 +429,21 @@ private:
     bool addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newCols);
     bool stripExistingColumns(sqlite3* db, vector<NewColumn>& cols);
     bool addColumn(sqlite3* db, const string& name, const string& type);
+    bool populateColumn(sqlite3* db, const string& name, const string& expression);
     bool migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols);
+
+    // Populates 'nodes.ancestry' for rows without it (new column or rows written by older versions)
+    bool populateAncestry(sqlite3* db);
+
+    // Populates 'nodes.mimetype' for rows written by older versions, not aware of the column
+    bool populateMimetype(sqlite3* db);
+
+    // Creates the optional full-text index of 'nodes', and (re)populates it unless it's marked
+    // as valid. Returns false if it's not supported by the SQLite library in use.
+    bool createFullTextIndex(sqlite3* db);
+
+    // Times that createFullTextIndex() had to (re)populate the index
+    unsigned mFullTextIndexBuilds = 0;
 };
 
 class OrderByClause
@@ -359,6 +452,11 @@ public:
     static std::string get(int order, int sqlParamIndex);
     static size_t getId(int order);
 
+    // Condition for nodes sorted after the cursor of a page (keyset pagination), or for all nodes if
+    // the page has no cursor. It uses 5 parameters from 'cursorParamIndex', bound by bindCursor()
+    static std::string getAfterCursor(int order, int sqlParamIndex, int cursorParamIndex);
+    static int bindCursor(sqlite3_stmt* stmt, int order, int cursorParamIndex, const NodeSearchPage& page);
+
 private:
     enum {
         DEFAULT_ASC = 1, DEFAULT_DESC,
@@ -371,6 +469,9 @@ private:
 
     static std::bitset<2> getDescendingDirs(int order);
     static bool isDescOrder(const int order);
+
+    // Value of the attribute to sort by, depending on the order bound at 'sqlParamIndex'
+    static std::string getAttribute(int sqlParamIndex);
 };
 
 } // namespace
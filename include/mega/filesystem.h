@@ -353,6 +353,9 @@ public:
     bool operator!=(const LocalPath& p) const { return localpath != p.localpath; }
     bool operator<(const LocalPath& p) const { return localpath < p.localpath; }
 
+    // consistent with operator==, for hash tables
+    size_t hash() const { return std::hash<string_type>()(localpath); }
+
     // Try to avoid using this function as much as you can.
     //
     // It's present for efficiency reasons and is really only meant for
@@ -835,26 +838,49 @@ struct Notification
         {}
 };
 
-struct NotificationDeque : ThreadSafeDeque<Notification>
+// Filesystem notifications of a sync.  The threads reading them from the OS queue them without
+// taking locks, and the sync thread takes them in batches, where repeats of a notification
+// (same node, path and scan requirement) are collapsed.  The queue is bounded: when it's full,
+// notifications are dropped (and counted), and the sync must be rescanned instead.
+class MEGA_API NotificationQueue
 {
-    void replaceLocalNodePointers(LocalNode* check, LocalNode* newvalue)
-    {
-        std::lock_guard<std::mutex> g(m);
-        for (auto& n : mNotifications)
-        {
-            if (n.localnode == check)
-            {
-                n.localnode = newvalue;
-            }
-        }
-    }
+public:
+    static const size_t DEFAULT_CAPACITY;
+
+    explicit NotificationQueue(size_t capacity = DEFAULT_CAPACITY);
+
+    // Any thread.  Returns false if the queue is full and the notification was dropped
+    bool pushBack(Notification&& n);
+
+    // Sync thread only.  Replaces the contents of 'batch' with up to 'maxCount' queued notifications,
+    // in order and without repeats.  Returns false if there were none
+    bool popBatch(vector<Notification>& batch, size_t maxCount);
+
+    // Sync thread only
+    void replaceLocalNodePointers(LocalNode* check, LocalNode* newvalue);
+
+    bool empty() const;
+    size_t size() const;
+
+    // notifications collapsed into a previous one of their batch / dropped because the queue was full
+    uint64_t coalescedCount() const { return mCoalesced.load(); }
+    uint64_t droppedCount() const { return mDropped.load(); }
+
+private:
+    BoundedMpscQueue<Notification> mQueue;
+
+    std::atomic<uint64_t> mCoalesced{0};
+    std::atomic<uint64_t> mDropped{0};
+
+    // index + 1 in the batch being popped, by hash (open addressing), to find repeats
+    vector<uint32_t> mBatchIndex;
 };
 
 // filesystem change notification, highly coupled to Syncs and LocalNodes.
 struct MEGA_API DirNotify
 {
     // Thread safe so that a separate thread can listen for filesystem notifications (for windows for now, maybe more platforms later)
-    NotificationDeque fsEventq;
+    NotificationQueue fsEventq;
 
 private:
     // these next few fields may be updated by notification-reading threads
@@ -878,7 +904,7 @@ public:
     // base path
     LocalPath localbasepath;
 
-    void notify(NotificationDeque&, LocalNode *, Notification::ScanRequirement, LocalPath&&, bool = false);
+    void notify(NotificationQueue&, LocalNode *, Notification::ScanRequirement, LocalPath&&, bool = false);
 
     DirNotify(const LocalPath& rootPath);
     virtual ~DirNotify() {}
@@ -1112,6 +1138,22 @@ struct MEGA_API FSNode
     bool isBlocked = false;
     FileFingerprint fingerprint; // includes size, mtime
 
+    // Change time (of contents or metadata) in the best precision available, 0 if unknown.
+    // Unlike mtime it can't be set by applications, so it reveals files rewritten keeping their size and mtime
+    m_time_t ctime = 0;
+
+    // Whether the fingerprint of 'known' (an earlier scan of this item) can be reused without reading the file.
+    // It might look like the crc comparison is missing here, but the point is to avoid re-fingerprinting files
+    // when nothing we can see from outside of them has changed
+    bool canReuseFingerprint(const FSNode& known) const
+    {
+        return type == known.type
+            && fsid == known.fsid
+            && fingerprint.mtime == known.fingerprint.mtime
+            && fingerprint.size == known.fingerprint.size
+            && (!ctime || !known.ctime || ctime == known.ctime);
+    }
+
     bool equivalentTo(const FSNode& n) const
     {
         if (type != n.type) return false;
@@ -1146,6 +1188,7 @@ struct MEGA_API FSNode
         f.isSymlink = isSymlink;
         f.isBlocked = isBlocked;
         f.fingerprint = fingerprint;
+        f.ctime = ctime;
         return f;
     }
 
@@ -1241,7 +1284,17 @@ public:
     using RequestPtr = std::shared_ptr<ScanRequest>;
 
     // Issue a scan for the given target.
-    RequestPtr queueScan(LocalPath targetPath, handle expectedFsid, bool followSymlinks, map<LocalPath, FSNode>&& priorScanChildren, shared_ptr<Waiter> waiter);
+    // Requests of different owners (syncs) are served in turns, so a large
+    // sync doesn't delay the scans of the rest.
+    RequestPtr queueScan(LocalPath targetPath, handle expectedFsid, bool followSymlinks, map<LocalPath, FSNode>&& priorScanChildren, shared_ptr<Waiter> waiter, handle owner = UNDEF);
+
+    // Number of threads scanning for all the services (at least 1).
+    // Applies to the running worker too, queued requests are kept.
+    static void setNumThreads(size_t numThreads);
+    static size_t numThreads();
+
+    // Default number of threads, from the number of cores.
+    static size_t defaultNumThreads();
 
     // Track performance (debug only)
     static CodeCounter::ScopeStats syncScanTime;
@@ -1261,32 +1314,44 @@ private:
         MEGA_DISABLE_COPY_MOVE(Worker);
 
         // Queues a scan request for processing.
-        void queue(ScanRequestPtr request);
+        void queue(ScanRequestPtr request, handle owner);
+
+        // Stops the threads once they finish their current scans and starts numThreads new ones.
+        void setNumThreads(size_t numThreads);
 
     private:
         // Thread entry point.
         void loop();
 
         // Processes a scan request.
-        ScanResult scan(ScanRequestPtr request, unsigned& nFingerprinted);
+        ScanResult scan(FileSystemAccess& fsAccess, ScanRequestPtr request, unsigned& nFingerprinted);
 
-        // Filesystem access.
-        std::unique_ptr<FileSystemAccess> mFsAccess;
+        void startThreads(size_t numThreads);
+        void stopThreads();
 
-        // Pending scan requests.
-        std::deque<ScanRequestPtr> mPending;
+        // Pending scan requests by owner.
+        std::map<handle, std::deque<ScanRequestPtr>> mPending;
+
+        // Owners with pending requests, in the order they are served.
+        std::deque<handle> mTurns;
+
+        // Whether the threads should leave.
+        bool mTerminating = false;
 
         // Guards access to the above.
         std::mutex mPendingLock;
         std::condition_variable mPendingNotifier;
 
-        // Worker threads.
+        // Worker threads, each one with its own filesystem access.
         std::vector<std::thread> mThreads;
     }; // Worker
 
     // How many services are currently active.
     static std::atomic<size_t> mNumServices;
 
+    // Threads of the worker.
+    static size_t mNumThreads;
+
     // Worker shared by all services.
     static std::unique_ptr<Worker> mWorker;
 
@@ -205,6 +205,8 @@ public:
     m_off_t lastRequestMeanSpeed() const;
     // Time elapsed since the request started in deciseconds.
     dstime requestElapsedDs() const;
+    // Time from the start of the request to its first data in deciseconds (elapsed time if there is no data yet).
+    dstime requestLatencyDs() const;
 
 private:
     // Values for the circular mean speed
@@ -222,6 +224,7 @@ private:
     m_off_t mRequestPos{}; // Position of the single request.
     dstime mRequestStart{}; // Start time of the single request.
     dstime mLastRequestUpdate{}; // Last time the single request was updated.
+    dstime mRequestFirstData{}; // Time of the first data of the single request (0 if none yet).
 
     // Calculate the total mean speed by aggregating progress (from deciseconds to seconds) over the total time period.
     // Helper method to be called within calculateSpeed(), so the value is assigned to mMeanSpeed, which can be retrieved with getMeanSpeed().
@@ -329,6 +332,10 @@ struct MEGA_API HttpIO : public EventTrigger
 
     virtual bool cacheresolvedurls(const std::vector<string>&, std::vector<string>&&) { return false; }
 
+    // negotiate HTTP/2 and multiplex the requests to the same host over one connection
+    // returns false if the network layer doesn't support it
+    virtual bool sethttp2(bool) { return false; }
+
     HttpIO();
     virtual ~HttpIO() { }
 };
@@ -341,6 +348,9 @@ struct MEGA_API HttpReq
 
     int httpstatus;
 
+    // connections opened to complete the request (0 if an existing one was reused or multiplexed)
+    int mNewConnections = 0;
+
     httpmethod_t method;
     contenttype_t type;
     int timeoutms;
@@ -419,7 +429,7 @@ struct MEGA_API HttpReq
         size_t start;
         size_t end;
 
-        http_buf_t(byte* b, size_t s, size_t e);  // takes ownership of the byte*, which must have been allocated with new[]
+        http_buf_t(byte* b, size_t s, size_t e);  // takes ownership of the byte*, which must have been acquired from the BufferPool
         ~http_buf_t();
         void swap(http_buf_t& other);
         bool isNull() const;
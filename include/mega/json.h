@@ -24,6 +24,8 @@
 
 #include "types.h"
 
+#include <string_view>
+
 namespace mega {
 
 // linear non-strict JSON scanner
@@ -68,6 +70,9 @@ public:
     string getname();
     string getnameWithoutAdvance() const;
 
+    // same as getname(), but the name is not copied (it points into the JSON buffer)
+    std::string_view getnameView();
+
     bool is(const char*);
 
     int storebinary(byte*, int);
@@ -87,10 +92,18 @@ public:
     bool storeKeyValueFromObject(string& key, string& value);
 
     bool storeobject(string* = NULL);
+
+    // same as storeobject(string*), but the value is not copied (it points into the JSON buffer,
+    // so it's only valid while the buffer is alive). Strings don't include the quotes nor are unescaped.
+    bool storeobject(std::string_view& value);
+
     bool skipnullvalue();
 
     static void unescape(string*);
 
+    // Returns 'value' if it has no escaped chars, otherwise the unescaped copy stored in 'buffer'
+    static std::string_view unescape(std::string_view value, string& buffer);
+
     /**
      * @brief Extract a string value for a name in a JSON string
      * @param json JSON string to check
@@ -111,9 +124,21 @@ public:
     // copy JSON-delimited string
     static void copystring(string*, const char*);
 
+    // same as copystring(), without copying
+    static std::string_view stringView(const char*);
+
     // Strip whitspace from a string in a JSON-safe manner.
     static string stripWhitespace(const string& text);
     static string stripWhitespace(const char* text);
+
+    // Returns the closing quote of the string whose content starts at 'p' (escaped chars are skipped)
+    // or nullptr if the string is not terminated
+    static const char* stringEnd(const char* p);
+
+    // Strings are scanned 16 bytes at a time (SSE2) when supported, which is the default.
+    // If disabled, they are scanned byte by byte (mostly to compare both implementations).
+    static bool hasVectorScan();
+    static void useVectorScan(bool enable);
 };
 
 class MEGA_API JSONWriter
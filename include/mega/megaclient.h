@@ -154,6 +154,14 @@ public:
      */
     dstime timeToCached;
 
+    /**
+     * @brief Time until the local database is ready to be queried
+     *
+     * From DB: this time is the same as timeToCached
+     * From API: time until all nodes have been written into the database and its indexes rebuilt
+     */
+    dstime timeToReady;
+
     /**
      * @brief Time until the filesystem is ready to be used
      *
@@ -837,6 +845,9 @@ public:
     // number of parallel connections per transfer (PUT/GET)
     unsigned char connections[2];
 
+    // adapt the number of connections and the request size of new transfers to the link (see TransferConnectionController)
+    bool adaptiveconnections = false;
+
     // helpfer function for preparing a putnodes call for new node
     error putnodes_prepareOneFile(NewNode* newnode, Node* parentNode, const char *utf8Name, const UploadToken& binaryUploadToken,
                                   const byte *theFileKey, const char *megafingerprint, const char *fingerprintOriginal,
@@ -1399,6 +1410,10 @@ private:
     DriveInfoCollector mDriveInfoCollector;
 #endif
     BackoffTimer btcs;
+
+    // retries of each connection of the pipelined batches (see pendingcsPipelined)
+    std::vector<BackoffTimer> btcsPipelined;
+
     BackoffTimer btbadhost;
     BackoffTimer btworkinglock;
     BackoffTimer btreqstat;
@@ -1681,6 +1696,19 @@ public:
     // reqs[r^1] is being processed on the API server
     HttpReq* pendingcs;
 
+    // connections of the pipelined batches of independent commands (see RequestDispatcher::setPipelining)
+    HttpReq* pendingcsPipelined[RequestDispatcher::MAX_PIPELINED_REQUESTS] = {};
+
+    // send the pipelined batches of independent commands and process their responses
+    void execpipelinedcs();
+
+    // reports a cs request that failed the check of the server's public key
+    // returns true if the request must be failed with API_ESSL instead of retried
+    bool csrequestsslerror(const HttpReq& req);
+
+    // URL of an API request
+    string csurl(const string& idempotenceId, bool v3);
+
     // Only queue the "Server busy" event once, until the current cs completes, otherwise we may DDOS
     // ourselves in cases where many clients get 500s for a while and then recover at the same time
     bool pendingcs_serverBusySent = false;
@@ -2352,8 +2380,10 @@ public:
         CodeCounter::ScopeStats syncItemCSF = { "syncItemCSF" };
         CodeCounter::ScopeStats clientThreadActions = { "clientThreadActions" };
 #endif
+        uint64_t csPipelinedRequests = 0;
         uint64_t transferStarts = 0, transferFinishes = 0;
         uint64_t transferTempErrors = 0, transferFails = 0;
+        uint64_t transferConnectionsAdded = 0, transferConnectionsRemoved = 0, transferRequestSizeChanges = 0;
         uint64_t prepwaitImmediate = 0, prepwaitZero = 0, prepwaitHttpio = 0, prepwaitFsaccess = 0, nonzeroWait = 0;
         CodeCounter::DurationSum csRequestWaitTime;
         CodeCounter::DurationSum transfersActiveTime;
@@ -29,11 +29,10 @@
 #include "syncfilter.h"
 #include "backofftimer.h"
 #include <bitset>
+#include <string_view>
 
 namespace mega {
 
-typedef map<LocalPath, LocalNode*> localnode_map;
-
 struct MEGA_API NodeCore
 {
     // node's own handle
@@ -144,6 +143,8 @@ public:
     NodeHandle getNodeHandle() const;
 
     std::list<std::shared_ptr<Node> >::const_iterator mLRUPosition;
+    // memory of the node accounted at cache LRU (estimated when it was inserted)
+    size_t mLRUBytes = 0;
 
 private:
     NodeHandle mNodeHandle;
@@ -362,7 +363,7 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
     } changed;
 
 
-    void setKey(const string& key);
+    void setKey(std::string_view key);
     void setkey(const byte*);
     void setkeyfromjson(const char*);
 
@@ -373,6 +374,10 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
     NodeCounter getCounter() const;
     void setCounter(const NodeCounter &counter);  // to only be called by mNodeManger::setNodeCounter
 
+    // Approximate memory used by the node, including its attributes, shares, keys...
+    // (it's used to keep cache LRU of NodeManager within a budget of bytes)
+    size_t getEstimatedMemoryUsage() const;
+
     // parent
     shared_ptr<Node> parent;
 
@@ -514,6 +519,10 @@ public:
 
     std::unique_ptr<Node> createNode(MegaClient& client, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares);
 
+    // Parse all components in advance, otherwise it's done on demand. It doesn't access any
+    // shared state, so it can be done out of NodeManager's lock (i.e. from worker threads)
+    bool decode() { return !readFailed(); }
+
     enum
     {
         COMPONENT_ALL = -1,
@@ -583,14 +592,195 @@ struct SyncPath;
 
 struct MEGA_API LocalNode;
 
+// Children of a LocalNode by name: an open addressing table (linear probing) of pointers.
+// The names are not copied, the key of each entry is read from the child itself: its
+// localname, or its shortname for the table of shortnames. So a child must be removed
+// before that name changes (LocalNode::setnameparent() takes care of it).
+// Children are iterated in no particular order; insertions and removals invalidate iterators.
+template<typename Child>
+class ChildTable
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Child*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Child* const*;
+        using reference = Child* const&;
+
+        const_iterator(Child* const* slot, Child* const* end)
+          : mSlot(slot), mEnd(end)
+        {
+            skipEmpty();
+        }
+
+        reference operator*() const { return *mSlot; }
+
+        const_iterator& operator++()
+        {
+            ++mSlot;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return mSlot == other.mSlot; }
+        bool operator!=(const const_iterator& other) const { return mSlot != other.mSlot; }
+
+    private:
+        void skipEmpty()
+        {
+            while (mSlot != mEnd && !*mSlot) ++mSlot;
+        }
+
+        Child* const* mSlot;
+        Child* const* mEnd;
+    };
+
+    using iterator = const_iterator;
+
+    explicit ChildTable(bool byShortname = false)
+      : mByShortname(byShortname)
+    {
+    }
+
+    MEGA_DISABLE_COPY_MOVE(ChildTable)
+
+    const_iterator begin() const { return const_iterator(mSlots.get(), mSlots.get() + capacity()); }
+    const_iterator end() const { return const_iterator(mSlots.get() + capacity(), mSlots.get() + capacity()); }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return !mSize; }
+
+    // child with that name, or nullptr
+    Child* find(const LocalPath& name) const
+    {
+        return mSize ? mSlots[slotOf(name)] : nullptr;
+    }
+
+    // adds the child, replacing the one with the same name if any
+    void set(Child* child)
+    {
+        assert(child);
+
+        // keep the load factor under 3/4
+        if (!mSlots || (size_t(mSize) + 1) * 4 > capacity() * 3)
+        {
+            rehash(mSlots ? mCapacityLog2 + 1u : 2u);
+        }
+
+        size_t i = slotOf(keyOf(child));
+        if (!mSlots[i])
+        {
+            ++mSize;
+        }
+        mSlots[i] = child;
+    }
+
+    // removes the entry of the child's name, only if it is that child
+    bool erase(const Child* child)
+    {
+        if (!mSize)
+        {
+            return false;
+        }
+
+        size_t i = slotOf(keyOf(child));
+        if (mSlots[i] != child)
+        {
+            return false;
+        }
+
+        mSlots[i] = nullptr;
+        --mSize;
+
+        // shift back the following entries of the run that would not be found past the hole anymore
+        size_t mask = capacity() - 1;
+        for (size_t j = (i + 1) & mask; mSlots[j]; j = (j + 1) & mask)
+        {
+            size_t home = keyOf(mSlots[j]).hash() & mask;
+            bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (!reachable)
+            {
+                mSlots[i] = mSlots[j];
+                mSlots[j] = nullptr;
+                i = j;
+            }
+        }
+
+        if (!mSize)
+        {
+            mSlots.reset();
+            mCapacityLog2 = 0;
+        }
+        else if (mCapacityLog2 > 2 && size_t(mSize) * 8 < capacity())
+        {
+            rehash(mCapacityLog2 - 1u);
+        }
+
+        return true;
+    }
+
+    // the table's own size plus its slots
+    size_t allocatedBytes() const { return sizeof(*this) + capacity() * sizeof(Child*); }
+
+private:
+    size_t capacity() const { return mSlots ? size_t(1) << mCapacityLog2 : 0; }
+
+    const LocalPath& keyOf(const Child* child) const
+    {
+        assert(!mByShortname || child->slocalname);
+        return mByShortname ? *child->slocalname : child->localname;
+    }
+
+    // slot holding that name, or the empty one where it would go
+    size_t slotOf(const LocalPath& name) const
+    {
+        size_t mask = capacity() - 1;
+        size_t i = name.hash() & mask;
+
+        // the table is never full, so there's always an empty slot to stop at
+        while (mSlots[i] && !(keyOf(mSlots[i]) == name))
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash(unsigned capacityLog2)
+    {
+        size_t oldCapacity = capacity();
+        auto oldSlots = std::move(mSlots);
+
+        mCapacityLog2 = static_cast<uint8_t>(capacityLog2);
+        mSlots = std::make_unique<Child*[]>(size_t(1) << capacityLog2);
+
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+            if (oldSlots[i])
+            {
+                mSlots[slotOf(keyOf(oldSlots[i]))] = oldSlots[i];
+            }
+        }
+    }
+
+    std::unique_ptr<Child*[]> mSlots;
+    uint32_t mSize = 0;
+    uint8_t mCapacityLog2 = 0;
+    bool mByShortname;
+};
+
+typedef ChildTable<LocalNode> localnode_map;
+
 struct MEGA_API LocalNodeCore
   : public Cacheable
 {
     // deserialize attributes from binary storage.
     bool read(const string& source, uint32_t& parentID);
 
-    // serialize attributes to binary for storage.
-    bool write(string& destination, uint32_t parentID) const;
+    // serialize attributes to binary for storage, with the as-scanned details of files if valid
+    bool write(string& destination, uint32_t parentID, handle scannedFsid, const FileFingerprint& scannedFingerprint) const;
 
     // local filesystem node ID (inode...) for rename/move detection
     handle fsid_lastSynced = ::mega::UNDEF;
@@ -622,6 +812,19 @@ struct MEGA_API LocalNodeCore
     // This is so users can, for example, change uppercase/lowercase and have that synchronized.
     bool namesSynchronized = false;
 
+    // Change time of the file as of the last scan (0 if unknown), stored with the as-scanned details
+    // so that the first scan after a restart only re-fingerprints the files that changed meanwhile
+    m_time_t scannedCtime = 0;
+
+    // As-scanned fsid and fingerprint loaded from the db when they differ from the synced ones
+    // (otherwise only scannedCtime is loaded). Consumed by the first scan of the parent folder.
+    struct ScannedDetails
+    {
+        handle fsid = ::mega::UNDEF;
+        FileFingerprint fingerprint;
+    };
+    unique_ptr<ScannedDetails> scannedFromDb;
+
 }; // LocalNodeCore
 
 struct MEGA_API LocalNode
@@ -631,10 +834,10 @@ struct MEGA_API LocalNode
 
     // UTF8 NFC version of LocalNodeCore::localname.
     // Not serialized.
-    // Should be updated whenever localname is.
+    // Updated by setnameparent() and init() along with localname.
     // Does not match the corresponding Node's name,
     // as escapes/case may be involved.
-    string toName_of_localname;
+    const string& toName_of_localname() const;
 
     // parent linkage
     LocalNode* parent = nullptr;
@@ -643,7 +846,7 @@ struct MEGA_API LocalNode
     localnode_map children;
 
     unique_ptr<LocalPath> cloneShortname() const;
-    localnode_map schildren;
+    localnode_map schildren{true};
 
     // The last scan of the folder (for folders).
     // Removed again when the folder is fully synced.
@@ -924,7 +1127,7 @@ struct MEGA_API LocalNode
     void updateMoveInvolvement();
 
     void setSyncedFsid(handle newfsid, fsid_localnode_map& fsidnodes, const LocalPath& fsName, std::unique_ptr<LocalPath> newshortname);
-    void setScannedFsid(handle newfsid, fsid_localnode_map& fsidnodes, const LocalPath& fsName, const FileFingerprint& scanfp);
+    void setScannedFsid(handle newfsid, fsid_localnode_map& fsidnodes, const LocalPath& fsName, const FileFingerprint& scanfp, m_time_t scanctime = 0);
 
     void setSyncedNodeHandle(NodeHandle h);
 
@@ -1013,6 +1216,12 @@ public:
 private:
     unique_ptr<RareFields> rareFields;
 
+    // Sets toName_of_localname from localname
+    void updateToNameOfLocalname();
+
+    // toName_of_localname, only when it's not the same string as localname (always on Windows)
+    unique_ptr<string> mToNameOfLocalname;
+
 #ifdef USE_INOTIFY
     class WatchHandle
     {
@@ -1038,6 +1247,11 @@ private:
 
 public:
     WatchHandle mWatchHandle;
+
+#ifdef USE_FANOTIFY
+    // fsid of this directory when its changes were found to be reported by fanotify
+    handle mFanotifyFsid = UNDEF;
+#endif // USE_FANOTIFY
 #endif // USE_INOTIFY
 };
 
@@ -19,12 +19,16 @@
  * program.
  */
 
+#include <condition_variable>
+#include <deque>
 #include <thread>
 #ifndef NODEMANAGER_H
 #define NODEMANAGER_H 1
 
 #include <map>
 #include <limits>
+#include <list>
+#include <mutex>
 #include <set>
 #include <vector>
 #include "node.h"
@@ -108,16 +112,140 @@ private:
     std::string mTagFilter;
 };
 
+// Sort keys of a node, as stored in DB. A page of results can start right after it (keyset
+// pagination), so previous results don't need to be sorted and skipped again for every page
+struct NodeSearchCursor
+{
+    NodeSearchCursor() = default;
+    explicit NodeSearchCursor(const Node& node);
+
+    handle nodeHandle = UNDEF;
+    nodetype_t type = TYPE_UNKNOWN;
+    std::string name;
+    m_off_t size = 0;
+    m_time_t ctime = 0;
+    m_time_t mtime = 0;
+    int label = LBL_UNKNOWN;
+    bool fav = false;
+};
+
 class NodeSearchPage
 {
 public:
     NodeSearchPage(size_t startingOffset, size_t size) : mOffset(startingOffset), mSize(size) {}
+
+    // The page starts after the node of the cursor ('startingOffset' is counted from there)
+    NodeSearchPage(const NodeSearchCursor& cursor, size_t size) : mOffset(0), mSize(size), mCursor(cursor) {}
+
     const size_t& startingOffset() const { return mOffset; }
     const size_t& size() const { return mSize; }
+    bool hasCursor() const { return mCursor.nodeHandle != UNDEF; }
+    const NodeSearchCursor& cursor() const { return mCursor; }
 
 private:
     size_t mOffset;
     size_t mSize;
+    NodeSearchCursor mCursor;
+};
+
+// Children of folders projected as CloudNodes, for the syncs to revisit folders
+// without loading their child Nodes (and without the node tree mutex).
+// Entries are invalidated whenever the NodeManager sees a change in the children
+// or their names/fingerprints, and the least recently used ones are dropped beyond
+// a limit in number of children.
+class MEGA_API CloudChildrenCache
+{
+public:
+    static const size_t DEFAULT_MAX_NODES;
+
+    explicit CloudChildrenCache(size_t maxNodes = DEFAULT_MAX_NODES);
+
+    // Copies the cached children of 'parent' into 'children'
+    bool get(NodeHandle parent, vector<CloudNode>& children);
+
+    // Take it before reading children from the node tree, to pass it to put()
+    uint64_t generation() const;
+
+    // Stores the children of 'parent', unless there was any invalidation
+    // since 'generation' was taken (they could be outdated already)
+    void put(NodeHandle parent, const vector<CloudNode>& children, uint64_t generation);
+
+    // The children of 'parent' changed
+    void invalidate(NodeHandle parent);
+
+    void clear();
+
+    void setMaxNodes(size_t maxNodes);
+    size_t maxNodes() const;
+
+    // Number of children cached, for all the folders
+    size_t numNodes() const;
+
+    uint64_t hits() const { return mHits; }
+    uint64_t misses() const { return mMisses; }
+
+private:
+    struct Entry
+    {
+        vector<CloudNode> children;
+        std::list<NodeHandle>::iterator lruPosition;
+    };
+
+    void trimTo(size_t maxNodes);
+
+    mutable std::mutex mMutex;
+
+    std::map<NodeHandle, Entry> mEntries;
+
+    // most recently used first
+    std::list<NodeHandle> mLRU;
+
+    size_t mNumNodes = 0;
+    size_t mMaxNodes;
+    uint64_t mGeneration = 0;
+
+    std::atomic<uint64_t> mHits{0};
+    std::atomic<uint64_t> mMisses{0};
+};
+
+// Threads kept alive to decode serialized nodes in parallel, for big results from the DB
+// (see NodeManager::setUnserializationThreads()). Callers of decode() take part too.
+class MEGA_API NodeDecodePool
+{
+public:
+    NodeDecodePool() = default;
+    ~NodeDecodePool();
+
+    MEGA_DISABLE_COPY_MOVE(NodeDecodePool)
+
+    // Threads in addition to the callers of decode()
+    void setNumThreads(unsigned numThreads);
+
+    // Decodes 'nodes' and returns when all of them are done (or it's cancelled). Any thread can call it
+    void decode(const std::vector<NodeData*>& nodes, CancelToken cancelFlag);
+
+private:
+    struct Job
+    {
+        Job(const std::vector<NodeData*>& n, CancelToken c) : nodes(n), cancelFlag(c) {}
+
+        const std::vector<NodeData*>& nodes;
+        CancelToken cancelFlag;
+        std::atomic<size_t> next{0};
+
+        // threads of the pool working on it, guarded by mMutex
+        unsigned workers = 0;
+    };
+
+    static void run(Job& job);
+    void threadLoop();
+    void stop();
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Job*> mJobs;
+    std::vector<std::thread> mThreads;
+    bool mStopping = false;
 };
 
 /**
@@ -279,7 +407,7 @@ public:
     // write all nodes into DB (used for migration from legacy to NOD DB schema)
     void dumpNodes();
 
-    // This method only can be used in Megacli for testing purposes
+    // Number of Node objects alive (at cache LRU or referenced from elsewhere)
     uint64_t getNumberNodesInRam() const;
 
     // Add new relationship between parent and child
@@ -304,6 +432,15 @@ public:
     // Initialize node counters and create indexes at DB
     void initCompleted();
 
+    // This method is called before a whole tree of nodes is received from servers (fetchnodes)
+    // Indexes at DB are dropped until initCompleted(). It must be called out of any transaction
+    void startBulkLoad();
+
+    // If enabled, DB durability is relaxed (PRAGMA synchronous=OFF) during the bulk load of
+    // nodes, until the first commit. Disabled by default
+    bool getBulkLoadRelaxedSync() const;
+    void setBulkLoadRelaxedSync(bool enable);
+
     std::shared_ptr<Node> getNodeFromNodeManagerNode(NodeManagerNode& nodeManagerNode);
 
     void insertNodeCacheLRU(std::shared_ptr<Node> node);
@@ -316,9 +453,29 @@ public:
 
     uint64_t getNumNodesAtCacheLRU() const;
 
+    // Number of threads used to decode nodes loaded from DB in big batches (search, children...)
+    // Nodes are still created and inserted into RAM/LRU sequentially. 0 or 1 disables it
+    unsigned getUnserializationThreads() const;
+    void setUnserializationThreads(unsigned numThreads);
+
+    // Limit for the estimated memory of nodes at cache LRU, in bytes (applied in addition to the
+    // limit in number of nodes)
+    uint64_t getCacheLRUMaxBytes() const;
+    void setCacheLRUMaxBytes(uint64_t cacheLRUMaxBytes);
+
+    // Estimated memory of the nodes at cache LRU, in bytes
+    uint64_t getCacheLRUBytes() const;
+
+    // Number of lookups by handle resolved with nodes in RAM (hits) or loading them from DB (misses)
+    uint64_t getNodeByHandleHits() const;
+    uint64_t getNodeByHandleMisses() const;
+
     // true when the filesystem has been initialized
     bool ready();
 
+    // Projection of the children of folders used by the syncs
+    CloudChildrenCache& cloudChildrenCache() { return mCloudChildrenCache; }
+
 private:
     MegaClient& mClient;
 
@@ -367,7 +524,22 @@ private:
     std::map<NodeHandle, NodeManagerNode> mNodes;
 
     uint64_t mCacheLRUMaxSize = std::numeric_limits<uint64_t>::max();
+    uint64_t mCacheLRUMaxBytes = std::numeric_limits<uint64_t>::max();
     std::list<std::shared_ptr<Node> > mCacheLRU;
+    // sum of NodeManagerNode::mLRUBytes of nodes at mCacheLRU
+    uint64_t mCacheLRUBytes = 0;
+
+    std::atomic<uint64_t> mNodeByHandleHits{0};
+    std::atomic<uint64_t> mNodeByHandleMisses{0};
+
+    // threads to unserialize nodes loaded in bulk (the calling thread included)
+    std::atomic<unsigned> mUnserializationThreads{0};
+    NodeDecodePool mDecodePool;
+
+    std::atomic<bool> mBulkLoadRelaxedSync{false};
+
+    // it has its own mutex, it can be used without mMutex
+    CloudChildrenCache mCloudChildrenCache;
 
     std::atomic<uint64_t> mNodesInRam;
 
@@ -391,10 +563,17 @@ private:
     void updateTreeCounter(std::shared_ptr<Node> origin, NodeCounter nc, OperationType operation, sharedNode_vector* nodesToReport);
 
     // returns nullptr if there are unserialization errors. Also triggers a full reload (fetchnodes)
-    shared_ptr<Node> getNodeFromNodeSerialized(const NodeSerialized& nodeSerialized);
+    // If provided, 'nodeData' must come from 'nodeSerialized' (it may have been decoded already)
+    shared_ptr<Node> getNodeFromNodeSerialized(const NodeSerialized& nodeSerialized, NodeData* nodeData = nullptr);
 
     // reads from DB and loads the node in memory
     shared_ptr<Node> unserializeNode(const string*, bool fromOldCache);
+    shared_ptr<Node> unserializeNode(NodeData& nodeData, bool fromOldCache);
+
+    // Decodes the nodes (only the ones not loaded in RAM yet, if 'onlyNotInRAM', which requires mMutex)
+    // in parallel, when enabled and worth it. Returned vector is aligned with 'nodesFromTable' (null
+    // entries for nodes to be decoded on demand)
+    std::vector<std::unique_ptr<NodeData>> decodeNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, bool onlyNotInRAM, CancelToken cancelFlag);
 
     // returns the counter for the specified node, calculating it recursively and accessing to DB if it's neccesary
     NodeCounter calculateNodeCounter(const NodeHandle &nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish);
@@ -412,13 +591,44 @@ private:
     // Avoid loading nodes whose ancestor is not ancestorHandle. If ancestorHandle is undef load all nodes
     // If a valid cancelFlag is passed and takes true value, this method returns without complete operation
     // If a valid object is passed, it must be kept alive until this method returns.
-    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, NodeHandle ancestorHandle = NodeHandle(), CancelToken cancelFlag = CancelToken());
+    // If provided, 'nodesData' comes from decodeNodes()
+    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, NodeHandle ancestorHandle = NodeHandle(), CancelToken cancelFlag = CancelToken(), std::vector<std::unique_ptr<NodeData>>* nodesData = nullptr);
+
+    // Result of a query run on a read-only connection to the DB (see queryReadOnlyTable())
+    struct ReadOnlyQuery
+    {
+        DBTableNodes* table = nullptr;
+        uint64_t version = 0;
+        bool succeeded = false;
+    };
+
+    // Runs a query on a separate read-only connection to the DB, if available, so other threads aren't
+    // blocked by long searches. Called from the public methods before taking mMutex (it's only taken
+    // to get the connection). Its results can be used under mMutex if isCurrent() is true.
+    ReadOnlyQuery queryReadOnlyTable(const std::function<bool(DBTableNodes&)>& query);
+
+    // True if the query succeeded and the nodes haven't changed since it was run
+    bool isCurrent(const ReadOnlyQuery& query) const;
+
+    // Nodes read from a read-only connection, and decoded, before taking mMutex
+    struct PrefetchedNodes
+    {
+        std::vector<std::pair<NodeHandle, NodeSerialized>> nodesFromTable;
+
+        // see decodeNodes()
+        std::vector<std::unique_ptr<NodeData>> nodesData;
+    };
+
+    // Runs the query on a read-only connection and decodes its results, without mMutex
+    ReadOnlyQuery prefetchNodes(PrefetchedNodes& prefetched, const std::function<bool(DBTableNodes&, std::vector<std::pair<NodeHandle, NodeSerialized>>&)>& query, CancelToken cancelFlag);
 
-    sharedNode_vector searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
-    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag);
-    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
+    // The methods below receive the results of the query if it was run on a read-only connection and
+    // they are still current (otherwise nullptr, and the query is run on mTable)
+    sharedNode_vector searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, PrefetchedNodes* prefetched);
+    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag, std::vector<std::unique_ptr<NodeData>>* nodesData = nullptr);
+    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, PrefetchedNodes* prefetched);
 
-    std::set<std::string> getAllNodeTags_internal(const char* searchString, CancelToken cancelFlag);
+    std::set<std::string> getAllNodeTags_internal(const char* searchString, CancelToken cancelFlag, std::set<std::string>* tagsFromReadOnlyTable);
 
     // node temporary in memory, which will be removed upon write to DB
     std::shared_ptr<Node> mNodeToWriteInDb;
@@ -458,7 +668,7 @@ private:
     sharedNode_vector getPublicLinksWithName_internal(const char *searchString, CancelToken cancelFlag);
 
     sharedNode_vector getNodesByFingerprint_internal(FileFingerprint& fingerprint);
-    sharedNode_vector getNodesByOrigFingerprint_internal(const std::string& fingerprint, Node *parent);
+    sharedNode_vector getNodesByOrigFingerprint_internal(const std::string& fingerprint, Node *parent, PrefetchedNodes* prefetched);
     std::shared_ptr<Node> getNodeByFingerprint_internal(FileFingerprint &fingerprint);
     std::shared_ptr<Node> childNodeByNameType_internal(const Node *parent, const std::string& name, nodetype_t nodeType);
     sharedNode_vector getRootNodes_internal();
@@ -181,9 +181,11 @@ public:
 
     ~PosixFileAccess();
 
-#ifdef HAVE_AIO_RT
+#if defined(HAVE_AIO_RT) || defined(USE_IO_URING)
 protected:
     AsyncIOContext* newasynccontext() override;
+#endif
+#ifdef HAVE_AIO_RT
     static void asyncopfinished(union sigval sigev_value);
 #endif
 
@@ -226,6 +228,47 @@ private:
     // Tracks which nodes are associated with what inotify handle.
     WatchMap mWatches;
 
+#ifdef USE_FANOTIFY
+    // A filesystem marked for fanotify events, shared by the notifiers below it.
+    struct FanotifyFilesystem
+    {
+        // Any descriptor on the filesystem, for open_by_handle_at().
+        int mountFd = -1;
+
+        // Mount of mountFd: paths of events are only meaningful to notifiers on it.
+        int mountId = 0;
+
+        // How many notifiers use the mark.
+        unsigned users = 0;
+    };
+
+    // Reads the fanotify events and notifies the syncs they're below.
+    int checkFanotifyEvents();
+
+    // Marks the filesystem containing path (if not marked yet).
+    // Fails if it's marked through a different mount.
+    bool addFanotifyFilesystem(const string& path, uint64_t& fsid);
+
+    // Removes the mark of a filesystem once no notifier uses it.
+    void removeFanotifyFilesystem(uint64_t fsid);
+
+    // Whether the filesystem fsid, containing path, is marked through the mount of path.
+    bool fanotifyFilesystemMarked(const string& path, uint64_t fsid) const;
+
+    // Path of the directory with that handle, from the cache or the kernel.
+    bool fanotifyDirectoryPath(uint64_t fsid, file_handle& handle, LocalPath& path);
+
+    // Fanotify descriptor, reporting the changes of whole filesystems (where permitted).
+    int mFanotifyFd = -1;
+
+    // Marked filesystems, by fsid.
+    map<uint64_t, FanotifyFilesystem> mFanotifyFilesystems;
+
+    // Paths of the directories resolved from their handles recently.
+    // Cleared whenever a directory is moved or deleted.
+    std::unordered_map<string, LocalPath> mFanotifyDirectories;
+#endif // USE_FANOTIFY
+
 #endif // ENABLE_SYNC
 }; // LinuxFileSystemAccess
 
@@ -250,12 +293,37 @@ public:
 
     void removeWatch(WatchMapIterator entry);
 
+#ifdef USE_FANOTIFY
+    // Whether changes below the root are reported by fanotify (no per-directory watches).
+    bool usesFanotify() const { return !mFanotifyFilesystems.empty(); }
+
+    // Whether fanotify reports the changes of the directory at path. Marks its filesystem
+    // if it was mounted below the root after the sync started. Otherwise, it needs a watch.
+    bool fanotifyCovers(const LocalPath& path);
+
+    // Notifies a fanotify event about the entry 'name' of the directory 'dirPath', if it's below the root.
+    int notifyFanotifyEvent(const LocalPath& dirPath, const char* name, uint64_t mask);
+#endif // USE_FANOTIFY
+
 private:
     // The LFSA that we are associated with.
     LinuxFileSystemAccess& mOwner;
 
     // Our position in our owner's mNotifiers list.
     list<DirNotify*>::iterator mNotifiersIt;
+
+#ifdef USE_FANOTIFY
+    // Marks the filesystems of the root and of the mounts below it (all or none).
+    void useFanotify(const LocalPath& rootPath);
+
+    LocalNode& mRoot;
+
+    // The root without symlinks, as the kernel reports paths.
+    LocalPath mCanonicalRoot;
+
+    // Filesystems marked for us.
+    vector<uint64_t> mFanotifyFilesystems;
+#endif // USE_FANOTIFY
 }; // LinuxDirNotify
 
 #endif // ENABLE_SYNC
@@ -0,0 +1,111 @@
+/**
+ * @file mega/posix/megaiouring.h
+ * @brief Linux io_uring backend for asynchronous file reads and writes
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#ifndef MEGA_POSIX_IOURING_H
+#define MEGA_POSIX_IOURING_H 1
+
+#ifdef USE_IO_URING
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "mega/filesystem.h"
+
+namespace mega {
+
+struct MEGA_API IoUringAsyncIOContext : public AsyncIOContext
+{
+    ~IoUringAsyncIOContext() override;
+    void finish() override;
+
+    // buffer of the queued operation (must be alive until it completes)
+    struct iovec iov = {};
+
+    // true while the operation is queued in the ring
+    bool inflight = false;
+};
+
+// Process-wide io_uring shared by all the PosixFileAccess objects.
+// The ring is set up directly with the io_uring syscalls (no liburing) and a single
+// thread reaps the completions, marks the contexts as finished and calls their
+// userCallback, which wakes up the client Waiter, like the POSIX AIO completions do.
+class MEGA_API IoUring
+{
+public:
+    // Returns the ring, or nullptr if the kernel doesn't support io_uring
+    // (old kernel, disabled by sysctl or blocked by seccomp in containers)
+    static IoUring* instance();
+
+    // Queues the read or write described by 'context' on 'fd'.
+    // If it can't be queued, the context is finished as failed right away.
+    void submit(int fd, IoUringAsyncIOContext* context);
+
+    ~IoUring();
+
+private:
+    IoUring() = default;
+
+    bool init(unsigned entries);
+    void reap();
+    void complete(IoUringAsyncIOContext* context, int result);
+    bool enter(unsigned toSubmit, unsigned minComplete, unsigned flags);
+
+    int mRingFd = -1;
+
+    // mmapped rings
+    void* mSqRing = nullptr;
+    size_t mSqRingSize = 0;
+    void* mCqRing = nullptr;
+    size_t mCqRingSize = 0;
+    void* mSqes = nullptr;
+    size_t mSqesSize = 0;
+
+    // submission queue (written under mSubmitMutex)
+    unsigned* mSqHead = nullptr;
+    unsigned* mSqTail = nullptr;
+    unsigned* mSqMask = nullptr;
+    unsigned* mSqArray = nullptr;
+    unsigned mSqEntries = 0;
+
+    // completion queue (only read by the reaper thread)
+    unsigned* mCqHead = nullptr;
+    unsigned* mCqTail = nullptr;
+    unsigned* mCqMask = nullptr;
+    void* mCqes = nullptr;
+    unsigned mCqEntries = 0;
+
+    std::mutex mSubmitMutex;
+
+    // operations queued and not reaped yet, kept below mCqEntries so completions are never dropped
+    std::atomic<unsigned> mInflight{0};
+
+    std::atomic<bool> mExit{false};
+    std::thread mReaper;
+};
+
+} // namespace
+
+#endif // USE_IO_URING
+
+#endif
@@ -54,6 +54,11 @@ struct MEGA_API SockInfo
     curl_socket_t fd = curl_socket_t(-1);
     int mode = NONE;
 
+#ifdef USE_EPOLL
+    // mode registered in the persistent interest set of the waiter
+    int watched = NONE;
+#endif
+
 #if defined(_WIN32)
     SockInfo(const SockInfo&) = delete;
     void operator=(const SockInfo&) = delete;
@@ -192,6 +197,9 @@ protected:
     void addcurlevents(Waiter *waiter, direction_t d);
     int checkevents(Waiter*) override;
     void closecurlevents(direction_t d);
+#ifdef USE_EPOLL
+    void unwatchcurlsocket(SockInfo& info);
+#endif
     void processcurlevents(direction_t d);
     SockInfoMap curlsockets[3];
     m_time_t curltimeoutreset[3];
@@ -201,6 +209,10 @@ protected:
     m_off_t partialdata[2];
     m_off_t maxspeed[2];
 
+    // HTTP/2 with multiplexing (opt-in), otherwise HTTP/1.1
+    bool http2 = false;
+    void setmultiplexing();
+
 public:
     void post(HttpReq*, const char* = 0, unsigned = 0) override;
     void cancel(HttpReq*) override;
@@ -233,6 +245,8 @@ public:
 
     bool cacheresolvedurls(const std::vector<string>& urls, std::vector<string>&& ips) override;
 
+    bool sethttp2(bool enable) override;
+
     CurlHttpIO();
     ~CurlHttpIO();
 
@@ -111,13 +111,17 @@
     #include <sys/inotify.h>
 #endif
 
+#ifdef USE_FANOTIFY
+    #include <sys/fanotify.h>
+#endif
+
 #include <sys/select.h>
 
 #include <curl/curl.h>
 #include <stdexcept>
 
 
-#ifndef USE_POLL
+#if !defined(USE_POLL) && !defined(USE_EPOLL)
 #ifndef FD_COPY
 #define FD_COPY(s, d) ( memcpy(( d ), ( s ), sizeof( fd_set )))
 #endif
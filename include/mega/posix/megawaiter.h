@@ -23,9 +23,15 @@
 #define WAIT_CLASS PosixWaiter
 
 #include "mega/waiter.h"
+#include <map>
 #include <mutex>
+#include <vector>
 
-#ifndef USE_POLL
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#if !defined(USE_POLL) && !defined(USE_EPOLL)
     #define MEGA_FD_ZERO FD_ZERO
     #define MEGA_FD_SET FD_SET
     #define MEGA_FD_ISSET FD_ISSET
@@ -54,7 +60,7 @@ struct PosixWaiter : public Waiter
     mega_fd_set_t rfds, wfds, efds;
     mega_fd_set_t ignorefds;
 
-#ifdef USE_POLL
+#if defined(USE_POLL) || defined(USE_EPOLL)
 
     static void clear_fdset(mega_fd_set_t *s)
     {
@@ -78,10 +84,42 @@ struct PosixWaiter : public Waiter
 
     void notify();
 
+    // Persistent interest set: a watched fd is waited for in every cycle until it's unwatched,
+    // without being added to rfds/wfds again, and it's reported in rfds/wfds when it's ready.
+    // With epoll, only the changes reach the kernel and wait() only processes the ready fds.
+    void watch(int fd, bool read, bool write);
+    void unwatch(int fd);
+
+    // Switches between epoll and poll() (epoll is used by default if available),
+    // returns whether epoll is in use
+    bool useEpoll(bool enable);
+
 protected:
     int m_pipe[2];
     std::mutex mMutex;
     bool alreadyNotified = false;
+
+    enum { WATCH_READ = 1, WATCH_WRITE = 2 };
+
+    // watched fds and their WATCH_* flags
+    std::map<int, int> mWatched;
+
+    // empties the notification pipe, returns true if notify() was called
+    bool drainpipe();
+
+#ifdef USE_EPOLL
+    int mEpollFd = -1;
+
+    // fds registered in the epoll instance, and fds added to rfds/wfds/efds in the last cycle, with their events
+    std::map<int, uint32_t> mRegistered;
+    std::map<int, uint32_t> mCycleFds;
+
+    std::vector<struct epoll_event> mEvents;
+
+    uint32_t epollEvents(int fd) const;
+    bool updateEpoll(int fd, uint32_t events, bool force = false);
+    int waitEpoll(int timeoutMs);
+#endif
 };
 } // namespace
 
@@ -34,6 +34,13 @@ namespace mega {
     enum { RAIDSECTOR = 16 };
     enum { RAIDLINE = (EFFECTIVE_RAIDPARTS * RAIDSECTOR) };
 
+    // Assembles 'lines' RAID lines into 'dest' from the parts (0 is parity, 1-5 data), whose sectors are consecutive.
+    // One data part can be null: its sectors are recovered from the parity and the other data parts.
+    void combineRaidLines(byte* dest, const byte* const parts[RAIDPARTS], size_t lines);
+
+    // Recovers data sector 'missing' (0-4) of 'lines' consecutive assembled RAID lines in place, from their parity sectors.
+    void recoverRaidLines(byte* data, const byte* parity, unsigned missing, size_t lines);
+
 
     // Holds the latest download data received.   Raid-aware.   Suitable for file transfers, or direct streaming.
     // For non-raid files, supplies the received buffer back to the same connection for writing to file (having decrypted and mac'd it),
@@ -208,7 +215,6 @@ namespace mega {
         // take raid input part buffers and combine to form the asyncoutputbuffers
         void combineRaidParts(unsigned connectionNum);
         FilePiece* combineRaidParts(size_t partslen, size_t bufflen, m_off_t filepos, FilePiece& prevleftoverchunk);
-        void recoverSectorFromParity(byte* dest, byte* inputbufs[], unsigned offset);
         void combineLastRaidLine(byte* dest, size_t nbytes);
         void rollInputBuffers(size_t dataToDiscard);
         virtual void bufferWriteCompletedAction(FilePiece& r);
@@ -94,6 +94,9 @@ class MEGA_API RequestDispatcher
     char reqid[10];
 
 public:
+    // number of connections for independent batches, besides the one of the ordered batches
+    static const int MAX_PIPELINED_REQUESTS = 2;
+
     RequestDispatcher(PrnGen&);
 
     // Queue a command to be send to MEGA. Some commands must go in their own batch (in case other commands fail the whole batch), determined by the Command's `batchSeparately` field.
@@ -138,6 +141,20 @@ public:
 
     void clear();
 
+    // When enabled, commands flagged as independent are batched apart from the rest and sent on up to
+    // MAX_PIPELINED_REQUESTS extra connections, so they don't wait for slow batches like fetchnodes or putnodes.
+    // Commands that aren't independent keep their strict ordering (and batchSeparately) on the main connection.
+    void setPipelining(bool enable);
+    bool pipelining() const;
+
+    // Same as the functions above, for the pipelined connection 'channel' (0 to MAX_PIPELINED_REQUESTS - 1)
+    bool readyToSendPipelined(int channel) const;
+    bool readyToSendPipelined() const;
+    string serverrequestPipelined(int channel, bool& v3, MegaClient* client, string& idempotenceId);
+    void serverresponsePipelined(int channel, string&& movestring, MegaClient*);
+    void inflightFailurePipelined(int channel, retryreason_t reason);
+    void servererrorPipelined(int channel, const std::string& e, MegaClient*);
+
 #if defined(MEGA_MEASURE_CODE) || defined(DEBUG)
     Request deferredRequests;
     std::function<bool(Command*)> deferRequests;
@@ -148,6 +165,21 @@ public:
     uint64_t csBatchesSent = 0, csBatchesReceived = 0;
 #endif
 
+private:
+    // batches of independent commands (see Command::mIndependent), when pipelining is enabled
+    deque<Request> nextIndependentReqs;
+
+    // independent batches sent on the pipelined connections, waiting for their response
+    struct PipelinedRequest
+    {
+        Request req;
+        retryreason_t failReason = RETRY_NONE;
+    };
+    PipelinedRequest pipelinedreqs[MAX_PIPELINED_REQUESTS];
+
+    bool mPipelining = false;
+
+    static void addToQueue(deque<Request>& queue, Command* c);
 };
 
 } // namespace
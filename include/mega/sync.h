@@ -595,8 +595,21 @@ public:
     Sync(UnifiedSync&, const string&, const LocalPath&, bool, const string& logname, SyncError& e);
     ~Sync();
 
-    // Asynchronous scan request / result.
-    std::shared_ptr<ScanService::ScanRequest> mActiveScanRequestGeneral;
+    // Asynchronous scan requests / results.
+    // Disjoint folders of the sync are scanned at the same time, up to one per ScanService thread.
+    std::vector<std::shared_ptr<ScanService::ScanRequest>> mActiveScanRequestsGeneral;
+
+    // Slot for a new scan request, nullptr if as many scans as threads are in progress already
+    std::shared_ptr<ScanService::ScanRequest>* availableGeneralScanSlot();
+
+    // Whether no more scans can be started in the general slots
+    bool generalScanSlotsFull() const;
+
+    // Whether any general slot holds a request (complete or not)
+    bool hasGeneralScanRequests() const;
+
+    // Frees the slot of a request whose results were processed
+    void releaseScanSlot(const std::shared_ptr<ScanService::ScanRequest>& request);
 
     // we can additionally be scanning one more yet-unscanned folder
     // in order to always be progressing even when downloads are
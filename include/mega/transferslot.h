@@ -47,6 +47,77 @@ public:
 
 class TransferDbCommitter;
 
+// Adapts the number of connections and the request size of a transfer to the link.
+// Connections are added while each new one increases the speed of the transfer (high
+// bandwidth-delay links), and removed while that doesn't decrease it, or when requests
+// fail or their latency grows (a slow link that is being flooded).
+// The request size targets a few seconds of data per request at the current speed of
+// each connection, so that the latency of each request is amortized.
+class MEGA_API TransferConnectionController
+{
+public:
+    // decisions are taken once per period with the requests finished during it
+    static const dstime EVALUATION_PERIOD;
+
+    // periods without testing changes after the speed went down or a bound was reached
+    static const unsigned HOLD_PERIODS;
+
+    // seconds of data per request
+    static const m_off_t REQUEST_SECONDS;
+
+    struct Stats
+    {
+        unsigned connectionsAdded = 0;
+        unsigned connectionsRemoved = 0;
+        unsigned requestSizeChanges = 0;
+    };
+
+    TransferConnectionController(int connections, int minConnections, int maxConnections,
+                                 m_off_t requestSize, m_off_t minRequestSize, m_off_t maxRequestSize);
+
+    // a request finished with its speed (bytes per second) and the time to its first data
+    void requestFinished(m_off_t speed, dstime latency);
+    void requestFailed();
+
+    // evaluates the samples of the period (if it's over) with the current speed of the transfer
+    // returns true if the number of connections or the request size changed
+    bool evaluate(m_off_t transferSpeed, dstime now);
+
+    int connections() const { return mConnections; }
+    m_off_t requestSize() const { return mRequestSize; }
+    const Stats& stats() const { return mStats; }
+
+private:
+    int mConnections;
+    int mMinConnections;
+    int mMaxConnections;
+
+    m_off_t mRequestSize;
+    m_off_t mMinRequestSize;
+    m_off_t mMaxRequestSize;
+
+    // samples of the current period
+    dstime mPeriodStart = NEVER;
+    unsigned mSamples = 0;
+    unsigned mFailures = 0;
+    m_off_t mSpeedSum = 0;
+    dstime mLatencySum = 0;
+
+    // lowest latency seen, as the reference of an idle link
+    dstime mMinLatency = NEVER;
+
+    // connection added (1) or removed (-1) to test the speed in the last period, and the speed before it
+    int mProbe = 0;
+    m_off_t mSpeedBeforeProbe = 0;
+
+    // next change to test
+    int mNextProbe = 1;
+
+    unsigned mHoldPeriods = 0;
+
+    Stats mStats;
+};
+
 // active transfer
 struct MEGA_API TransferSlot
 {
@@ -120,6 +191,9 @@ struct MEGA_API TransferSlot
     // async IO operations
     AsyncIOContext** asyncIO;
 
+    // adapts connections and maxRequestSize when MegaClient::adaptiveconnections is set (null otherwise)
+    std::unique_ptr<TransferConnectionController> mConnectionController;
+
     // handle I/O for this slot
     void doio(MegaClient*, TransferDbCommitter&);
 
@@ -179,6 +253,9 @@ private:
     bool checkMetaMacWithMissingLateEntries();
     bool tryRaidRecoveryFromHttpGetError(unsigned i, bool incrementErrors);
 
+    // applies the decisions of mConnectionController
+    void adaptConnections(MegaClient* client);
+
     // returns true if connection haven't received data recently (set incrementErrors) or if slower than other connections (reset incrementErrors)
     bool testForSlowRaidConnection(unsigned connectionNum, bool& incrementErrors);
 };
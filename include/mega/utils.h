@@ -22,6 +22,7 @@
 #ifndef MEGA_UTILS_H
 #define MEGA_UTILS_H 1
 
+#include <atomic>
 #include <type_traits>
 #include <condition_variable>
 #include <thread>
@@ -780,6 +781,123 @@ public:
 
 };
 
+// Bounded queue for several producer threads and a single consumer thread, without locks.
+// Each slot has a sequence number telling whether it's free for the producer of a position
+// or it holds the value of that position for the consumer (D. Vyukov's bounded queue).
+// T must be default constructible and movable.
+template<class T>
+class BoundedMpscQueue
+{
+public:
+    // The capacity is rounded up to a power of two
+    explicit BoundedMpscQueue(size_t capacity)
+    {
+        size_t slots = 2;
+        while (slots < capacity) slots <<= 1;
+
+        mSlots.reset(new Slot[slots]);
+        mMask = slots - 1;
+
+        for (size_t i = 0; i < slots; ++i)
+        {
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MEGA_DISABLE_COPY_MOVE(BoundedMpscQueue)
+
+    // Any thread.  Returns false, leaving 't' untouched, if the queue is full
+    bool tryPush(T&& t)
+    {
+        size_t pos = mTail.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot& slot = mSlots[pos & mMask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<ptrdiff_t>(sequence - pos);
+
+            if (!diff)
+            {
+                if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.value = std::move(t);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // still holding the value of the previous lap
+                return false;
+            }
+            else
+            {
+                pos = mTail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only
+    bool tryPop(T& t)
+    {
+        size_t pos = mHead.load(std::memory_order_relaxed);
+        Slot& slot = mSlots[pos & mMask];
+
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+        {
+            return false;
+        }
+
+        t = std::move(slot.value);
+        slot.sequence.store(pos + mMask + 1, std::memory_order_release);
+        mHead.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer thread only.  Calls f(T&) for the values that can be popped, in order
+    template<class F>
+    void forEachQueued(F f)
+    {
+        for (size_t pos = mHead.load(std::memory_order_relaxed); ; ++pos)
+        {
+            Slot& slot = mSlots[pos & mMask];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;
+            f(slot.value);
+        }
+    }
+
+    // These two are approximate while producers are pushing
+    bool empty() const
+    {
+        size_t pos = mHead.load(std::memory_order_relaxed);
+        return mSlots[pos & mMask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    size_t size() const
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return mMask + 1; }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mMask = 0;
+
+    // next position to push, and to pop (only written by the consumer), on separate cache lines
+    alignas(64) std::atomic<size_t> mTail{0};
+    alignas(64) std::atomic<size_t> mHead{0};
+};
+
 template<class K, class V>
 class ThreadSafeKeyValue
 {
@@ -9825,6 +9825,23 @@ public:
      */
     static MegaSearchPage* createInstance(size_t startingOffset, size_t size);
 
+    /**
+     * @brief Creates a new instance of MegaSearchPage that starts right after a node
+     *
+     * The page includes the results sorted after the last node of the previous page, using the same
+     * filter and order. Unlike pages defined by an offset, previous results don't need to be sorted
+     * and skipped again, so deep pages cost the same as the first one.
+     *
+     * The sort keys of the node (name, size, dates, label, favourite) are copied, so the page is
+     * still valid if that node is modified or removed afterwards.
+     *
+     * @param lastNode Last node of the previous page
+     * @param size The maximum number of results included in the page, or 0 to return all (remaining) results
+     *
+     * @return A pointer of current type, a superclass of the private object, or nullptr if lastNode is null
+     */
+    static MegaSearchPage* createInstanceAfter(MegaNode* lastNode, size_t size);
+
     /**
      * @brief Create a copy of this instance.
      *
@@ -9853,6 +9870,14 @@ public:
      * @return maximum number of results included in the page, or 0 to return all (remaining) results
      */
     virtual size_t size() const;
+
+    /**
+     * @brief Return the handle of the node the page starts after
+     *
+     * @return handle of the node the page starts after, or INVALID_HANDLE if the page is defined by offset
+     * @see MegaSearchPage::createInstanceAfter
+     */
+    virtual MegaHandle lastNodeHandle() const;
 };
 
 class MegaNodeTree
@@ -16077,6 +16102,21 @@ class MegaApi
          */
         void setMaxConnections(int connections, MegaRequestListener* listener = NULL);
 
+        /**
+         * @brief Enable / disable the adaptive number of connections per transfer
+         *
+         * Adaptive connections are disabled by default. When enabled, uploads and downloads of files
+         * that aren't stored in CloudRAID start with the number of connections set by
+         * MegaApi::setMaxConnections and then add connections (up to 6) while that increases the
+         * speed of the transfer, or remove them if requests fail or get slower. The size of the
+         * requests of both uploads and downloads is adapted to the speed of each connection too.
+         *
+         * The setting applies to the transfers started after the call.
+         *
+         * @param enable true to adapt the connections of the transfers, false to use a fixed number
+         */
+        void setAdaptiveConnections(bool enable);
+
         /**
          * @brief Set the transfer method for downloads
          *
@@ -16776,6 +16816,20 @@ class MegaApi
          */
         bool isSyncing();
 
+        /**
+         * @brief Set the number of threads that scan the local folders of syncs
+         *
+         * The threads are shared by all the syncs, and they take turns to scan the folders of each
+         * sync, so a large sync doesn't delay the scans of the others. Each sync scans up to this
+         * number of its folders at the same time. By default, the SDK uses half of the CPU cores,
+         * up to 4 threads.
+         *
+         * The setting applies to all the instances of MegaApi in the process.
+         *
+         * @param numThreads Number of threads. Values lower than 1 restore the default.
+         */
+        void setSyncScanThreads(int numThreads);
+
         /**
          * @brief Inform the SDK of the exclusion names used for old syncs, in case any need to be upgraded to .megaignore
          *
@@ -17231,6 +17285,79 @@ class MegaApi
          */
         unsigned long long getNumNodesAtCacheLRU() const;
 
+        /**
+         * @brief Set the number of threads used to decode nodes loaded from the database
+         *
+         * Big results of searches and listings of children are decoded by this number of threads,
+         * while nodes are still created and cached sequentially. Small results are always decoded
+         * by the calling thread.
+         *
+         * By default it's 0 (disabled). Values 0 and 1 disable it.
+         *
+         * @param numThreads Number of threads (including the calling one)
+         */
+        void setNodeUnserializationThreads(unsigned int numThreads);
+
+        /**
+         * @brief Relax the durability of the local cache while nodes are loaded from servers
+         *
+         * When nodes are fetched from servers, they are written into the local cache in a single
+         * transaction, with the indexes of the database rebuilt at the end. If this option is
+         * enabled, the database is not synced to disk until that transaction is committed, which
+         * speeds up the load of big accounts. A crash during the load may leave a corrupt cache,
+         * which would be discarded and fetched again at next login.
+         *
+         * By default it's disabled.
+         *
+         * @param enable True to relax the durability during the load of nodes from servers
+         */
+        void setFetchNodesRelaxedSync(bool enable);
+
+        /**
+         * @brief Set the maximum memory used by nodes at cache LRU
+         *
+         * Memory used by every node is estimated from its attributes, keys, shares, public link...
+         * The least recently used nodes are unloaded from RAM while the limit is exceeded. This limit
+         * is applied in addition to the one set by MegaApi::setLRUCacheSize.
+         *
+         * By default it's defined at unsigned long long max value
+         *
+         * @param bytes Maximum memory for nodes at cache LRU, in bytes
+         */
+        void setLRUCacheMaxBytes(unsigned long long bytes);
+
+        /**
+         * @brief Returns the estimated memory used by nodes stored at cache LRU
+         *
+         * @return Estimated memory of nodes at cache LRU, in bytes
+         */
+        unsigned long long getBytesAtCacheLRU() const;
+
+        /**
+         * @brief Returns number of nodes currently loaded in RAM
+         *
+         * It includes nodes at cache LRU and nodes kept alive elsewhere (i.e. by transfers or syncs)
+         *
+         * @return Number of nodes in RAM
+         */
+        unsigned long long getNumNodesInRam() const;
+
+        /**
+         * @brief Returns number of lookups of nodes by handle that found the node in RAM
+         *
+         * Hit rate can be calculated with MegaApi::getNodeLookupMisses
+         *
+         * @return Number of lookups by handle resolved without accessing the database
+         */
+        unsigned long long getNodeLookupHits() const;
+
+        /**
+         * @brief Returns number of lookups of nodes by handle that required to access the database
+         *
+         * @return Number of lookups by handle not resolved in RAM
+         */
+        unsigned long long getNodeLookupMisses() const;
+
         enum { ORDER_NONE = 0, ORDER_DEFAULT_ASC, ORDER_DEFAULT_DESC,
             ORDER_SIZE_ASC, ORDER_SIZE_DESC,
             ORDER_CREATION_ASC, ORDER_CREATION_DESC,
@@ -19742,6 +19869,38 @@ class MegaApi
          */
         void setPublicKeyPinning(bool enable);
 
+        /**
+         * @brief Enable / disable HTTP/2 for the connections to MEGA servers
+         *
+         * HTTP/2 is disabled by default. When enabled, it's negotiated with the servers that support it
+         * and the requests to the same host (API requests, or the connections of transfers to the same
+         * storage server) are multiplexed over a single connection, which saves the connection and TLS
+         * handshakes of short transfers.
+         *
+         * The setting applies to new requests. It's only available if the SDK was built with a libcurl
+         * that supports HTTP/2.
+         *
+         * @param enable true to use HTTP/2, false to use HTTP/1.1
+         * @return true if the setting was applied, false if HTTP/2 is not supported
+         */
+        bool setHttp2(bool enable);
+
+        /**
+         * @brief Enable / disable the pipelining of independent API requests
+         *
+         * Pipelining is disabled by default. API requests are sent to MEGA servers in batches, one after
+         * the other, so a slow request (like the one to fetch the nodes) delays all the requests started
+         * after it. When pipelining is enabled, the requests that only query information (like the account
+         * details, the transfer quota or the download URLs of files) are sent in separate batches on up to
+         * two additional connections, without waiting for the rest. The requests that change the account
+         * keep their order.
+         *
+         * The setting applies to the requests started after the call.
+         *
+         * @param enable true to pipeline independent requests, false to send all the requests in order
+         */
+        void setRequestPipelining(bool enable);
+
         /**
          * @brief Pause the reception of action packets
          *
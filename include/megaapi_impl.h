@@ -2977,13 +2977,19 @@ class MegaSearchPagePrivate : public MegaSearchPage
 {
 public:
     MegaSearchPagePrivate(size_t startingOffset, size_t size) : mOffset(startingOffset), mSize(size) {}
+    MegaSearchPagePrivate(MegaNode* lastNode, size_t size);
     MegaSearchPagePrivate* copy() const override { return new MegaSearchPagePrivate(*this); }
     size_t startingOffset() const override { return mOffset; }
     size_t size() const override { return mSize; }
+    MegaHandle lastNodeHandle() const override { return mCursor.nodeHandle; }
+
+    // Pagination options as expected by NodeManager (default if 'page' is null)
+    static NodeSearchPage toNodeSearchPage(const MegaSearchPage* page);
 
 private:
     size_t mOffset;
     size_t mSize;
+    NodeSearchCursor mCursor;
 };
 
 
@@ -3305,6 +3311,7 @@ class MegaApiImpl : public MegaApp
         bool areTransfersPaused(int direction);
         void setUploadLimit(int bpslimit);
         void setMaxConnections(int direction, int connections, MegaRequestListener* listener = NULL);
+        void setAdaptiveConnections(bool enable);
         void setDownloadMethod(int method);
         void setUploadMethod(int method);
         bool setMaxDownloadSpeed(m_off_t bpslimit);
@@ -3452,6 +3459,7 @@ class MegaApiImpl : public MegaApp
         MegaError *isNodeSyncableWithError(MegaNode* node);
         bool isScanning();
         bool isSyncing();
+        void setSyncScanThreads(int numThreads);
 
         std::atomic<bool> receivedStallFlag{false};
         std::atomic<bool> receivedNameConflictsFlag{false};
@@ -3493,6 +3501,13 @@ class MegaApiImpl : public MegaApp
         void updateStats();
         void setLRUCacheSize(unsigned long long size);
         unsigned long long getNumNodesAtCacheLRU() const;
+        void setNodeUnserializationThreads(unsigned int numThreads);
+        void setFetchNodesRelaxedSync(bool enable);
+        void setLRUCacheMaxBytes(unsigned long long bytes);
+        unsigned long long getBytesAtCacheLRU() const;
+        unsigned long long getNumNodesInRam() const;
+        unsigned long long getNodeLookupHits() const;
+        unsigned long long getNodeLookupMisses() const;
         unsigned long long getNumNodes();
         unsigned long long getAccurateNumNodes();
         long long getTotalDownloadedBytes();
@@ -3652,6 +3667,8 @@ public:
 
         void retrySSLerrors(bool enable);
         void setPublicKeyPinning(bool enable);
+        bool setHttp2(bool enable);
+        void setRequestPipelining(bool enable);
         void pauseActionPackets();
         void resumeActionPackets();
 
@@ -0,0 +1,217 @@
+/**
+ * @file bufferpool.cpp
+ * @brief Pool of reusable buffers for transfer data
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega/bufferpool.h"
+#include "mega/logging.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace mega {
+
+#if defined(__ANDROID__) || defined(USE_IOS)
+const size_t BufferPool::DEFAULT_MAX_IDLE_BYTES = 16 * 1024 * 1024; // 16 MB
+#else
+const size_t BufferPool::DEFAULT_MAX_IDLE_BYTES = 128 * 1024 * 1024; // 128 MB
+#endif
+
+BufferPool& BufferPool::instance()
+{
+    // never destroyed: buffers can be released by objects destroyed at exit
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+BufferPool::BufferPool(size_t maxIdleBytes)
+    : mMaxIdleBytes(maxIdleBytes)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    trim();
+    assert(mInUse.empty());
+}
+
+size_t BufferPool::capacityFor(size_t size)
+{
+    if (size <= ALIGNMENT)
+    {
+        return ALIGNMENT;
+    }
+
+    // largest power of two not above size
+    size_t power = ALIGNMENT;
+    while (power <= size / 2)
+    {
+        power *= 2;
+    }
+
+    // four classes per power of two, so at most 25% of a buffer is unused
+    size_t step = std::max(power / 4, ALIGNMENT);
+    return (size + step - 1) / step * step;
+}
+
+byte* BufferPool::allocate(size_t capacity)
+{
+    return static_cast<byte*>(::operator new(capacity, std::align_val_t(ALIGNMENT)));
+}
+
+void BufferPool::deallocate(byte* buffer)
+{
+    ::operator delete(buffer, std::align_val_t(ALIGNMENT));
+}
+
+byte* BufferPool::acquire(size_t size)
+{
+    if (!size)
+    {
+        return nullptr;
+    }
+
+    size_t capacity = capacityFor(size);
+    byte* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mLastUse = std::chrono::steady_clock::now();
+
+        auto it = mIdle.find(capacity);
+        if (it != mIdle.end())
+        {
+            buffer = it->second.back();
+            it->second.pop_back();
+            if (it->second.empty())
+            {
+                mIdle.erase(it);
+            }
+            mStats.idleBytes -= capacity;
+            ++mStats.hits;
+        }
+        else
+        {
+            ++mStats.misses;
+        }
+    }
+
+    if (!buffer)
+    {
+        buffer = allocate(capacity);
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    mInUse.emplace(buffer, capacity);
+    mStats.inUseBytes += capacity;
+    mStats.peakInUseBytes = std::max(mStats.peakInUseBytes, mStats.inUseBytes);
+    return buffer;
+}
+
+void BufferPool::release(byte* buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mLastUse = std::chrono::steady_clock::now();
+
+        auto it = mInUse.find(buffer);
+        if (it == mInUse.end())
+        {
+            LOG_err << "Releasing a buffer that doesn't belong to the pool";
+            assert(false);
+            return;
+        }
+
+        size_t capacity = it->second;
+        mInUse.erase(it);
+        mStats.inUseBytes -= capacity;
+
+        if (mStats.idleBytes + capacity <= mMaxIdleBytes)
+        {
+            mIdle[capacity].push_back(buffer);
+            mStats.idleBytes += capacity;
+            return;
+        }
+
+        ++mStats.discards;
+    }
+
+    deallocate(buffer);
+}
+
+void BufferPool::setMaxIdleBytes(size_t bytes)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mMaxIdleBytes = bytes;
+    trimTo(bytes);
+}
+
+size_t BufferPool::maxIdleBytes() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mMaxIdleBytes;
+}
+
+void BufferPool::trim()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    trimTo(0);
+}
+
+bool BufferPool::trimIfIdle(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (!mStats.idleBytes || now - mLastUse < IDLE_TRIM_DELAY)
+    {
+        return false;
+    }
+
+    LOG_debug << "Freeing " << mStats.idleBytes << " bytes of idle transfer buffers";
+    trimTo(0);
+    return true;
+}
+
+void BufferPool::trimTo(size_t maxIdleBytes)
+{
+    // biggest buffers first
+    while (mStats.idleBytes > maxIdleBytes)
+    {
+        auto it = std::prev(mIdle.end());
+        deallocate(it->second.back());
+        it->second.pop_back();
+        mStats.idleBytes -= it->first;
+        if (it->second.empty())
+        {
+            mIdle.erase(it);
+        }
+    }
+}
+
+BufferPool::Stats BufferPool::stats() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mStats;
+}
+
+} // namespace
@@ -560,6 +560,7 @@ CommandDirectRead::CommandDirectRead(MegaClient *client, DirectReadNode* cdrn)
 
     cmd("g");
     arg(drn->p ? "n" : "p", (byte*)&drn->h, MegaClient::NODEHANDLE);
+    mIndependent = true;
     arg("g", 1); // server will provide download URL(s)/token(s) (if skipped, only information about the file)
     arg("v", 2);  // version 2: server can supply details for cloudraid files
 
@@ -707,6 +708,7 @@ CommandGetFile::CommandGetFile(MegaClient *client, const byte* key, size_t keySi
 {
     cmd(undelete ? "gd" : "g");
     arg(p ? "n" : "p", (byte*)&h, MegaClient::NODEHANDLE);
+    mIndependent = !undelete;
     arg("g", 1); // server will provide download URL(s)/token(s) (if skipped, only information about the file)
     if (!singleUrl)
     {
@@ -2402,6 +2404,7 @@ void CommandUpdatePendingContact::doComplete(error result, ipcactions_t actions)
 CommandEnumerateQuotaItems::CommandEnumerateQuotaItems(MegaClient* client)
 {
     cmd("utqa");
+    mIndependent = true;
     arg("nf", 3);
     arg("b", 1);    // support for Business accounts
     arg("p", 1);    // support for Pro Flexi
@@ -5133,6 +5136,7 @@ CommandGetUserQuota::CommandGetUserQuota(MegaClient* client, std::shared_ptr<Acc
   : details(ad), mStorage(storage), mTransfer(transfer), mPro(pro), mCompletion(std::move(completion))
 {
     cmd("uq");
+    mIndependent = true;
     if (storage)
     {
         arg("strg", "1", 0);
@@ -5719,6 +5723,7 @@ void CommandGetUserQuota::processPlans()
 CommandQueryTransferQuota::CommandQueryTransferQuota(MegaClient* client, m_off_t size)
 {
     cmd("qbq");
+    mIndependent = true;
     arg("s", size);
 
     tag = client->reqtag;
@@ -5745,6 +5750,7 @@ bool CommandQueryTransferQuota::procresult(Result r, JSON& json)
 CommandGetUserTransactions::CommandGetUserTransactions(MegaClient* client, std::shared_ptr<AccountDetails> ad)
 {
     cmd("utt");
+    mIndependent = true;
 
     details = ad;
     tag = client->reqtag;
@@ -5833,6 +5839,7 @@ bool CommandGetUserPurchases::procresult(Result r, JSON& json)
 CommandGetUserSessions::CommandGetUserSessions(MegaClient* client, std::shared_ptr<AccountDetails> ad)
 {
     cmd("usl");
+    mIndependent = true;
     arg("x", 1); // Request the additional id and alive information
     arg("d", 1); // Request the additional device-id
 
@@ -6541,6 +6548,7 @@ CommandFetchNodes::CommandFetchNodes(MegaClient* client,
                 client->sctable->truncate();
                 client->sctable->commit();
                 assert(!client->sctable->inTransaction());
+                client->mNodeManager.startBulkLoad();
                 client->sctable->begin();
                 client->pendingsccommit = false;
             }
@@ -6840,6 +6848,7 @@ bool CommandFetchNodes::procresult(Result r, JSON& json)
         client->sctable->truncate();
         client->sctable->commit();
         assert(!client->sctable->inTransaction());
+        client->mNodeManager.startBulkLoad();
         client->sctable->begin();
         client->pendingsccommit = false;
     }
@@ -6990,6 +6999,9 @@ bool CommandFetchNodes::parsingFinished()
 
     client->mNodeManager.initCompleted();  // (nodes already written into DB)
 
+    WAIT_CLASS::bumpds();
+    client->fnstats.timeToReady = Waiter::ds - client->fnstats.startTime;
+
     client->initsc();
     client->pendingsccommit = false;
     client->fetchnodestag = tag;
@@ -7193,6 +7205,7 @@ bool CommandCopySession::procresult(Result r, JSON& json)
 CommandGetPaymentMethods::CommandGetPaymentMethods(MegaClient *client)
 {
     cmd("ufpq");
+    mIndependent = true;
     tag = client->reqtag;
 }
 
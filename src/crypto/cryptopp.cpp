@@ -21,6 +21,22 @@
 
 #include "mega.h"
 
+#include <atomic>
+
+// ctr_crypt() has an AES-NI kernel on x86-64, selected at runtime if the CPU supports it.
+// The functions using the AES instructions are compiled for that target only, so no compiler flags are needed.
+#if !defined(MEGA_NO_AESNI) && (defined(__x86_64__) || defined(_M_X64))
+#define MEGA_AESNI 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MEGA_AESNI_TARGET
+#else
+#define MEGA_AESNI_TARGET __attribute__((target("aes")))
+#endif
+#endif
+
 namespace mega {
 #ifndef htobe64
 #define htobe64(x) (((uint64_t)htonl((uint32_t)((x) >> 32))) | (((uint64_t)htonl((uint32_t)x)) << 32))
@@ -28,6 +44,103 @@ namespace mega {
 
 using namespace CryptoPP;
 
+namespace {
+
+#ifdef MEGA_AESNI
+bool cpuHasAesNi()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 25)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes");
+#endif
+}
+
+const bool aesNiAvailable = cpuHasAesNi();
+
+// one round of the AES-128 key schedule
+template<int rcon>
+MEGA_AESNI_TARGET inline __m128i expandKey(__m128i key)
+{
+    __m128i t = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, rcon), 0xff);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, t);
+}
+
+MEGA_AESNI_TARGET void expandKey(const byte* key, byte* roundKeys)
+{
+    __m128i rk[11];
+    rk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    rk[1] = expandKey<0x01>(rk[0]);
+    rk[2] = expandKey<0x02>(rk[1]);
+    rk[3] = expandKey<0x04>(rk[2]);
+    rk[4] = expandKey<0x08>(rk[3]);
+    rk[5] = expandKey<0x10>(rk[4]);
+    rk[6] = expandKey<0x20>(rk[5]);
+    rk[7] = expandKey<0x40>(rk[6]);
+    rk[8] = expandKey<0x80>(rk[7]);
+    rk[9] = expandKey<0x1b>(rk[8]);
+    rk[10] = expandKey<0x36>(rk[9]);
+
+    for (int i = 0; i < 11; i++)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(roundKeys) + i, rk[i]);
+    }
+}
+
+MEGA_AESNI_TARGET inline __m128i aesEncrypt(const __m128i* rk, __m128i b)
+{
+    b = _mm_xor_si128(b, rk[0]);
+    for (int i = 1; i < 10; i++)
+    {
+        b = _mm_aesenc_si128(b, rk[i]);
+    }
+    return _mm_aesenclast_si128(b, rk[10]);
+}
+
+// two independent blocks, round by round, so one hides the latency of the other
+MEGA_AESNI_TARGET inline void aesEncrypt2(const __m128i* rk, __m128i& a, __m128i& b)
+{
+    a = _mm_xor_si128(a, rk[0]);
+    b = _mm_xor_si128(b, rk[0]);
+    for (int i = 1; i < 10; i++)
+    {
+        a = _mm_aesenc_si128(a, rk[i]);
+        b = _mm_aesenc_si128(b, rk[i]);
+    }
+    a = _mm_aesenclast_si128(a, rk[10]);
+    b = _mm_aesenclast_si128(b, rk[10]);
+}
+
+MEGA_AESNI_TARGET inline void aesEncrypt4(const __m128i* rk, __m128i* b)
+{
+    for (int j = 0; j < 4; j++)
+    {
+        b[j] = _mm_xor_si128(b[j], rk[0]);
+    }
+    for (int i = 1; i < 10; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            b[j] = _mm_aesenc_si128(b[j], rk[i]);
+        }
+    }
+    for (int j = 0; j < 4; j++)
+    {
+        b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+    }
+}
+#endif
+
+std::atomic<bool> hardwareCtr{true};
+
+} // namespace
+
 // cryptographically strong random byte sequence
 void PrnGen::genblock(byte* buf, size_t len)
 {
@@ -86,6 +199,13 @@ void SymmCipher::setkey(const byte* newkey, int type)
 
     aesgcm_e.SetKeyWithIV(key, KEYLENGTH, zeroiv);
     aesgcm_d.SetKeyWithIV(key, KEYLENGTH, zeroiv);
+
+#ifdef MEGA_AESNI
+    if (aesNiAvailable)
+    {
+        expandKey(key, mRoundKeys);
+    }
+#endif
 }
 
 bool SymmCipher::setkey(const string* key)
@@ -698,6 +818,14 @@ void SymmCipher::ctr_crypt(byte* data, unsigned len, m_off_t pos, ctr_iv ctriv,
         memcpy(mac + sizeof ctriv, ctr, sizeof ctriv);
     }
 
+#ifdef MEGA_AESNI
+    if (aesNiAvailable && hardwareCtr.load(std::memory_order_relaxed))
+    {
+        ctr_crypt_aesni(data, len, ctr, mac, encrypt);
+        return;
+    }
+#endif
+
     while ((int)len > 0)
     {
         if (encrypt)
@@ -738,6 +866,119 @@ void SymmCipher::ctr_crypt(byte* data, unsigned len, m_off_t pos, ctr_iv ctriv,
     }
 }
 
+#ifdef MEGA_AESNI
+// Same block processing as ctr_crypt(), but the CTR keystream is computed alongside the MAC:
+// each CBC-MAC step depends on the previous one, so the AES rounds of an independent counter
+// block run in its latency shadow and the data is read and written once.
+MEGA_AESNI_TARGET void SymmCipher::ctr_crypt_aesni(byte* data, unsigned len, byte* ctr, byte* mac, bool encrypt)
+{
+    __m128i rk[11];
+    for (int i = 0; i < 11; i++)
+    {
+        rk[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(mRoundKeys) + i);
+    }
+
+    auto load = [](const byte* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+    auto store = [](byte* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); };
+
+    auto nextCounter = [ctr, &load]()
+    {
+        __m128i c = load(ctr);
+        incblock(ctr);
+        return c;
+    };
+
+    if (!mac)
+    {
+        // no dependencies between blocks: four at a time
+        while ((int)len >= 4 * BLOCKSIZE)
+        {
+            __m128i ks[4] = { nextCounter(), nextCounter(), nextCounter(), nextCounter() };
+            aesEncrypt4(rk, ks);
+            for (int j = 0; j < 4; j++)
+            {
+                store(data + j * BLOCKSIZE, _mm_xor_si128(load(data + j * BLOCKSIZE), ks[j]));
+            }
+            len -= 4 * BLOCKSIZE;
+            data += 4 * BLOCKSIZE;
+        }
+
+        while ((int)len > 0)
+        {
+            store(data, _mm_xor_si128(load(data), aesEncrypt(rk, nextCounter())));
+            len -= BLOCKSIZE;
+            data += BLOCKSIZE;
+        }
+        return;
+    }
+
+    __m128i m = load(mac);
+
+    if (encrypt)
+    {
+        // the MAC covers the plaintext, so the keystream of the same block runs alongside
+        while ((int)len > 0)
+        {
+            __m128i plain = load(data);
+            __m128i ks = nextCounter();
+            m = _mm_xor_si128(m, plain);
+            aesEncrypt2(rk, m, ks);
+            store(data, _mm_xor_si128(plain, ks));
+
+            len -= BLOCKSIZE;
+            data += BLOCKSIZE;
+        }
+    }
+    else if ((int)len > 0)
+    {
+        // the MAC needs the decrypted block, so the keystream of the next block runs alongside
+        __m128i ks = aesEncrypt(rk, nextCounter());
+        for (;;)
+        {
+            __m128i plain = _mm_xor_si128(load(data), ks);
+            store(data, plain);
+
+            if (len < (unsigned)BLOCKSIZE)
+            {
+                // only the bytes of the data are MACed
+                alignas(16) byte last[BLOCKSIZE] = {};
+                memcpy(last, data, len);
+                plain = _mm_load_si128(reinterpret_cast<const __m128i*>(last));
+            }
+            m = _mm_xor_si128(m, plain);
+
+            len -= BLOCKSIZE;
+            data += BLOCKSIZE;
+
+            if ((int)len <= 0)
+            {
+                m = aesEncrypt(rk, m);
+                break;
+            }
+
+            ks = nextCounter();
+            aesEncrypt2(rk, m, ks);
+        }
+    }
+
+    store(mac, m);
+}
+#endif
+
+bool SymmCipher::hardwareCtrAvailable()
+{
+#ifdef MEGA_AESNI
+    return aesNiAvailable;
+#else
+    return false;
+#endif
+}
+
+void SymmCipher::setHardwareCtr(bool enable)
+{
+    hardwareCtr = enable;
+}
+
 static void rsaencrypt(const Integer* key, Integer* m)
 {
     *m = a_exp_b_mod_c(*m, key[AsymmCipher::PUB_E], key[AsymmCipher::PUB_PQ]);
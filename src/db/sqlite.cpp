@@ -140,6 +140,37 @@ static int
     return naturalsorting_compare(s1.c_str(), s2.c_str());
 }
 
+// Column 'nodes.ancestry' stores the handles of every ancestor available in DB, from the
+// topmost one down to the node itself, as 8-byte big-endian keys. If the parent of the topmost
+// ancestor is not in DB (yet), its handle is the first key. Thus, the descendants of a node are
+// the rows whose ancestry starts with the ancestry of the node, which is an indexed range lookup.
+static constexpr size_t ANCESTRY_KEY_SIZE = 8;
+
+static std::string ancestryKey(handle h)
+{
+    std::string key(ANCESTRY_KEY_SIZE, '\0');
+    for (size_t i = ANCESTRY_KEY_SIZE; i--; h >>= 8)
+    {
+        key[i] = static_cast<char>(h & 0xFF);
+    }
+    return key;
+}
+
+// Exclusive upper limit for the ancestry of the descendants of a node
+// (lower limit is the ancestry of the node itself, also exclusive)
+static std::string ancestryUpperBound(const std::string& ancestry)
+{
+    return ancestry + std::string(ANCESTRY_KEY_SIZE + 1, '\xFF');
+}
+
+// Category of a node by the extension of its name (stored at 'nodes.mimetype')
+static int mimetypeFromName(const char* fileName)
+{
+    string ext;
+    return (fileName && *fileName && Node::getExtension(ext, fileName) && !ext.empty()) ?
+           Node::getMimetype(ext) : MimeType_t::MIME_TYPE_OTHERS;
+}
+
 DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAccess, const string &name, const int flags, DBErrorCallback dBErrorCallBack)
 {
     sqlite3 *db = nullptr;
@@ -149,21 +180,8 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
         return nullptr;
     }
 
-    if (sqlite3_create_function(db, u8"getmimetype", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, 0, &SqliteAccountState::userGetMimetype, 0, 0) != SQLITE_OK)
+    if (!SqliteAccountState::registerUserFunctions(db))
     {
-        LOG_err << "Data base error(sqlite3_create_function userGetMimetype): " << sqlite3_errmsg(db);
-        sqlite3_close(db);
-        return nullptr;
-    }
-
-    if (sqlite3_create_collation(db,
-                                 "NATURALNOCASE",
-                                 SQLITE_UTF8,
-                                 nullptr,
-                                 sqlite_naturalsorting_compare))
-    {
-        LOG_err << "Data base error(sqlite3_create_collation NATURALNOCASE): "
-                << sqlite3_errmsg(db);
         sqlite3_close(db);
         return nullptr;
     }
@@ -171,10 +189,11 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
     // Create specific table for handle nodes
     std::string sql = "CREATE TABLE IF NOT EXISTS nodes (nodehandle int64 PRIMARY KEY NOT NULL, "
                       "parenthandle int64, name text, fingerprint BLOB, origFingerprint BLOB, "
-                      "type tinyint, mimetypeVirtual tinyint AS (getmimetype(name)) VIRTUAL, size "
+                      "type tinyint, mimetype tinyint, size "
                       "int64, share tinyint, fav tinyint, ctime int64, mtime int64 DEFAULT 0, "
                       "flags int64, counter BLOB NOT NULL, "
-                      "node BLOB NOT NULL, label tinyint DEFAULT 0, description text, tags text)";
+                      "node BLOB NOT NULL, label tinyint DEFAULT 0, description text, tags text, "
+                      "ancestry BLOB)";
 
     int result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
     if (result)
@@ -194,10 +213,11 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
          "tinyint DEFAULT 0",
          NodeData::COMPONENT_LABEL,
          NewColumn::extractDataFromNodeData<LabelType>      },
-        {"mimetypeVirtual",
-         "tinyint AS (getmimetype(name)) VIRTUAL",
+        {"mimetype",
+         "tinyint",
          NodeData::COMPONENT_NONE,
-         nullptr                                            },
+         nullptr,
+         "getmimetype(name)"                                },
         {"description",
          "text",
          NodeData::COMPONENT_DESCRIPTION,
@@ -206,6 +226,10 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
          "text",
          NodeData::COMPONENT_TAGS,
          NewColumn::extractDataFromNodeData<TagsType>       },
+        {"ancestry",
+         "BLOB",
+         NodeData::COMPONENT_NONE, // populated by populateAncestry()
+         nullptr                                            },
         };
 
 
@@ -215,56 +239,44 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
         return nullptr;
     }
 
-#if __ANDROID__
-    // Android doesn't provide a temporal directory -> change default policy for temp
-    // store (FILE=1) to avoid failures on large queries, so it relies on MEMORY=2
-    result = sqlite3_exec(db, "PRAGMA temp_store=2;", nullptr, nullptr, nullptr);
-    if (result)
+    if (!populateAncestry(db) || !populateMimetype(db))
     {
-        LOG_err << "PRAGMA temp_store error " << sqlite3_errmsg(db);
         sqlite3_close(db);
         return nullptr;
     }
-#endif
 
-    result = sqlite3_create_function(db, "regexp", 2, SQLITE_ANY,0, &SqliteAccountState::userRegexp, 0, 0);
+    // Required from the beginning, unlike indexes at createIndexes(), since every put() of a node
+    // looks up its descendants by ancestry
+    result = sqlite3_exec(db, "CREATE INDEX IF NOT EXISTS ancestryindex on nodes (ancestry)", nullptr, nullptr, nullptr);
     if (result)
     {
-        LOG_err << "Data base error(sqlite3_create_function userRegexp): " << sqlite3_errmsg(db);
+        LOG_err << "Data base error while creating index (ancestryindex): " << sqlite3_errmsg(db);
         sqlite3_close(db);
         return nullptr;
     }
 
-    result = sqlite3_create_function(db, "ismimetype", 2, SQLITE_ANY,0, &SqliteAccountState::userIsMimetype, 0, 0);
-    if (result)
-    {
-        LOG_err << "Data base error(sqlite3_create_function userIsMimetype): " << sqlite3_errmsg(db);
-        sqlite3_close(db);
-        return nullptr;
-    }
+    // Not mandatory: searches fall back to the user functions when it's not available
+    bool hasFullTextIndex = createFullTextIndex(db);
 
-    result = sqlite3_create_function(db, "isContained", 2, SQLITE_ANY,0, &SqliteAccountState::userIsContained, 0, 0);
-    if (result)
-    {
-        LOG_err << "Data base error(sqlite3_create_function userIsContained): " << sqlite3_errmsg(db);
-        sqlite3_close(db);
-        return nullptr;
-    }
-
-    result = sqlite3_create_function(db, "matchTag", 2, SQLITE_ANY,0, &SqliteAccountState::userMatchTag, 0, 0);
+#if __ANDROID__
+    // Android doesn't provide a temporal directory -> change default policy for temp
+    // store (FILE=1) to avoid failures on large queries, so it relies on MEMORY=2
+    result = sqlite3_exec(db, "PRAGMA temp_store=2;", nullptr, nullptr, nullptr);
     if (result)
     {
-        LOG_err << "Data base error(sqlite3_create_function userMatchTag): " << sqlite3_errmsg(db);
+        LOG_err << "PRAGMA temp_store error " << sqlite3_errmsg(db);
         sqlite3_close(db);
         return nullptr;
     }
+#endif
 
     return new SqliteAccountState(rng,
                                 db,
                                 fsAccess,
                                 dbPath,
                                 (flags & DB_OPEN_FLAG_TRANSACTED) > 0,
-                                std::move(dBErrorCallBack));
+                                std::move(dBErrorCallBack),
+                                hasFullTextIndex);
 }
 
 bool SqliteDbAccess::probe(FileSystemAccess& fsAccess, const string& name) const
@@ -419,6 +431,11 @@ bool SqliteDbAccess::addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newC
         {
             return false;
         }
+
+        if (!c.populateExpression.empty() && !populateColumn(db, c.name, c.populateExpression))
+        {
+            return false;
+        }
     }
 
     return migrateDataToColumns(db, std::move(newCols));
@@ -466,6 +483,20 @@ bool SqliteDbAccess::addColumn(sqlite3* db, const string& name, const string& ty
     return true;
 }
 
+bool SqliteDbAccess::populateColumn(sqlite3* db, const string& name, const string& expression)
+{
+    LOG_info << "Migrating Data base - populating column " << name;
+
+    string query("UPDATE nodes SET " + name + " = " + expression);
+    if (sqlite3_exec(db, query.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while populating 'nodes." << name << "' column: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    return true;
+}
+
 bool SqliteDbAccess::migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols)
 {
     if (cols.empty()) return true;
@@ -596,6 +627,234 @@ bool SqliteDbAccess::migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols)
 }
 
 
+bool SqliteDbAccess::populateMimetype(sqlite3* db)
+{
+    // the column is only populated when it's added, but rows written later by older versions leave it NULL
+    // (found by 'mimetypeindex' once it exists)
+    int result = sqlite3_exec(db, "UPDATE nodes SET mimetype = getmimetype(name) WHERE mimetype IS NULL", nullptr, nullptr, nullptr);
+    if (result)
+    {
+        LOG_err << "Db error while populating mimetype of nodes: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (int changes = sqlite3_changes(db))
+    {
+        LOG_info << "Migrating Data base - populated mimetype of " << changes << " nodes";
+    }
+
+    return true;
+}
+
+bool SqliteDbAccess::populateAncestry(sqlite3* db)
+{
+    sqlite3_stmt* stmt = nullptr;
+    bool missing = false;
+    if (sqlite3_prepare_v2(db, "SELECT EXISTS (SELECT 1 FROM nodes WHERE ancestry IS NULL)", -1, &stmt, nullptr) != SQLITE_OK
+            || sqlite3_step(stmt) != SQLITE_ROW)
+    {
+        LOG_err << "Db error while checking ancestry of nodes: " << sqlite3_errmsg(db);
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    missing = sqlite3_column_int(stmt, 0) != 0;
+    sqlite3_finalize(stmt);
+
+    if (!missing)
+    {
+        return true;
+    }
+
+    // Nodes written by versions not aware of this column may have invalidated the ancestry of
+    // their descendants too (i.e. after a move), so it's recalculated for every node
+    LOG_info << "Migrating Data base - populating ancestry of nodes";
+
+    if (sqlite3_prepare_v2(db, "SELECT nodehandle, parenthandle FROM nodes", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to extract parents of nodes: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    std::unordered_map<handle, handle> parents;
+    std::unordered_set<handle> withChildren;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        handle parent = static_cast<handle>(sqlite3_column_int64(stmt, 1));
+        parents[static_cast<handle>(sqlite3_column_int64(stmt, 0))] = parent;
+        withChildren.insert(parent);
+    }
+    sqlite3_finalize(stmt);
+
+    // ancestry of nodes with children, to avoid walking up the same branches again
+    std::unordered_map<handle, std::string> known;
+    auto ancestryOf = [&parents, &withChildren, &known](handle h)
+    {
+        std::vector<handle> branch{h};
+        std::string ancestry;
+        for (;;)
+        {
+            handle parent = parents[branch.back()];
+            if (parent == UNDEF)
+            {
+                break;
+            }
+
+            if (auto it = known.find(parent); it != known.end())
+            {
+                ancestry = it->second;
+                break;
+            }
+
+            if (!parents.count(parent) || branch.size() > parents.size()) // not in DB / corrupt
+            {
+                ancestry = ancestryKey(parent);
+                break;
+            }
+
+            branch.push_back(parent);
+        }
+
+        for (auto it = branch.rbegin(); it != branch.rend(); ++it)
+        {
+            ancestry += ancestryKey(*it);
+            if (withChildren.count(*it))
+            {
+                known[*it] = ancestry;
+            }
+        }
+
+        return ancestry;
+    };
+
+    if (sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_debug << "Db error during migration for " << "BEGIN: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_prepare_v2(db, "UPDATE nodes SET ancestry = ? WHERE nodehandle = ?", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to populate ancestry: " << sqlite3_errmsg(db);
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    for (const auto& node : parents)
+    {
+        std::string ancestry = ancestryOf(node.first);
+
+        int stepResult;
+        if (sqlite3_bind_blob(stmt, 1, ancestry.data(), static_cast<int>(ancestry.size()), SQLITE_STATIC) != SQLITE_OK ||
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(node.first)) != SQLITE_OK ||
+            ((stepResult = sqlite3_step(stmt)) != SQLITE_DONE && stepResult != SQLITE_ROW) ||
+            sqlite3_reset(stmt) != SQLITE_OK)
+        {
+            LOG_err << "Db error during migration while updating ancestry: " << sqlite3_errmsg(db);
+            sqlite3_finalize(stmt);
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_debug << "Db error during migration for " << "COMMIT: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    LOG_info << "Migrating Data base - ancestry populated for " << parents.size() << " nodes";
+    return true;
+}
+
+bool SqliteDbAccess::createFullTextIndex(sqlite3* db)
+{
+    sqlite3_stmt* stmt = nullptr;
+    bool exists = false;
+    if (sqlite3_prepare_v2(db, "SELECT count(*) FROM sqlite_master WHERE type = 'table' AND name = 'nodesfts'", -1, &stmt, nullptr) == SQLITE_OK
+            && sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        exists = sqlite3_column_int(stmt, 0) > 0;
+    }
+    sqlite3_finalize(stmt);
+
+    // The trigram tokenizer (SQLite 3.34.0+) indexes every substring of 3 characters, so it can
+    // resolve "contains" searches, and it folds case (case_sensitive 0 is the default).
+    if (!exists && sqlite3_exec(db, "CREATE VIRTUAL TABLE nodesfts USING fts5(name, description, tags, tokenize = 'trigram')", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_warn << "Full-text index of nodes not available: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    // The table could have been created by a build of SQLite with a different set of modules
+    stmt = nullptr;
+    int result = sqlite3_prepare_v2(db, "SELECT rowid FROM nodesfts LIMIT 1", -1, &stmt, nullptr);
+    sqlite3_finalize(stmt);
+    if (result != SQLITE_OK)
+    {
+        LOG_warn << "Full-text index of nodes not usable: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    // Versions of the SDK not aware of the index can modify 'nodes' without updating it, so
+    // the index is only trusted if the marker row of 'nodesftsvalid' is present. Any change
+    // to 'nodes' removes it (triggers are run by those versions too, even without FTS5), and
+    // it's added back by every commit of the tables that keep the index in sync
+    // (see SqliteAccountState::markFullTextIndexInSync()).
+    const char* markerSql =
+        "CREATE TABLE IF NOT EXISTS nodesftsvalid (valid INTEGER);"
+        "CREATE TRIGGER IF NOT EXISTS nodesftsinsert AFTER INSERT ON nodes BEGIN DELETE FROM nodesftsvalid; END;"
+        "CREATE TRIGGER IF NOT EXISTS nodesftsupdate AFTER UPDATE ON nodes BEGIN DELETE FROM nodesftsvalid; END;"
+        "CREATE TRIGGER IF NOT EXISTS nodesftsdelete AFTER DELETE ON nodes BEGIN DELETE FROM nodesftsvalid; END;";
+    if (sqlite3_exec(db, markerSql, nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while creating the marker of the full-text index of nodes: " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (exists)
+    {
+        stmt = nullptr;
+        bool valid = false;
+        if (sqlite3_prepare_v2(db, "SELECT count(*) FROM nodesftsvalid", -1, &stmt, nullptr) == SQLITE_OK
+                && sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            valid = sqlite3_column_int(stmt, 0) > 0;
+        }
+        sqlite3_finalize(stmt);
+
+        if (valid)
+        {
+            return true;
+        }
+
+        LOG_warn << "Full-text index of nodes out of sync. Rebuilding it";
+        if (sqlite3_exec(db, "DELETE FROM nodesfts", nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            LOG_err << "Db error while clearing full-text index of nodes: " << sqlite3_errmsg(db);
+            return false;
+        }
+    }
+
+    // index the nodes already stored
+    if (sqlite3_exec(db, "INSERT INTO nodesfts (rowid, name, description, tags) SELECT nodehandle, name, description, tags FROM nodes", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while populating full-text index of nodes: " << sqlite3_errmsg(db);
+        sqlite3_exec(db, "DROP TABLE IF EXISTS nodesfts", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    ++mFullTextIndexBuilds;
+    if (sqlite3_exec(db, "INSERT INTO nodesftsvalid (valid) VALUES (1)", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while marking the full-text index of nodes as valid: " << sqlite3_errmsg(db);
+    }
+
+    LOG_debug << "Full-text index of nodes created";
+    return true;
+}
+
 SqliteDbTable::SqliteDbTable(PrnGen &rng, sqlite3* db, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack)
   : DbTable(rng, checkAlwaysTransacted, dBErrorCallBack)
   , db(db)
@@ -913,14 +1172,21 @@ void SqliteDbTable::errorHandler(int sqliteError, const string& operation, bool
     }
 }
 
-SqliteAccountState::SqliteAccountState(PrnGen &rng, sqlite3 *pdb, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack)
+SqliteAccountState::SqliteAccountState(PrnGen &rng, sqlite3 *pdb, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack, const bool hasFullTextIndex)
     : SqliteDbTable(rng, pdb, fsAccess, path, checkAlwaysTransacted, dBErrorCallBack)
+    , mHasFullTextIndex(hasFullTextIndex)
 {
 }
 
 SqliteAccountState::~SqliteAccountState()
 {
     finalise();
+
+    // out of a transaction every change is already committed (otherwise, pending ones are rolled back)
+    if (!inTransaction())
+    {
+        markFullTextIndexInSync();
+    }
 }
 
 int SqliteAccountState::progressHandler(void *param)
@@ -929,6 +1195,52 @@ int SqliteAccountState::progressHandler(void *param)
     return cancelFlag->isCancelled();
 }
 
+bool SqliteAccountState::registerUserFunctions(sqlite3* db)
+{
+    if (sqlite3_create_function(db, u8"getmimetype", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, 0, &SqliteAccountState::userGetMimetype, 0, 0) != SQLITE_OK)
+    {
+        LOG_err << "Data base error(sqlite3_create_function userGetMimetype): " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_create_collation(db,
+                                 "NATURALNOCASE",
+                                 SQLITE_UTF8,
+                                 nullptr,
+                                 sqlite_naturalsorting_compare))
+    {
+        LOG_err << "Data base error(sqlite3_create_collation NATURALNOCASE): "
+                << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_create_function(db, "regexp", 2, SQLITE_ANY,0, &SqliteAccountState::userRegexp, 0, 0))
+    {
+        LOG_err << "Data base error(sqlite3_create_function userRegexp): " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_create_function(db, "ismimetype", 2, SQLITE_ANY,0, &SqliteAccountState::userIsMimetype, 0, 0))
+    {
+        LOG_err << "Data base error(sqlite3_create_function userIsMimetype): " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_create_function(db, "isContained", 2, SQLITE_ANY,0, &SqliteAccountState::userIsContained, 0, 0))
+    {
+        LOG_err << "Data base error(sqlite3_create_function userIsContained): " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    if (sqlite3_create_function(db, "matchTag", 2, SQLITE_ANY,0, &SqliteAccountState::userMatchTag, 0, 0))
+    {
+        LOG_err << "Data base error(sqlite3_create_function userMatchTag): " << sqlite3_errmsg(db);
+        return false;
+    }
+
+    return true;
+}
+
 bool SqliteAccountState::processSqlQueryAllNodeTags(
     sqlite3_stmt* stmt,
     std::set<std::string>& tags,
@@ -1009,6 +1321,16 @@ bool SqliteAccountState::remove(NodeHandle nodehandle)
     int sqlResult = sqlite3_exec(db, buf, 0, 0, NULL);
     errorHandler(sqlResult, "Delete node", false);
 
+    if (sqlResult == SQLITE_OK && mHasFullTextIndex)
+    {
+        snprintf(buf, sizeof(buf), "DELETE FROM nodesfts WHERE rowid = %" PRId64, nodehandle.as8byte());
+
+        sqlResult = sqlite3_exec(db, buf, 0, 0, NULL);
+        errorHandler(sqlResult, "Delete node from full-text index", false);
+    }
+
+    nodesChanged();
+
     return sqlResult == SQLITE_OK;
 }
 
@@ -1024,6 +1346,14 @@ bool SqliteAccountState::removeNodes()
     int sqlResult = sqlite3_exec(db, "DELETE FROM nodes", 0, 0, NULL);
     errorHandler(sqlResult, "Delete nodes", false);
 
+    if (sqlResult == SQLITE_OK && mHasFullTextIndex)
+    {
+        sqlResult = sqlite3_exec(db, "DELETE FROM nodesfts", 0, 0, NULL);
+        errorHandler(sqlResult, "Delete nodes from full-text index", false);
+    }
+
+    nodesChanged();
+
     return sqlResult == SQLITE_OK;
 }
 
@@ -1057,6 +1387,8 @@ void SqliteAccountState::updateCounter(NodeHandle nodeHandle, const std::string&
     errorHandler(sqlResult, "Update counter", false);
 
     sqlite3_reset(mStmtUpdateNode);
+
+    nodesChanged();
 }
 
 void SqliteAccountState::updateCounterAndFlags(NodeHandle nodeHandle, uint64_t flags, const std::string& nodeCounterBlob)
@@ -1091,6 +1423,8 @@ void SqliteAccountState::updateCounterAndFlags(NodeHandle nodeHandle, uint64_t f
     errorHandler(sqlResult, "Update counter and flags", false);
 
     sqlite3_reset(mStmtUpdateNodeAndFlags);
+
+    nodesChanged();
 }
 
 void SqliteAccountState::createIndexes()
@@ -1141,17 +1475,266 @@ void SqliteAccountState::createIndexes()
     result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
     if (result)
     {
-        LOG_err << "Data base error while creating index (ctimeindex): " << sqlite3_errmsg(db);
+        LOG_err << "Data base error while creating index (ctimeindex): " << sqlite3_errmsg(db);
+    }
+
+    // searches by category (i.e. photo and video timelines) are resolved by this index
+    sql = "CREATE INDEX IF NOT EXISTS mimetypeindex on nodes (mimetype, type, ctime)";
+    result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    if (result)
+    {
+        LOG_err << "Data base error while creating index (mimetypeindex): " << sqlite3_errmsg(db);
+    }
+}
+
+void SqliteAccountState::startBulkLoad(bool relaxedSync)
+{
+    if (!db)
+    {
+        return;
+    }
+
+    // 'ancestryindex' is kept, since every put() of a node requires it
+    static const char* indexes[] = {"parenthandleindex", "fingerprintindex", "origFingerprintindex",
+                                    "shareindex", "favindex", "ctimeindex", "mimetypeindex"};
+    for (const char* index : indexes)
+    {
+        std::string sql = std::string("DROP INDEX IF EXISTS ") + index;
+        int result = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+        if (result)
+        {
+            LOG_err << "Data base error while dropping index (" << index << "): " << sqlite3_errmsg(db);
+        }
+    }
+
+    if (!relaxedSync || mSynchronousToRestore >= 0)
+    {
+        return;
+    }
+
+    // The safety level can't be changed inside a transaction
+    if (inTransaction())
+    {
+        LOG_warn << "Bulk load started inside a transaction, durability is not relaxed";
+        return;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    int synchronous = -1;
+    int sqlResult = sqlite3_prepare_v2(db, "PRAGMA synchronous", -1, &stmt, nullptr);
+    if (sqlResult == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        synchronous = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (synchronous < 0)
+    {
+        LOG_err << "Data base error while reading synchronous mode: " << sqlite3_errmsg(db);
+        return;
+    }
+
+    sqlResult = sqlite3_exec(db, "PRAGMA synchronous=OFF", nullptr, nullptr, nullptr);
+    if (sqlResult)
+    {
+        LOG_err << "Data base error while relaxing synchronous mode: " << sqlite3_errmsg(db);
+        return;
+    }
+
+    LOG_debug << "Synchronous mode is OFF until the next commit (bulk load)";
+    mSynchronousToRestore = synchronous;
+}
+
+void SqliteAccountState::restoreSynchronous()
+{
+    if (!db || mSynchronousToRestore < 0)
+    {
+        return;
+    }
+
+    std::string sql = "PRAGMA synchronous=" + std::to_string(mSynchronousToRestore);
+    int sqlResult = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    if (sqlResult)
+    {
+        LOG_err << "Data base error while restoring synchronous mode: " << sqlite3_errmsg(db);
+        return;
+    }
+
+    mSynchronousToRestore = -1;
+}
+
+void SqliteAccountState::commit()
+{
+    // MegaClient keeps the table always in a transaction, so the marker can't wait to be closed
+    if (inTransaction())
+    {
+        markFullTextIndexInSync();
+    }
+
+    SqliteDbTable::commit();
+    restoreSynchronous();
+
+    if (db && !inTransaction())
+    {
+        mCommittedNodesVersion = mNodesVersion.load();
+    }
+}
+
+void SqliteAccountState::abort()
+{
+    SqliteDbTable::abort();
+    restoreSynchronous();
+
+    // discarded changes may have been seen by queries on this connection
+    ++mNodesVersion;
+    mCommittedNodesVersion = mNodesVersion.load();
+}
+
+void SqliteAccountState::nodesChanged()
+{
+    ++mNodesVersion;
+
+    if (!inTransaction())
+    {
+        // autocommit: the change is already visible to other connections
+        mCommittedNodesVersion = mNodesVersion.load();
+    }
+}
+
+uint64_t SqliteAccountState::getNodesVersion() const
+{
+    return mNodesVersion;
+}
+
+std::shared_ptr<DBTableNodes> SqliteAccountState::getReadOnlyTable(uint64_t& version)
+{
+#if TARGET_OS_IPHONE
+    // without WAL mode, readers and the writer would block each other
+    return nullptr;
+#else
+    if (!db || mNodesVersion != mCommittedNodesVersion)
+    {
+        return nullptr;
+    }
+
+    version = mNodesVersion;
+
+    std::unique_ptr<SqliteAccountState> reader;
+    {
+        std::lock_guard<std::mutex> g(mReadOnlyConnections->mMutex);
+        if (!mReadOnlyConnections->mIdle.empty())
+        {
+            reader = std::move(mReadOnlyConnections->mIdle.back());
+            mReadOnlyConnections->mIdle.pop_back();
+        }
+        else if (mReadOnlyConnections->mOpened < MAX_READ_ONLY_CONNECTIONS)
+        {
+            reader = openReadOnlyTable();
+            if (reader)
+            {
+                ++mReadOnlyConnections->mOpened;
+            }
+        }
+    }
+
+    if (!reader)
+    {
+        return nullptr;
+    }
+
+    reader->useFullTextIndex(mUseFullTextIndex);
+
+    std::weak_ptr<ReadOnlyConnections> weakConnections = mReadOnlyConnections;
+    return std::shared_ptr<DBTableNodes>(reader.release(), [weakConnections](SqliteAccountState* r)
+    {
+        if (auto connections = weakConnections.lock())
+        {
+            r->resetStatements();
+            std::lock_guard<std::mutex> g(connections->mMutex);
+            connections->mIdle.emplace_back(r);
+            return;
+        }
+
+        // the DB has been closed or removed meanwhile
+        delete r;
+    });
+#endif
+}
+
+std::unique_ptr<SqliteAccountState> SqliteAccountState::openReadOnlyTable()
+{
+    sqlite3* readerDb = nullptr;
+    int result = sqlite3_open_v2(dbfile.toPath(false).c_str(), &readerDb,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX, nullptr);
+    if (result)
+    {
+        LOG_err << "Data base error while opening read-only connection: "
+                << (readerDb ? sqlite3_errmsg(readerDb) : std::to_string(result));
+        sqlite3_close(readerDb);
+        return nullptr;
+    }
+
+#if __ANDROID__
+    // same policy for temp store than the main connection (see openTableWithNodes())
+    result = sqlite3_exec(readerDb, "PRAGMA temp_store=2;", nullptr, nullptr, nullptr);
+    if (result)
+    {
+        LOG_err << "PRAGMA temp_store error " << sqlite3_errmsg(readerDb);
+        sqlite3_close(readerDb);
+        return nullptr;
+    }
+#endif
+
+    if (!registerUserFunctions(readerDb))
+    {
+        sqlite3_close(readerDb);
+        return nullptr;
+    }
+
+    return std::make_unique<SqliteAccountState>(rng, readerDb, *fsaccess, dbfile, false, mDBErrorCallBack, mHasFullTextIndex);
+}
+
+void SqliteAccountState::resetStatements()
+{
+    if (!db)
+    {
+        return;
+    }
+
+    for (sqlite3_stmt* stmt = sqlite3_next_stmt(db, nullptr); stmt; stmt = sqlite3_next_stmt(db, stmt))
+    {
+        if (sqlite3_stmt_busy(stmt))
+        {
+            sqlite3_reset(stmt);
+        }
     }
 }
 
 void SqliteAccountState::remove()
 {
+    // connections in use are closed when released
+    mReadOnlyConnections = std::make_shared<ReadOnlyConnections>();
+
     finalise();
 
     SqliteDbTable::remove();
 }
 
+void SqliteAccountState::markFullTextIndexInSync()
+{
+    // the read-only connections of the pool don't modify 'nodes'
+    if (!db || !mHasFullTextIndex || sqlite3_db_readonly(db, "main"))
+    {
+        return;
+    }
+
+    // the triggers on 'nodes' remove the marker when a node changes, including those changed here
+    if (sqlite3_exec(db, "INSERT INTO nodesftsvalid (valid) SELECT 1 WHERE NOT EXISTS (SELECT 1 FROM nodesftsvalid)", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while marking the full-text index of nodes as valid: " << sqlite3_errmsg(db);
+    }
+}
+
 void SqliteAccountState::finalise()
 {
     sqlite3_finalize(mStmtPutNode);
@@ -1190,6 +1773,12 @@ void SqliteAccountState::finalise()
     }
     mStmtSearchNodes.clear();
 
+    for (auto& s : mStmtSearchNodesRecursive)
+    {
+        sqlite3_finalize(s.second);
+    }
+    mStmtSearchNodesRecursive.clear();
+
     sqlite3_finalize(mStmtAllNodeTags);
     mStmtAllNodeTags = nullptr;
 
@@ -1217,8 +1806,11 @@ void SqliteAccountState::finalise()
     sqlite3_finalize(mStmtChildNode);
     mStmtChildNode = nullptr;
 
-    sqlite3_finalize(mStmtIsAncestor);
-    mStmtIsAncestor = nullptr;
+    sqlite3_finalize(mStmtNodeByMimeTypeExcludeRecursiveFlags);
+    mStmtNodeByMimeTypeExcludeRecursiveFlags = nullptr;
+
+    sqlite3_finalize(mStmtNodeByMimeTypeInSubtree);
+    mStmtNodeByMimeTypeInSubtree = nullptr;
 
     sqlite3_finalize(mStmtNumChild);
     mStmtNumChild = nullptr;
@@ -1228,6 +1820,15 @@ void SqliteAccountState::finalise()
 
     sqlite3_finalize(mStmtFavourites);
     mStmtFavourites = nullptr;
+
+    sqlite3_finalize(mStmtPutNodeFullText);
+    mStmtPutNodeFullText = nullptr;
+
+    sqlite3_finalize(mStmtGetAncestry);
+    mStmtGetAncestry = nullptr;
+
+    sqlite3_finalize(mStmtUpdateAncestry);
+    mStmtUpdateAncestry = nullptr;
 }
 
 bool SqliteAccountState::put(Node *node)
@@ -1243,10 +1844,25 @@ bool SqliteAccountState::put(Node *node)
     if (!mStmtPutNode)
     {
         sqlResult = sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO nodes (nodehandle, parenthandle, "
-                                           "name, fingerprint, origFingerprint, type, size, share, fav, ctime, mtime, flags, counter, node, label, description, tags) "
-                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", -1, &mStmtPutNode, NULL);
+                                           "name, fingerprint, origFingerprint, type, size, share, fav, ctime, mtime, flags, counter, node, label, description, tags, ancestry, mimetype) "
+                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", -1, &mStmtPutNode, NULL);
+    }
+
+    // Previous ancestry of the node, if any, is needed to update its descendants after a move.
+    // When the node is new, nodes added previously may have it as missing parent.
+    std::string oldAncestry;
+    if (sqlResult == SQLITE_OK && !getAncestry(node->nodeHandle(), oldAncestry))
+    {
+        oldAncestry = ancestryKey(node->nodehandle);
     }
 
+    std::string ancestry;
+    if (node->parenthandle != UNDEF && !getAncestry(node->parentHandle(), ancestry))
+    {
+        ancestry = ancestryKey(node->parenthandle);
+    }
+    ancestry += ancestryKey(node->nodehandle);
+
     if (sqlResult == SQLITE_OK)
     {
         string nodeSerialized;
@@ -1294,11 +1910,15 @@ bool SqliteAccountState::put(Node *node)
         int label = (labelIt == node->attrs.map.end()) ? LBL_UNKNOWN : std::atoi(labelIt->second.c_str());
         sqlite3_bind_int(mStmtPutNode, 15, label);
 
+        const std::string* descriptionPtr = nullptr;
+        const std::string* tagsPtr = nullptr;
+
         nameid descriptionId = AttrMap::string2nameid(MegaClient::NODE_ATTRIBUTE_DESCRIPTION);
         if (auto descriptionIt = node->attrs.map.find(descriptionId);
             descriptionIt != node->attrs.map.end())
         {
             const std::string& description = descriptionIt->second;
+            descriptionPtr = &description;
             sqlite3_bind_text(mStmtPutNode,
                               16,
                               description.c_str(),
@@ -1314,6 +1934,7 @@ bool SqliteAccountState::put(Node *node)
         if (auto tagIt = node->attrs.map.find(tagId); tagIt != node->attrs.map.end())
         {
             const std::string& tag = tagIt->second;
+            tagsPtr = &tag;
             sqlite3_bind_text(mStmtPutNode,
                               17,
                               tag.c_str(),
@@ -1325,16 +1946,255 @@ bool SqliteAccountState::put(Node *node)
             sqlite3_bind_null(mStmtPutNode, 17);
         }
 
+        sqlite3_bind_blob(mStmtPutNode, 18, ancestry.data(), static_cast<int>(ancestry.size()), SQLITE_STATIC);
+        sqlite3_bind_int(mStmtPutNode, 19, mimetypeFromName(name.c_str()));
+
         sqlResult = sqlite3_step(mStmtPutNode);
+
+        if (sqlResult == SQLITE_DONE && oldAncestry != ancestry)
+        {
+            updateDescendantsAncestry(oldAncestry, ancestry);
+        }
+
+        if (sqlResult == SQLITE_DONE && mHasFullTextIndex)
+        {
+            putFullText(node, name, descriptionPtr, tagsPtr);
+        }
     }
 
     errorHandler(sqlResult, "Put node", false);
 
     sqlite3_reset(mStmtPutNode);
 
+    nodesChanged();
+
+    return sqlResult == SQLITE_DONE;
+}
+
+// Longest run of ASCII characters in the pattern that any match must contain as is.
+// Non-ASCII characters are left out: the trigram tokenizer and icuLikeCompare() could
+// disagree about their case folding. Returns an empty string if the longest run is too
+// short to be looked up in a trigram index.
+static std::string longestFullTextLiteral(const std::string& pattern, bool hasWildcards)
+{
+    static constexpr size_t MIN_TRIGRAM_LENGTH = 3;
+
+    std::string longest;
+    std::string current;
+    for (const char& c : pattern)
+    {
+        bool isWildcard = hasWildcards && (c == WILDCARD_MATCH_ALL || c == WILDCARD_MATCH_ONE);
+        if (isWildcard || static_cast<unsigned char>(c) >= 0x80)
+        {
+            if (current.size() > longest.size())
+            {
+                longest.swap(current);
+            }
+            current.clear();
+            continue;
+        }
+
+        current.push_back(c);
+    }
+
+    if (current.size() > longest.size())
+    {
+        longest.swap(current);
+    }
+
+    return longest.size() < MIN_TRIGRAM_LENGTH ? std::string() : longest;
+}
+
+static void appendFullTextTerm(std::string& query, const char* column, const std::string& literal)
+{
+    if (literal.empty())
+    {
+        return;
+    }
+
+    if (!query.empty())
+    {
+        query += " AND ";
+    }
+
+    query += column;
+    query += " : \"";
+    for (const char& c : literal)
+    {
+        if (c == '"')
+        {
+            query.push_back('"'); // FTS5 strings escape double quotes by doubling them
+        }
+        query.push_back(c);
+    }
+    query += '"';
+}
+
+std::string SqliteAccountState::fullTextCondition(int flagIndex, int queryIndex) const
+{
+    if (!mHasFullTextIndex)
+    {
+        return std::string();
+    }
+
+    // Candidates are narrowed down by the index, but user functions (REGEXP, isContained...)
+    // remain the ones deciding if a node matches. The subquery doesn't depend on the
+    // outer row, so SQLite evaluates it only once per query.
+    std::string flag = "?" + std::to_string(flagIndex);
+    return "AND (" + flag + " = 0 OR nodehandle IN (SELECT rowid FROM nodesfts WHERE nodesfts MATCH ?" +
+           std::to_string(queryIndex) + ")) \n";
+}
+
+int SqliteAccountState::bindFullTextQuery(sqlite3_stmt* stmt, const NodeSearchFilter& filter, int flagIndex, int queryIndex, std::string& query) const
+{
+    if (!mHasFullTextIndex)
+    {
+        return SQLITE_OK;
+    }
+
+    query.clear();
+    if (mUseFullTextIndex)
+    {
+        appendFullTextTerm(query, "name", longestFullTextLiteral(filter.byName(), true));
+        appendFullTextTerm(query, "description", longestFullTextLiteral(filter.byDescription(), false));
+        appendFullTextTerm(query, "tags", longestFullTextLiteral(filter.byTag(), false));
+    }
+
+    int sqlResult = sqlite3_bind_int(stmt, flagIndex, !query.empty());
+    if (sqlResult == SQLITE_OK)
+    {
+        sqlResult = sqlite3_bind_text(stmt, queryIndex, query.c_str(), static_cast<int>(query.size()), SQLITE_STATIC);
+    }
+
+    return sqlResult;
+}
+
+int SqliteAccountState::bindCategory(sqlite3_stmt* stmt, int category, int firstIndex)
+{
+    // MIME_TYPE_ALL_DOCS groups several categories, any other one is bound to every parameter
+    static const int allDocs[] = {MIME_TYPE_DOCUMENT, MIME_TYPE_PDF, MIME_TYPE_PRESENTATION, MIME_TYPE_SPREADSHEET};
+
+    int sqlResult = SQLITE_OK;
+    for (int i = 0; i < 4 && sqlResult == SQLITE_OK; ++i)
+    {
+        int value = category == MIME_TYPE_ALL_DOCS ? allDocs[i] : category;
+        sqlResult = sqlite3_bind_int(stmt, firstIndex + i, value);
+    }
+
+    return sqlResult;
+}
+
+bool SqliteAccountState::hasFullTextIndex() const
+{
+    return mHasFullTextIndex;
+}
+
+void SqliteAccountState::useFullTextIndex(bool enable)
+{
+    mUseFullTextIndex = enable;
+}
+
+bool SqliteAccountState::getAncestry(NodeHandle nodeHandle, std::string& ancestry)
+{
+    int sqlResult = SQLITE_OK;
+    if (!mStmtGetAncestry)
+    {
+        sqlResult = sqlite3_prepare_v2(db, "SELECT ancestry FROM nodes WHERE nodehandle = ?", -1, &mStmtGetAncestry, NULL);
+    }
+
+    bool found = false;
+    if (sqlResult == SQLITE_OK)
+    {
+        if ((sqlResult = sqlite3_bind_int64(mStmtGetAncestry, 1, nodeHandle.as8byte())) == SQLITE_OK)
+        {
+            if ((sqlResult = sqlite3_step(mStmtGetAncestry)) == SQLITE_ROW)
+            {
+                const char* data = static_cast<const char*>(sqlite3_column_blob(mStmtGetAncestry, 0));
+                int size = sqlite3_column_bytes(mStmtGetAncestry, 0);
+                if (data && size)
+                {
+                    ancestry.assign(data, static_cast<size_t>(size));
+                    found = true;
+                }
+            }
+        }
+    }
+
+    errorHandler(sqlResult, "Get ancestry", false);
+
+    sqlite3_reset(mStmtGetAncestry);
+
+    return found;
+}
+
+bool SqliteAccountState::updateDescendantsAncestry(const std::string& oldPrefix, const std::string& newPrefix)
+{
+    int sqlResult = SQLITE_OK;
+    if (!mStmtUpdateAncestry)
+    {
+        // '||' returns text, that must be converted back to compare as blob with other values
+        sqlResult = sqlite3_prepare_v2(db, "UPDATE nodes SET ancestry = CAST(?1 || substr(ancestry, ?2) AS BLOB) "
+                                           "WHERE ancestry > ?3 AND ancestry < ?4", -1, &mStmtUpdateAncestry, NULL);
+    }
+
+    std::string upperBound = ancestryUpperBound(oldPrefix);
+    if (sqlResult == SQLITE_OK)
+    {
+        if ((sqlResult = sqlite3_bind_blob(mStmtUpdateAncestry, 1, newPrefix.data(), static_cast<int>(newPrefix.size()), SQLITE_STATIC)) == SQLITE_OK &&
+            (sqlResult = sqlite3_bind_int(mStmtUpdateAncestry, 2, static_cast<int>(oldPrefix.size()) + 1)) == SQLITE_OK &&
+            (sqlResult = sqlite3_bind_blob(mStmtUpdateAncestry, 3, oldPrefix.data(), static_cast<int>(oldPrefix.size()), SQLITE_STATIC)) == SQLITE_OK &&
+            (sqlResult = sqlite3_bind_blob(mStmtUpdateAncestry, 4, upperBound.data(), static_cast<int>(upperBound.size()), SQLITE_STATIC)) == SQLITE_OK)
+        {
+            sqlResult = sqlite3_step(mStmtUpdateAncestry);
+        }
+    }
+
+    errorHandler(sqlResult, "Update ancestry", false);
+
+    sqlite3_reset(mStmtUpdateAncestry);
+
     return sqlResult == SQLITE_DONE;
 }
 
+void SqliteAccountState::putFullText(Node* node, const std::string& name, const std::string* description, const std::string* tags)
+{
+    int sqlResult = SQLITE_OK;
+    if (!mStmtPutNodeFullText)
+    {
+        sqlResult = sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO nodesfts (rowid, name, description, tags) VALUES (?, ?, ?, ?)", -1, &mStmtPutNodeFullText, NULL);
+    }
+
+    if (sqlResult == SQLITE_OK)
+    {
+        sqlite3_bind_int64(mStmtPutNodeFullText, 1, node->nodehandle);
+        sqlite3_bind_text(mStmtPutNodeFullText, 2, name.c_str(), static_cast<int>(name.length()), SQLITE_STATIC);
+
+        if (description)
+        {
+            sqlite3_bind_text(mStmtPutNodeFullText, 3, description->c_str(), static_cast<int>(description->length()), SQLITE_STATIC);
+        }
+        else
+        {
+            sqlite3_bind_null(mStmtPutNodeFullText, 3);
+        }
+
+        if (tags)
+        {
+            sqlite3_bind_text(mStmtPutNodeFullText, 4, tags->c_str(), static_cast<int>(tags->length()), SQLITE_STATIC);
+        }
+        else
+        {
+            sqlite3_bind_null(mStmtPutNodeFullText, 4);
+        }
+
+        sqlResult = sqlite3_step(mStmtPutNodeFullText);
+    }
+
+    errorHandler(sqlResult, "Put node in full-text index", false);
+
+    sqlite3_reset(mStmtPutNodeFullText);
+}
+
 bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSerialized)
 {
     bool success = false;
@@ -1610,11 +2470,12 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, int o
                                  "AND (?8 = " + std::to_string(MIME_TYPE_UNKNOWN) +
                                      " OR (type = " + std::to_string(FILENODE) +
                                          " AND ((?8 = " + std::to_string(MIME_TYPE_ALL_DOCS) +
-                                               " AND mimetypeVirtual IN (" + std::to_string(MIME_TYPE_DOCUMENT) +
+                                               " AND mimetype IN (" + std::to_string(MIME_TYPE_DOCUMENT) +
                                                                 ',' + std::to_string(MIME_TYPE_PDF) +
                                                                 ',' + std::to_string(MIME_TYPE_PRESENTATION) +
                                                                 ',' + std::to_string(MIME_TYPE_SPREADSHEET) + "))"
-                                              " OR mimetypeVirtual = ?8))) "
+                                              " OR mimetype = ?8))) "
+                                 + fullTextCondition(22, 23) +
                                  "AND (?11 = 0 OR (name REGEXP ?9)) "
                                  "AND (?14 = 0 OR isContained(?15, description)) "
                                  "AND (?16 = 0 OR matchTag(?17, tags)) "
@@ -1626,6 +2487,7 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, int o
                                         " AND (flags & ?21) = ?21))" //
                                  // Leading and trailing '*' will be added to argument '?' so we are looking for substrings containing name
                                  // Our REGEXP implementation is case insensitive
+                                 "AND " + OrderByClause::getAfterCursor(order, 10, 24) + " \n" + // use ?24-?28 for the cursor
 
                                "ORDER BY \n" +
                                   OrderByClause::get(order, 10) + " \n" + // use ?10 for bound value
@@ -1652,6 +2514,7 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, int o
         const string& nameFilter = filter.byName();
         bool matchWildcard = std::any_of(nameFilter.begin(), nameFilter.end(), [](const char& c) { return c != '*'; });
         const string& wildCardName = matchWildcard ? '*' + filter.byName() + '*' : nameFilter;
+        string fullTextQuery;
         if ((sqlResult = sqlite3_bind_text(stmt, 9, wildCardName.c_str(), static_cast<int>(wildCardName.length()), SQLITE_STATIC)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 10, order)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 11, matchWildcard)) == SQLITE_OK &&
@@ -1664,7 +2527,9 @@ bool SqliteAccountState::getChildren(const mega::NodeSearchFilter& filter, int o
             (sqlResult = sqlite3_bind_int(stmt, 18, static_cast<int>(filter.byFavourite()))) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 19, filter.byFavourite() == NodeSearchFilter::BoolFilter::onlyTrue)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 20, static_cast<int>(filter.bySensitivity()))) == SQLITE_OK &&
-            (sqlResult = sqlite3_bind_int64(stmt, 21, senstivityFlag)) == SQLITE_OK)
+            (sqlResult = sqlite3_bind_int64(stmt, 21, senstivityFlag)) == SQLITE_OK &&
+            (sqlResult = bindFullTextQuery(stmt, filter, 22, 23, fullTextQuery)) == SQLITE_OK &&
+            (sqlResult = OrderByClause::bindCursor(stmt, order, 24, page)) == SQLITE_OK)
         {
             result = processSqlQueryNodes(stmt, children);
         }
@@ -1776,10 +2641,18 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
         sqlite3_progress_handler(db, NUM_VIRTUAL_MACHINE_INSTRUCTIONS, SqliteAccountState::progressHandler, static_cast<void*>(&cancelFlag));
     }
 
+    // Excluding sensitive nodes requires to prune the branches below them, so the tree is walked
+    // recursively. Otherwise, all descendants of ancestors are found by ancestry range, or, when
+    // searching by category, nodes of the category are found by 'mimetypeindex' and then checked
+    // to be descendants (much less rows than the whole tree for photo and video timelines).
+    bool recursive = filter.bySensitivity() == NodeSearchFilter::BoolFilter::onlyTrue;
+    bool byCategory = !recursive && filter.byCategory() != MIME_TYPE_UNKNOWN;
+
     // There are multiple criteria used in ORDER BY clause.
-    // For every combination of order-by directions, a separate query will be necessary.
-    size_t cacheId = OrderByClause::getId(order);
-    sqlite3_stmt*& stmt = mStmtSearchNodes[cacheId];
+    // For every combination of order-by directions, a separate query will be necessary
+    // (and separate ones for searches by category).
+    size_t cacheId = OrderByClause::getId(order) * 2 + byCategory;
+    sqlite3_stmt*& stmt = recursive ? mStmtSearchNodesRecursive[cacheId] : mStmtSearchNodes[cacheId];
 
     int sqlResult = SQLITE_OK;
     if (!stmt)
@@ -1787,8 +2660,8 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
         string undefStr{ std::to_string(static_cast<sqlite3_int64>(UNDEF)) };
 
         string ancestors =
-            "ancestors(nodehandle) \n"
-            "AS (SELECT nodehandle FROM nodes \n"
+            "ancestors(nodehandle, ancestry) \n"
+            "AS (SELECT nodehandle, ancestry FROM nodes \n"
                 "WHERE (?11 != " + undefStr + " AND nodehandle = ?11) "
                    "OR (?12 != " + undefStr + " AND nodehandle = ?12) "
                    "OR (?16 != " + undefStr + " AND nodehandle = ?16) "
@@ -1796,7 +2669,7 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
                       " AND nodehandle IN (SELECT nodehandle FROM nodes WHERE share = ?7)))";
 
         string columnsForNodeAndFilters =
-            "nodehandle, parenthandle, flags, name, type, counter, node, size, ctime, mtime, share, mimetypeVirtual, fav, label, description, tags";
+            "nodehandle, parenthandle, flags, name, type, counter, node, size, ctime, mtime, share, mimetype, fav, label, description, tags";
 
         string nodesOfShares =
             "nodesOfShares(" + columnsForNodeAndFilters + ") \n"
@@ -1804,14 +2677,26 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
                 "FROM nodes \n"
                 "WHERE ?7 != " + std::to_string(NO_SHARES) + " AND share = ?7)";
 
-        string nodesCTE =
+        // Versions (descendants of files) are found by ancestry too, but they're discarded by flags
+        string nodesCTE = !recursive ?
+            "nodesCTE(" + columnsForNodeAndFilters + ") \n"
+            "AS (SELECT N.nodehandle, N.parenthandle, N.flags, N.name, N.type, N.counter, N.node, "
+                "N.size, N.ctime, N.mtime, N.share, N.mimetype, N.fav, N.label, N.description, N.tags \n"
+                "FROM ancestors AS A \n"
+                "INNER JOIN nodes AS N \n"
+                        "ON (" + (byCategory ? "N.mimetype IN (?32, ?33, ?34, ?35) AND N.type = " + std::to_string(FILENODE) + " \n"
+                                               "AND " : "") +
+                            "N.ancestry > A.ancestry \n"
+                       // '||' returns text, that must be converted back to compare as blob
+                       "AND N.ancestry < CAST(A.ancestry || x'" + std::string(2 * (ANCESTRY_KEY_SIZE + 1), 'F') + "' AS BLOB)))"
+            :
             "nodesCTE(" + columnsForNodeAndFilters + ") \n"
             "AS (SELECT " + columnsForNodeAndFilters + " \n"
                 "FROM nodes \n"
                 "WHERE parenthandle IN (SELECT nodehandle FROM ancestors) \n"
                 "UNION ALL \n"
                 "SELECT N.nodehandle, N.parenthandle, N.flags, N.name, N.type, N.counter, N.node, "
-                "N.size, N.ctime, N.mtime, N.share, N.mimetypeVirtual, N.fav, N.label, N.description, N.tags \n"
+                "N.size, N.ctime, N.mtime, N.share, N.mimetype, N.fav, N.label, N.description, N.tags \n"
                 "FROM nodes AS N \n"
                 "INNER JOIN nodesCTE AS P \n"
                         "ON (N.parenthandle = P.nodehandle \n"
@@ -1833,11 +2718,12 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
             "AND (?8 = " + std::to_string(MIME_TYPE_UNKNOWN) +
                 " OR (type = " + std::to_string(FILENODE) +
                     " AND ((?8 = " + std::to_string(MIME_TYPE_ALL_DOCS) +
-                          " AND mimetypeVirtual IN (" + std::to_string(MIME_TYPE_DOCUMENT) +
+                          " AND mimetype IN (" + std::to_string(MIME_TYPE_DOCUMENT) +
                                            ',' + std::to_string(MIME_TYPE_PDF) +
                                            ',' + std::to_string(MIME_TYPE_PRESENTATION) +
                                            ',' + std::to_string(MIME_TYPE_SPREADSHEET) + "))"
-                         " OR mimetypeVirtual = ?8))) \n"
+                         " OR mimetype = ?8))) \n"
+            + fullTextCondition(25, 26) +
             "AND (?13 = 0 OR (name REGEXP ?9)) \n"
             "AND (?17 = 0 OR isContained(?18, description)) \n"
             "AND (?19 = 0 OR matchTag(?20, tags)) \n"
@@ -1872,6 +2758,7 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
 
             "SELECT " + columnsForNodeAndOrderBy + " \n"
             "FROM nodesAfterFilters \n"
+            "WHERE " + OrderByClause::getAfterCursor(order, 10, 27) + " \n" + // use ?27-?31 for the cursor
             "ORDER BY \n" + OrderByClause::get(order, 10) + " \n" + // use ?10 for bound value
             "LIMIT ?14 OFFSET ?15";
 
@@ -1896,6 +2783,7 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
         const string& byName = filter.byName();
         bool matchWildcard = std::any_of(byName.begin(), byName.end(), [](const char& c) { return c != '*'; });
         const string& nameFilter = matchWildcard ? '*' + byName + '*' : byName;
+        string fullTextQuery;
         if ((sqlResult = sqlite3_bind_text(stmt, 9, nameFilter.c_str(), static_cast<int>(nameFilter.size()), SQLITE_STATIC)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 10, order)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int64(stmt, 11, filter.byAncestorHandles()[0])) == SQLITE_OK &&
@@ -1911,7 +2799,10 @@ bool SqliteAccountState::searchNodes(const NodeSearchFilter& filter, int order,
             (sqlResult = sqlite3_bind_int(stmt, 21, static_cast<int>(filter.byFavourite()))) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 22, filter.byFavourite() == NodeSearchFilter::BoolFilter::onlyTrue)) == SQLITE_OK &&
             (sqlResult = sqlite3_bind_int(stmt, 23, static_cast<int>(filter.bySensitivity()))) == SQLITE_OK &&
-            (sqlResult = sqlite3_bind_int64(stmt, 24, senstivityFlag)) == SQLITE_OK)
+            (sqlResult = sqlite3_bind_int64(stmt, 24, senstivityFlag)) == SQLITE_OK &&
+            (sqlResult = bindFullTextQuery(stmt, filter, 25, 26, fullTextQuery)) == SQLITE_OK &&
+            (sqlResult = OrderByClause::bindCursor(stmt, order, 27, page)) == SQLITE_OK &&
+            (!byCategory || (sqlResult = bindCategory(stmt, filter.byCategory(), 32)) == SQLITE_OK))
         {
             result = processSqlQueryNodes(stmt, nodes);
         }
@@ -2317,56 +3208,31 @@ bool SqliteAccountState::getNodeSizeTypeAndFlags(NodeHandle node, m_off_t& size,
     return sqlResult == SQLITE_ROW;
 }
 
-bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, CancelToken cancelFlag)
+bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, CancelToken)
 {
-    bool result = false;
     if (!db)
     {
-        return result;
-    }
-
-    std::string sqlQuery = "WITH nodesCTE(nodehandle, parenthandle) "
-            "AS (SELECT nodehandle, parenthandle FROM nodes WHERE nodehandle = ? "
-            "UNION ALL SELECT A.nodehandle, A.parenthandle FROM nodes AS A INNER JOIN nodesCTE "
-            "AS E ON (A.nodehandle = E.parenthandle)) "
-            "SELECT * FROM nodesCTE WHERE parenthandle = ?";
-
-    if (cancelFlag.exists())
-    {
-        sqlite3_progress_handler(db, NUM_VIRTUAL_MACHINE_INSTRUCTIONS, SqliteAccountState::progressHandler, static_cast<void*>(&cancelFlag));
+        return false;
     }
 
-    int sqlResult = SQLITE_OK;
-    if (!mStmtIsAncestor)
+    // The lookup is by primary key: no need to register the progress handler for cancellation
+    std::string ancestry;
+    if (!getAncestry(node, ancestry))
     {
-        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtIsAncestor, NULL);
+        return false;
     }
 
-    if (sqlResult == SQLITE_OK)
+    // last key corresponds to the node itself
+    std::string key = ancestryKey(ancestor.as8byte());
+    for (size_t offset = 0; offset + ANCESTRY_KEY_SIZE < ancestry.size(); offset += ANCESTRY_KEY_SIZE)
     {
-        if ((sqlResult = sqlite3_bind_int64(mStmtIsAncestor, 1, node.as8byte())) == SQLITE_OK)
+        if (!ancestry.compare(offset, ANCESTRY_KEY_SIZE, key))
         {
-            if ((sqlResult = sqlite3_bind_int64(mStmtIsAncestor, 2, ancestor.as8byte())) == SQLITE_OK)
-            {
-                if ((sqlResult = sqlite3_step(mStmtIsAncestor)) == SQLITE_ROW)
-                {
-                    result = true;
-                }
-            }
+            return true;
         }
     }
 
-    // unregister the handler (no-op if not registered)
-    sqlite3_progress_handler(db, -1, nullptr, nullptr);
-
-    if (sqlResult != SQLITE_ROW && sqlResult != SQLITE_DONE)
-    {
-        errorHandler(sqlResult, "Is ancestor", true);
-    }
-
-    sqlite3_reset(mStmtIsAncestor);
-
-    return result;
+    return false;
 }
 
 uint64_t SqliteAccountState::getNumberOfNodes()
@@ -2505,6 +3371,51 @@ bool SqliteAccountState::getNodesByMimetypeExclusiveRecursive(MimeType_t mimeTyp
     bool result = false;
     int sqlResult = SQLITE_OK;
 
+    if (excludeRecursiveFlags.none())
+    {
+        // No branch to prune: every descendant is reachable by ancestry range
+        if (!mStmtNodeByMimeTypeInSubtree)
+        {
+            std::string query = "SELECT node.nodehandle, node.counter, node.node "
+                "FROM nodes AS node INNER JOIN nodes parent on node.parenthandle = parent.nodehandle "
+                "WHERE node.ancestry > ?1 AND node.ancestry < ?2 AND ismimetype(node.name, ?3) = 1 AND node.flags & ?4 = ?4 AND node.flags & ?5 = 0 "
+                "AND parent.type != " + std::to_string(FILENODE) + " AND node.type = " + std::to_string(FILENODE);
+
+            sqlResult = sqlite3_prepare_v2(db, query.c_str(), -1, &mStmtNodeByMimeTypeInSubtree, nullptr);
+        }
+
+        std::string ancestry;
+        if (!getAncestry(ancestorHandle, ancestry))
+        {
+            ancestry = ancestryKey(ancestorHandle.as8byte()); // descendants may exist without it
+        }
+        std::string upperBound = ancestryUpperBound(ancestry);
+
+        if (sqlResult == SQLITE_OK)
+        {
+            if ((sqlResult = sqlite3_bind_blob (mStmtNodeByMimeTypeInSubtree, 1, ancestry.data(), static_cast<int>(ancestry.size()), SQLITE_STATIC)) == SQLITE_OK &&
+                (sqlResult = sqlite3_bind_blob (mStmtNodeByMimeTypeInSubtree, 2, upperBound.data(), static_cast<int>(upperBound.size()), SQLITE_STATIC)) == SQLITE_OK &&
+                (sqlResult = sqlite3_bind_int  (mStmtNodeByMimeTypeInSubtree, 3, static_cast<int>(mimeType))) == SQLITE_OK &&
+                (sqlResult = sqlite3_bind_int64(mStmtNodeByMimeTypeInSubtree, 4, static_cast<sqlite3_int64>(requiredFlags.to_ulong()))) == SQLITE_OK &&
+                (sqlResult = sqlite3_bind_int64(mStmtNodeByMimeTypeInSubtree, 5, static_cast<sqlite3_int64>(excludeFlags.to_ulong()))) == SQLITE_OK)
+            {
+                result = processSqlQueryNodes(mStmtNodeByMimeTypeInSubtree, nodes);
+            }
+        }
+
+        // unregister the handler (no-op if not registered)
+        sqlite3_progress_handler(db, -1, nullptr, nullptr);
+
+        if (sqlResult != SQLITE_OK)
+        {
+            errorHandler(sqlResult, "Get by mime type in subtree", true);
+        }
+
+        sqlite3_reset(mStmtNodeByMimeTypeInSubtree);
+
+        return result;
+    }
+
     if (!mStmtNodeByMimeTypeExcludeRecursiveFlags)
     {
         // recursive query from ancestorHandle
@@ -2603,10 +3514,7 @@ void SqliteAccountState::userGetMimetype(sqlite3_context* context, int argc, sql
     }
 
     const char* fileName = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
-    string ext;
-    int result = (fileName && *fileName && Node::getExtension(ext, fileName) && !ext.empty()) ?
-                 Node::getMimetype(ext) : MimeType_t::MIME_TYPE_OTHERS;
-    sqlite3_result_int(context, result);
+    sqlite3_result_int(context, mimetypeFromName(fileName));
 }
 
 void SqliteAccountState::userIsContained(sqlite3_context* context, int argc, sqlite3_value** argv)
@@ -2660,40 +3568,126 @@ void SqliteAccountState::userIsContained(sqlite3_context* context, int argc, sql
     sqlite3_result_int(context, getTagPosition(tokens, tag) != tokens.end());
 }
 
-std::string OrderByClause::get(int order, int sqlParamIndex)
-{
-    // The sorting is done with this attributes preference:
-    // - type: Folders always first
-    // - attribute: depends on DESC/ASC (inverted for fav and label)
-    // - nodehandle: depends on DESC/ASC
+static const std::string nameSort = "name COLLATE NATURALNOCASE";
 
-    static const std::string nameSort = "name COLLATE NATURALNOCASE";
+std::string OrderByClause::getAttribute(int sqlParamIndex)
+{
+    // Columns added by migrations may be NULL for old rows, which is the same as 0 for sorting
     // clang-format off
     static const std::string fieldToSort =
         "WHEN " + std::to_string(DEFAULT_ASC)  + " THEN "+ nameSort + " \n"
         "WHEN " + std::to_string(DEFAULT_DESC) + " THEN "+ nameSort + " \n"
-        "WHEN " + std::to_string(SIZE_ASC)     + " THEN size \n"
-        "WHEN " + std::to_string(SIZE_DESC)    + " THEN size \n"
-        "WHEN " + std::to_string(CTIME_ASC)    + " THEN ctime \n"
-        "WHEN " + std::to_string(CTIME_DESC)   + " THEN ctime \n"
-        "WHEN " + std::to_string(MTIME_ASC)    + " THEN mtime \n"
-        "WHEN " + std::to_string(MTIME_DESC)   + " THEN mtime \n"
-        "WHEN " + std::to_string(LABEL_ASC)    + " THEN label \n"
-        "WHEN " + std::to_string(LABEL_DESC)   + " THEN label \n"
-        "WHEN " + std::to_string(FAV_ASC)      + " THEN fav \n"
-        "WHEN " + std::to_string(FAV_DESC)     + " THEN fav \n";
+        "WHEN " + std::to_string(SIZE_ASC)     + " THEN IFNULL(size, 0) \n"
+        "WHEN " + std::to_string(SIZE_DESC)    + " THEN IFNULL(size, 0) \n"
+        "WHEN " + std::to_string(CTIME_ASC)    + " THEN IFNULL(ctime, 0) \n"
+        "WHEN " + std::to_string(CTIME_DESC)   + " THEN IFNULL(ctime, 0) \n"
+        "WHEN " + std::to_string(MTIME_ASC)    + " THEN IFNULL(mtime, 0) \n"
+        "WHEN " + std::to_string(MTIME_DESC)   + " THEN IFNULL(mtime, 0) \n"
+        "WHEN " + std::to_string(LABEL_ASC)    + " THEN IFNULL(label, 0) \n"
+        "WHEN " + std::to_string(LABEL_DESC)   + " THEN IFNULL(label, 0) \n"
+        "WHEN " + std::to_string(FAV_ASC)      + " THEN IFNULL(fav, 0) \n"
+        "WHEN " + std::to_string(FAV_DESC)     + " THEN IFNULL(fav, 0) \n";
     // clang-format on
 
+    return "CASE ?" + std::to_string(sqlParamIndex) + " " + fieldToSort + "END";
+}
+
+std::string OrderByClause::get(int order, int sqlParamIndex)
+{
+    // The sorting is done with this attributes preference:
+    // - type: Folders always first
+    // - attribute: depends on DESC/ASC (inverted for fav and label)
+    // - name: depends on DESC/ASC
+    // - nodehandle: depends on DESC/ASC (so the order is total, as required by cursors)
+
     const std::bitset<2> directions = getDescendingDirs(order);
     static const std::array<std::string, 2> boolToDesc{"", "DESC"};
 
     static const std::string typeSort = "type DESC";
-    const std::string attrSort = "CASE ?" + std::to_string(sqlParamIndex) + " " + fieldToSort +
-                                 "END " + boolToDesc[directions[0]];
-    const std::string tiebreaker = nameSort + " " + boolToDesc[directions[1]];
+    const std::string attrSort = getAttribute(sqlParamIndex) + " " + boolToDesc[directions[0]];
+    const std::string tiebreaker = nameSort + " " + boolToDesc[directions[1]] + ", \n" +
+                                   "nodehandle " + boolToDesc[directions[1]];
     return typeSort + ", \n" + attrSort + ", \n" + tiebreaker;
 }
 
+std::string OrderByClause::getAfterCursor(int order, int sqlParamIndex, int cursorParamIndex)
+{
+    // Same preference than get(): a node goes after the cursor if it is after it by type, or by
+    // attribute with the same type, or by name with the same type and attribute...
+    const std::bitset<2> directions = getDescendingDirs(order);
+    static const std::array<std::string, 2> boolToAfter{" > ", " < "};
+
+    const std::string attribute = getAttribute(sqlParamIndex);
+    const std::string hasCursor = "?" + std::to_string(cursorParamIndex);
+    const std::string type = "?" + std::to_string(cursorParamIndex + 1);
+    const std::string attr = "?" + std::to_string(cursorParamIndex + 2);
+    const std::string name = "?" + std::to_string(cursorParamIndex + 3);
+    const std::string nodeHandle = "?" + std::to_string(cursorParamIndex + 4);
+
+    // The attribute is NULL for unknown orders, so it's compared by IS
+    return "(" + hasCursor + " = 0 \n"
+           "OR type < " + type + " \n"
+           "OR (type = " + type + " \n"
+               "AND (" + attribute + boolToAfter[directions[0]] + attr + " \n"
+                    "OR (" + attribute + " IS " + attr + " \n"
+                        "AND (" + nameSort + boolToAfter[directions[1]] + name + " \n"
+                             "OR (" + nameSort + " = " + name + " \n"
+                                 "AND nodehandle" + boolToAfter[directions[1]] + nodeHandle + "))))))";
+}
+
+int OrderByClause::bindCursor(sqlite3_stmt* stmt, int order, int cursorParamIndex, const NodeSearchPage& page)
+{
+    if (!page.hasCursor())
+    {
+        return sqlite3_bind_int(stmt, cursorParamIndex, 0);
+    }
+
+    const NodeSearchCursor& cursor = page.cursor();
+    const int attrParamIndex = cursorParamIndex + 2;
+
+    int sqlResult = SQLITE_OK;
+    switch (order)
+    {
+        case DEFAULT_ASC:
+        case DEFAULT_DESC:
+            sqlResult = sqlite3_bind_text(stmt, attrParamIndex, cursor.name.c_str(), static_cast<int>(cursor.name.size()), SQLITE_STATIC);
+            break;
+        case SIZE_ASC:
+        case SIZE_DESC:
+            sqlResult = sqlite3_bind_int64(stmt, attrParamIndex, cursor.size);
+            break;
+        case CTIME_ASC:
+        case CTIME_DESC:
+            sqlResult = sqlite3_bind_int64(stmt, attrParamIndex, cursor.ctime);
+            break;
+        case MTIME_ASC:
+        case MTIME_DESC:
+            sqlResult = sqlite3_bind_int64(stmt, attrParamIndex, cursor.mtime);
+            break;
+        case LABEL_ASC:
+        case LABEL_DESC:
+            sqlResult = sqlite3_bind_int(stmt, attrParamIndex, cursor.label);
+            break;
+        case FAV_ASC:
+        case FAV_DESC:
+            sqlResult = sqlite3_bind_int(stmt, attrParamIndex, cursor.fav);
+            break;
+        default:
+            sqlResult = sqlite3_bind_null(stmt, attrParamIndex);
+            break;
+    }
+
+    if (sqlResult == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmt, cursorParamIndex, 1)) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_int(stmt, cursorParamIndex + 1, cursor.type)) == SQLITE_OK &&
+        (sqlResult = sqlite3_bind_text(stmt, cursorParamIndex + 3, cursor.name.c_str(), static_cast<int>(cursor.name.size()), SQLITE_STATIC)) == SQLITE_OK)
+    {
+        sqlResult = sqlite3_bind_int64(stmt, cursorParamIndex + 4, cursor.nodeHandle);
+    }
+
+    return sqlResult;
+}
+
 size_t OrderByClause::getId(int order)
 {
     std::bitset<2> dirs = getDescendingDirs(order);
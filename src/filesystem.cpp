@@ -1015,6 +1015,97 @@ bool FileSystemAccess::fileExistsAt(const LocalPath& path)
 
 #ifdef ENABLE_SYNC
 
+// about 1 MB per sync.  Enough for the notifications read between two passes of the sync thread,
+// except for bulk operations, that end up rescanning most of the affected folders anyway
+const size_t NotificationQueue::DEFAULT_CAPACITY = 16384;
+
+NotificationQueue::NotificationQueue(size_t capacity)
+    : mQueue(capacity)
+{
+}
+
+bool NotificationQueue::pushBack(Notification&& n)
+{
+    if (mQueue.tryPush(std::move(n)))
+    {
+        return true;
+    }
+
+    ++mDropped;
+    return false;
+}
+
+bool NotificationQueue::popBatch(vector<Notification>& batch, size_t maxCount)
+{
+    batch.clear();
+
+    maxCount = std::min(maxCount, mQueue.capacity());
+
+    // at most half full
+    size_t tableSize = 2;
+    while (tableSize < 2 * maxCount) tableSize <<= 1;
+    mBatchIndex.assign(tableSize, 0);
+
+    Notification n;
+    uint64_t coalesced = 0;
+
+    while (batch.size() < maxCount && mQueue.tryPop(n))
+    {
+        size_t hash = n.path.hash()
+                    ^ (std::hash<LocalNode*>()(n.localnode) * 31 + static_cast<size_t>(n.scanRequirement));
+
+        size_t i = hash & (tableSize - 1);
+        for (; mBatchIndex[i]; i = (i + 1) & (tableSize - 1))
+        {
+            const Notification& previous = batch[mBatchIndex[i] - 1];
+            if (previous.localnode == n.localnode
+                && previous.scanRequirement == n.scanRequirement
+                && previous.path == n.path)
+            {
+                break;
+            }
+        }
+
+        if (mBatchIndex[i])
+        {
+            ++coalesced;
+            continue;
+        }
+
+        batch.emplace_back(std::move(n));
+        mBatchIndex[i] = static_cast<uint32_t>(batch.size());
+    }
+
+    if (coalesced)
+    {
+        mCoalesced += coalesced;
+    }
+
+    return !batch.empty();
+}
+
+void NotificationQueue::replaceLocalNodePointers(LocalNode* check, LocalNode* newvalue)
+{
+    // producers don't touch the notifications already queued until they are popped
+    mQueue.forEachQueued([&](Notification& n)
+    {
+        if (n.localnode == check)
+        {
+            n.localnode = newvalue;
+        }
+    });
+}
+
+bool NotificationQueue::empty() const
+{
+    return mQueue.empty();
+}
+
+size_t NotificationQueue::size() const
+{
+    return mQueue.size();
+}
+
 // default DirNotify: no notification available
 DirNotify::DirNotify(const LocalPath& rootPath)
 {
@@ -1050,12 +1141,17 @@ bool DirNotify::empty()
 }
 
 // notify base LocalNode + relative path/filename
-void DirNotify::notify(NotificationDeque& q, LocalNode* l, Notification::ScanRequirement sr, LocalPath&& path, bool immediate)
+void DirNotify::notify(NotificationQueue& q, LocalNode* l, Notification::ScanRequirement sr, LocalPath&& path, bool immediate)
 {
     // We may be executing on a thread here so we can't access the LocalNode data structures.  Queue everything, and
     // filter when the notifications are processed.  Also, queueing it here is faster than logging the decision anyway.
     Notification n(immediate ? 0 : Waiter::ds.load(), sr, std::move(path), l);
-    q.pushBack(std::move(n));
+
+    if (!q.pushBack(std::move(n)) && !mErrorCount++)
+    {
+        // Like an overflow of the OS buffer: the sync will be fully rescanned.
+        LOG_warn << "Filesystem notification queue full, dropping notifications for: " << localbasepath;
+    }
 }
 
 DirNotify* FileSystemAccess::newdirnotify(LocalNode&, const LocalPath& rootPath, Waiter*)
@@ -2401,6 +2497,7 @@ bool isNetworkFilesystem(FileSystemType type)
 
 
 std::atomic<size_t> ScanService::mNumServices(0);
+size_t ScanService::mNumThreads = ScanService::defaultNumThreads();
 std::unique_ptr<ScanService::Worker> ScanService::mWorker;
 std::mutex ScanService::mWorkerLock;
 
@@ -2412,7 +2509,7 @@ ScanService::ScanService()
 
     if (++mNumServices == 1)
     {
-        mWorker.reset(new Worker());
+        mWorker.reset(new Worker(mNumThreads));
     }
 }
 
@@ -2425,17 +2522,50 @@ ScanService::~ScanService()
     }
 }
 
-auto ScanService::queueScan(LocalPath targetPath, handle expectedFsid, bool followSymlinks, map<LocalPath, FSNode>&& priorScanChildren, shared_ptr<Waiter> waiter) -> RequestPtr
+auto ScanService::queueScan(LocalPath targetPath, handle expectedFsid, bool followSymlinks, map<LocalPath, FSNode>&& priorScanChildren, shared_ptr<Waiter> waiter, handle owner) -> RequestPtr
 {
     // Create a request to represent the scan.
     auto request = std::make_shared<ScanRequest>(std::move(waiter), followSymlinks, targetPath, expectedFsid, std::move(priorScanChildren));
 
     // Queue request for processing.
-    mWorker->queue(request);
+    mWorker->queue(request, owner);
 
     return request;
 }
 
+void ScanService::setNumThreads(size_t numThreads)
+{
+    numThreads = std::max<size_t>(numThreads, 1);
+
+    std::lock_guard<std::mutex> lock(mWorkerLock);
+
+    if (mNumThreads == numThreads)
+    {
+        return;
+    }
+
+    mNumThreads = numThreads;
+
+    if (mWorker)
+    {
+        mWorker->setNumThreads(numThreads);
+    }
+}
+
+size_t ScanService::numThreads()
+{
+    std::lock_guard<std::mutex> lock(mWorkerLock);
+    return mNumThreads;
+}
+
+size_t ScanService::defaultNumThreads()
+{
+    // Half of the cores, up to 4: scans are mostly waiting for the disk,
+    // and more threads only compete for it.
+    size_t cores = std::thread::hardware_concurrency();
+    return std::min<size_t>(std::max<size_t>(cores / 2, 1), 4);
+}
+
 ScanService::ScanRequest::ScanRequest(shared_ptr<Waiter> waiter,
     bool followSymLinks,
     LocalPath targetPath,
@@ -2452,8 +2582,8 @@ ScanService::ScanRequest::ScanRequest(shared_ptr<Waiter> waiter,
 }
 
 ScanService::Worker::Worker(size_t numThreads)
-    : mFsAccess(new FSACCESS_CLASS())
-    , mPending()
+    : mPending()
+    , mTurns()
     , mPendingLock()
     , mPendingNotifier()
     , mThreads()
@@ -2463,7 +2593,22 @@ ScanService::Worker::Worker(size_t numThreads)
 
     LOG_debug << "Starting ScanService worker...";
 
-    // Start the threads.
+    startThreads(numThreads);
+
+    LOG_debug << "ScanService worker started.";
+}
+
+ScanService::Worker::~Worker()
+{
+    LOG_debug << "Stopping ScanService worker...";
+
+    stopThreads();
+
+    LOG_debug << "ScanService worker stopped.";
+}
+
+void ScanService::Worker::startThreads(size_t numThreads)
+{
     while (numThreads--)
     {
         try
@@ -2477,17 +2622,14 @@ ScanService::Worker::Worker(size_t numThreads)
     }
 
     LOG_debug << mThreads.size() << " worker thread(s) started.";
-    LOG_debug << "ScanService worker started.";
 }
 
-ScanService::Worker::~Worker()
+void ScanService::Worker::stopThreads()
 {
-    LOG_debug << "Stopping ScanService worker...";
-
-    // Queue the 'terminate' sentinel.
+    // Tell the threads to leave.
     {
         std::unique_lock<std::mutex> lock(mPendingLock);
-        mPending.emplace_back();
+        mTerminating = true;
     }
 
     // Wake any sleeping threads.
@@ -2501,15 +2643,35 @@ ScanService::Worker::~Worker()
         thread.join();
     }
 
-    LOG_debug << "ScanService worker stopped.";
+    mThreads.clear();
+
+    std::unique_lock<std::mutex> lock(mPendingLock);
+    mTerminating = false;
+}
+
+void ScanService::Worker::setNumThreads(size_t numThreads)
+{
+    assert(numThreads > 0);
+
+    LOG_debug << "Restarting ScanService worker with " << numThreads << " thread(s)";
+
+    // Pending requests stay queued for the new threads.
+    stopThreads();
+    startThreads(numThreads);
 }
 
-void ScanService::Worker::queue(ScanRequestPtr request)
+void ScanService::Worker::queue(ScanRequestPtr request, handle owner)
 {
     // Queue the request.
     {
         std::unique_lock<std::mutex> lock(mPendingLock);
-        mPending.emplace_back(std::move(request));
+
+        auto& pending = mPending[owner];
+        if (pending.empty())
+        {
+            mTurns.emplace_back(owner);
+        }
+        pending.emplace_back(std::move(request));
     }
 
     // Tell the lucky thread it has something to do.
@@ -2518,8 +2680,11 @@ void ScanService::Worker::queue(ScanRequestPtr request)
 
 void ScanService::Worker::loop()
 {
+    // Each thread scans with its own filesystem access.
+    auto fsAccess = std::make_unique<FSACCESS_CLASS>();
+
     // We're ready when we have some work to do.
-    auto ready = [this]() { return !mPending.empty(); };
+    auto ready = [this]() { return mTerminating || !mTurns.empty(); };
 
     for ( ; ; )
     {
@@ -2530,17 +2695,33 @@ void ScanService::Worker::loop()
             std::unique_lock<std::mutex> lock(mPendingLock);
             mPendingNotifier.wait(lock, ready);
 
-            assert(ready()); // condition variable should have taken care of this
-
             // Are we being told to terminate?
-            if (!mPending.front())
+            if (mTerminating)
             {
-                // Bail, don't deque the sentinel.
                 return;
             }
 
-            request = std::move(mPending.front());
-            mPending.pop_front();
+            assert(ready()); // condition variable should have taken care of this
+
+            // Take the next request of the owner whose turn it is.
+            handle owner = mTurns.front();
+            mTurns.pop_front();
+
+            auto it = mPending.find(owner);
+            assert(it != mPending.end() && !it->second.empty());
+
+            request = std::move(it->second.front());
+            it->second.pop_front();
+
+            // And let the other owners go before its next one.
+            if (it->second.empty())
+            {
+                mPending.erase(it);
+            }
+            else
+            {
+                mTurns.emplace_back(owner);
+            }
         }
 
         LOG_verbose << "Directory scan begins: " << request->mTargetPath;
@@ -2549,7 +2730,7 @@ void ScanService::Worker::loop()
 
         // Process the request.
         unsigned nFingerprinted = 0;
-        auto result = scan(request, nFingerprinted);
+        auto result = scan(*fsAccess, request, nFingerprinted);
         auto scanEnd = high_resolution_clock::now();
 
         if (result == SCAN_SUCCESS)
@@ -2569,15 +2750,13 @@ void ScanService::Worker::loop()
     }
 }
 
-// Really we only have one worker despite the vector of threads - maybe we should just have one
-// regardless of multiple clients too - there is only one filesystem after all (but not singleton!!)
 CodeCounter::ScopeStats ScanService::syncScanTime = { "folderScan" };
 
-auto ScanService::Worker::scan(ScanRequestPtr request, unsigned& nFingerprinted) -> ScanResult
+auto ScanService::Worker::scan(FileSystemAccess& fsAccess, ScanRequestPtr request, unsigned& nFingerprinted) -> ScanResult
 {
     CodeCounter::ScopeTimer rst(syncScanTime);
 
-    auto result = mFsAccess->directoryScan(request->mTargetPath,
+    auto result = fsAccess.directoryScan(request->mTargetPath,
         request->mExpectedFsid,
         request->mKnown,
         request->mResults,
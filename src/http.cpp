@@ -20,6 +20,7 @@
  */
 
 #include "mega/http.h"
+#include "mega/bufferpool.h"
 #include "mega/megaclient.h"
 #include "mega/logging.h"
 #include "mega/proxy.h"
@@ -491,7 +492,7 @@ HttpReq::~HttpReq()
         httpio->cancel(this);
     }
 
-    delete[] buf;
+    BufferPool::instance().release(buf);
 }
 
 void HttpReq::init()
@@ -569,7 +570,7 @@ HttpReq::http_buf_t::http_buf_t(byte* b, size_t s, size_t e)
 
 HttpReq::http_buf_t::~http_buf_t()
 {
-    delete[] buf;
+    BufferPool::instance().release(buf);
 }
 
 void HttpReq::http_buf_t::swap(http_buf_t& other)
@@ -724,13 +725,13 @@ void HttpReqDL::prepare(const char* tempurl, SymmCipher* /*key*/,
         // (re)allocate buffer
         if (buf)
         {
-            delete[] buf;
+            BufferPool::instance().release(buf);
             buf = NULL;
         }
 
         if (size)
         {
-            buf = new byte[(size + SymmCipher::BLOCKSIZE - 1) & - SymmCipher::BLOCKSIZE];
+            buf = BufferPool::instance().acquire((size + SymmCipher::BLOCKSIZE - 1) & - SymmCipher::BLOCKSIZE);
         }
         buflen = size;
     }
@@ -888,6 +889,7 @@ void SpeedController::requestStarted()
 
     mRequestPos = 0;
     mRequestStart = mLastRequestUpdate = currentTime;
+    mRequestFirstData = 0;
 
     // Increment the initial time by the time since the last circular update
     // (almost equivalent to mLastRequestUpdate). This ensures an accurate total
@@ -904,6 +906,10 @@ m_off_t SpeedController::requestProgressed(m_off_t newPos)
         calculateSpeed(delta);
         mRequestPos = newPos;
         mLastRequestUpdate = Waiter::ds;
+        if (!mRequestFirstData)
+        {
+            mRequestFirstData = mLastRequestUpdate;
+        }
         return delta;
     }
     return 0;
@@ -924,6 +930,11 @@ dstime SpeedController::requestElapsedDs() const
     return Waiter::ds - mRequestStart;
 }
 
+dstime SpeedController::requestLatencyDs() const
+{
+    return (mRequestFirstData ? mRequestFirstData : Waiter::ds.load()) - mRequestStart;
+}
+
 m_off_t SpeedController::getMeanSpeed() const
 {
     return mMeanSpeed;
@@ -27,18 +27,143 @@
 #include "mega/logging.h"
 #include "mega/mega_utf8proc.h"
 
+// Strings are scanned with SSE2 when available (always on x86-64). The aligned 16-byte reads may go
+// past the end of the string, but never cross a page boundary. Since AddressSanitizer would report
+// them anyway, the scalar code is used in those builds.
+#if defined(__SANITIZE_ADDRESS__)
+#define MEGA_JSON_NO_VECTOR_SCAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MEGA_JSON_NO_VECTOR_SCAN 1
+#endif
+#endif
+
+#if !defined(MEGA_JSON_NO_VECTOR_SCAN) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MEGA_JSON_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 namespace mega {
 
 bool g_jsonLoggingOn = false;
 #define JSON_verbose if (g_jsonLoggingOn) LOG_verbose
 
+namespace {
+
+#ifdef MEGA_JSON_SSE2
+bool g_jsonVectorScan = true;
+
+unsigned countTrailingZeros(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// bit i is set if the byte i of the block is '"', '\\' or the NUL terminator
+unsigned quoteOrBackslashMask(const __m128i* block)
+{
+    const __m128i data = _mm_load_si128(block);
+    const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('"')),
+                                                     _mm_cmpeq_epi8(data, _mm_set1_epi8('\\'))),
+                                       _mm_cmpeq_epi8(data, _mm_setzero_si128()));
+    return static_cast<unsigned>(_mm_movemask_epi8(found));
+}
+#else
+bool g_jsonVectorScan = false;
+#endif
+
+// Returns the first '"', '\\' or NUL terminator from 'p'
+const char* findQuoteOrBackslash(const char* p)
+{
+#ifdef MEGA_JSON_SSE2
+    if (g_jsonVectorScan)
+    {
+        // start from the aligned block containing 'p', ignoring the bytes before it
+        const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        const __m128i* block = reinterpret_cast<const __m128i*>(address & ~uintptr_t(15));
+        unsigned mask = quoteOrBackslashMask(block) & (0xFFFFu << (address & 15));
+        while (!mask)
+        {
+            mask = quoteOrBackslashMask(++block);
+        }
+
+        return reinterpret_cast<const char*>(block) + countTrailingZeros(mask);
+    }
+#endif
+
+    while (*p && *p != '"' && *p != '\\')
+    {
+        p++;
+    }
+
+    return p;
+}
+
+} // namespace
+
+const char* JSON::stringEnd(const char* p)
+{
+    for (;;)
+    {
+        p = findQuoteOrBackslash(p);
+        if (*p == '"')
+        {
+            return p;
+        }
+
+        if (!*p || !p[1])
+        {
+            return nullptr;
+        }
+
+        // skip the escaped char
+        p += 2;
+    }
+}
+
+bool JSON::hasVectorScan()
+{
+#ifdef MEGA_JSON_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JSON::useVectorScan(bool enable)
+{
+    g_jsonVectorScan = enable && hasVectorScan();
+}
+
 // store array or object in string s
 // reposition after object
 bool JSON::storeobject(string* s)
+{
+    std::string_view value;
+    if (!storeobject(value))
+    {
+        return false;
+    }
+
+    if (s)
+    {
+        s->assign(value);
+    }
+    return true;
+}
+
+bool JSON::storeobject(std::string_view& value)
 {
     int openobject[2] = { 0 };
     const char* ptr;
-    bool escaped = false;
 
     while (*(const signed char*)pos > 0 && *pos <= ' ')
     {
@@ -73,15 +198,8 @@ bool JSON::storeobject(string* s)
         }
         else if (*ptr == '"')
         {
-            ptr++;
-
-            while (*ptr && (escaped || *ptr != '"'))
-            {
-                escaped = *ptr == '\\' && !escaped;
-                ptr++;
-            }
-
-            if (!*ptr)
+            ptr = stringEnd(ptr + 1);
+            if (!ptr)
             {
                 LOG_err << "Parse error (\")";
                 return false;
@@ -108,16 +226,13 @@ bool JSON::storeobject(string* s)
 
         if (!openobject[0] && !openobject[1])
         {
-            if (s)
+            if (*pos == '"')
             {
-                if (*pos == '"')
-                {
-                    s->assign(pos + 1, ptr - pos - 2);
-                }
-                else
-                {
-                    s->assign(pos, ptr - pos);
-                }
+                value = std::string_view(pos + 1, static_cast<size_t>(ptr - pos - 2));
+            }
+            else
+            {
+                value = std::string_view(pos, static_cast<size_t>(ptr - pos));
             }
 
             pos = ptr;
@@ -220,6 +335,11 @@ nameid JSON::getnameidvalue()
 }
 
 std::string JSON::getname()
+{
+    return string(getnameView());
+}
+
+std::string JSON::getnameWithoutAdvance() const
 {
     const char* ptr = pos;
     string name;
@@ -231,22 +351,16 @@ std::string JSON::getname()
 
     if (*ptr++ == '"')
     {
-        while (*ptr && *ptr != '"')
-        {
-            name += *ptr;
-            ptr++;
-        }
-
-        pos = ptr + 2;
+        name = stringView(ptr);
     }
 
     return name;
 }
 
-std::string JSON::getnameWithoutAdvance() const
+std::string_view JSON::getnameView()
 {
     const char* ptr = pos;
-    string name;
+    std::string_view name;
 
     if (*ptr == ',' || *ptr == ':')
     {
@@ -255,11 +369,8 @@ std::string JSON::getnameWithoutAdvance() const
 
     if (*ptr++ == '"')
     {
-        while (*ptr && *ptr != '"')
-        {
-            name += *ptr;
-            ptr++;
-        }
+        name = stringView(ptr);
+        pos = ptr + name.size() + 2;
     }
 
     return name;
@@ -680,6 +791,18 @@ void JSON::unescape(string* s)
     }
 }
 
+std::string_view JSON::unescape(std::string_view value, string& buffer)
+{
+    if (value.find('\\') == std::string_view::npos)
+    {
+        return value;
+    }
+
+    buffer.assign(value);
+    unescape(&buffer);
+    return buffer;
+}
+
 bool JSON::extractstringvalue(const string &json, const string &name, string *value)
 {
     string pattern = name + "\":\"";
@@ -739,23 +862,18 @@ void JSON::begin(const char* json)
 // copy remainder of quoted string (no unescaping, use for base64 data only)
 void JSON::copystring(string* s, const char* p)
 {
-    if (p)
-    {
-        const char* pp;
+    s->assign(stringView(p));
+}
 
-        if ((pp = strchr(p, '"')))
-        {
-            s->assign(p, pp - p);
-        }
-        else
-        {
-            *s = p;
-        }
-    }
-    else
+std::string_view JSON::stringView(const char* p)
+{
+    if (!p)
     {
-        s->clear();
+        return {};
     }
+
+    const char* pp = strchr(p, '"');
+    return pp ? std::string_view(p, static_cast<size_t>(pp - p)) : std::string_view(p);
 }
 
 string JSON::stripWhitespace(const string& text)
@@ -1434,22 +1552,8 @@ bool JSONSplitter::isStarting()
 
 int JSONSplitter::strEnd()
 {
-    const char* ptr = mPos;
-    while ((ptr = strchr(ptr + 1, '"')))
-    {
-        const char *e = ptr;
-        while (*(--e) == '\\')
-        {
-            // noop
-        }
-
-        if ((ptr - e) & 1)
-        {
-            return int(ptr + 1 - mPos);
-        }
-    }
-
-    return -1;
+    const char* end = JSON::stringEnd(mPos + 1);
+    return end ? int(end + 1 - mPos) : -1;
 }
 
 int JSONSplitter::numEnd()
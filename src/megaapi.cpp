@@ -3475,6 +3475,11 @@ void MegaApi::setMaxConnections(int connections, MegaRequestListener *listener)
     pImpl->setMaxConnections(-1,  connections, listener);
 }
 
+void MegaApi::setAdaptiveConnections(bool enable)
+{
+    pImpl->setAdaptiveConnections(enable);
+}
+
 void MegaApi::setDownloadMethod(int method)
 {
     pImpl->setDownloadMethod(method);
@@ -3850,6 +3855,11 @@ bool MegaApi::isSyncing()
     return pImpl->isSyncing();
 }
 
+void MegaApi::setSyncScanThreads(int numThreads)
+{
+    pImpl->setSyncScanThreads(numThreads);
+}
+
 int MegaApi::isNodeSyncable(MegaNode *node)
 {
     return pImpl->isNodeSyncable(node);
@@ -4275,6 +4285,16 @@ void MegaApi::setPublicKeyPinning(bool enable)
     pImpl->setPublicKeyPinning(enable);
 }
 
+bool MegaApi::setHttp2(bool enable)
+{
+    return pImpl->setHttp2(enable);
+}
+
+void MegaApi::setRequestPipelining(bool enable)
+{
+    pImpl->setRequestPipelining(enable);
+}
+
 void MegaApi::pauseActionPackets()
 {
     pImpl->pauseActionPackets();
@@ -4641,6 +4661,41 @@ unsigned long long MegaApi::getNumNodesAtCacheLRU() const
     return pImpl->getNumNodesAtCacheLRU();
 }
 
+void MegaApi::setNodeUnserializationThreads(unsigned int numThreads)
+{
+    pImpl->setNodeUnserializationThreads(numThreads);
+}
+
+void MegaApi::setFetchNodesRelaxedSync(bool enable)
+{
+    pImpl->setFetchNodesRelaxedSync(enable);
+}
+
+void MegaApi::setLRUCacheMaxBytes(unsigned long long bytes)
+{
+    pImpl->setLRUCacheMaxBytes(bytes);
+}
+
+unsigned long long MegaApi::getBytesAtCacheLRU() const
+{
+    return pImpl->getBytesAtCacheLRU();
+}
+
+unsigned long long MegaApi::getNumNodesInRam() const
+{
+    return pImpl->getNumNodesInRam();
+}
+
+unsigned long long MegaApi::getNodeLookupHits() const
+{
+    return pImpl->getNodeLookupHits();
+}
+
+unsigned long long MegaApi::getNodeLookupMisses() const
+{
+    return pImpl->getNodeLookupMisses();
+}
+
 long long MegaApi::getTotalDownloadedBytes()
 {
     return pImpl->getTotalDownloadedBytes();
@@ -7114,6 +7169,16 @@ MegaSearchPage* MegaSearchPage::createInstance(size_t startingOffset, size_t siz
     return new MegaSearchPagePrivate(startingOffset, size);
 }
 
+MegaSearchPage* MegaSearchPage::createInstanceAfter(MegaNode* lastNode, size_t size)
+{
+    if (!lastNode)
+    {
+        return nullptr;
+    }
+
+    return new MegaSearchPagePrivate(lastNode, size);
+}
+
 MegaSearchPage* MegaSearchPage::copy() const
 {
     return nullptr;
@@ -7133,6 +7198,11 @@ size_t MegaSearchPage::size() const
     return 0u;
 }
 
+MegaHandle MegaSearchPage::lastNodeHandle() const
+{
+    return INVALID_HANDLE;
+}
+
 MegaApiLock::MegaApiLock(MegaApiImpl* ptr, bool lock) : api(ptr)
 {
     if (lock)
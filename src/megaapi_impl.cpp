@@ -1394,6 +1394,12 @@ bool MegaApiImpl::isSyncing()
     return receivedSyncingStateFlag.load();
 }
 
+void MegaApiImpl::setSyncScanThreads(int numThreads)
+{
+    // the scan threads have their own thread safety
+    ScanService::setNumThreads(numThreads > 0 ? size_t(numThreads) : ScanService::defaultNumThreads());
+}
+
 MegaSync *MegaApiImpl::getSyncByBackupId(mega::MegaHandle backupId)
 {
     // syncs has its own thread safety
@@ -6208,6 +6214,36 @@ int MegaSearchFilterPrivate::validateBoolFilterOption(const int value)
     }
 }
 
+MegaSearchPagePrivate::MegaSearchPagePrivate(MegaNode* lastNode, size_t size)
+    : mOffset(0)
+    , mSize(size)
+{
+    mCursor.nodeHandle = lastNode->getHandle();
+    mCursor.type = static_cast<nodetype_t>(lastNode->getType());
+    mCursor.name = lastNode->getName() ? lastNode->getName() : "";
+    mCursor.size = lastNode->getSize();
+    mCursor.ctime = lastNode->getCreationTime();
+    mCursor.mtime = lastNode->getModificationTime();
+    mCursor.label = lastNode->getLabel();
+    mCursor.fav = lastNode->isFavourite();
+}
+
+NodeSearchPage MegaSearchPagePrivate::toNodeSearchPage(const MegaSearchPage* page)
+{
+    if (!page)
+    {
+        return NodeSearchPage(0u, 0u);
+    }
+
+    auto pagePrivate = dynamic_cast<const MegaSearchPagePrivate*>(page);
+    if (pagePrivate && pagePrivate->mCursor.nodeHandle != UNDEF)
+    {
+        return NodeSearchPage(pagePrivate->mCursor, pagePrivate->mSize);
+    }
+
+    return NodeSearchPage(page->startingOffset(), page->size());
+}
+
 std::unique_ptr<MegaGfxProviderPrivate> MegaGfxProviderPrivate::createIsolatedInstance(
     const std::string& endpointName,
     const std::string& executable)
@@ -8956,6 +8992,12 @@ void MegaApiImpl::setUploadLimit(int bpslimit)
     client->putmbpscap = bpslimit;
 }
 
+void MegaApiImpl::setAdaptiveConnections(bool enable)
+{
+    SdkMutexGuard g(sdkMutex);
+    client->adaptiveconnections = enable;
+}
+
 void MegaApiImpl::setDownloadMethod(int method)
 {
     switch(method)
@@ -12214,6 +12256,18 @@ void MegaApiImpl::setPublicKeyPinning(bool enable)
     client->httpio->disablepkp = !enable;
 }
 
+bool MegaApiImpl::setHttp2(bool enable)
+{
+    SdkMutexGuard g(sdkMutex);
+    return client->httpio->sethttp2(enable);
+}
+
+void MegaApiImpl::setRequestPipelining(bool enable)
+{
+    SdkMutexGuard g(sdkMutex);
+    client->reqs.setPipelining(enable);
+}
+
 void MegaApiImpl::pauseActionPackets()
 {
     SdkMutexGuard g(sdkMutex);
@@ -12417,23 +12471,19 @@ MegaNodeList* MegaApiImpl::search(const MegaSearchFilter* filter, int order, Can
 
     sharedNode_vector searchResults;
 
-    // search
+    // search (NodeManager is thread-safe, no need to lock the sdkMutex, like in getChildren())
+    switch (filter->byLocation())
     {
-        SdkMutexGuard g(sdkMutex);
-
-        switch (filter->byLocation())
-        {
-        case MegaApi::SEARCH_TARGET_ALL:
-        case MegaApi::SEARCH_TARGET_ROOTNODE: // Search on Cloud root and Vault, excluding Rubbish
-        case MegaApi::SEARCH_TARGET_INSHARE:
-        case MegaApi::SEARCH_TARGET_OUTSHARE:
-        case MegaApi::SEARCH_TARGET_PUBLICLINK:
-            searchResults = searchInNodeManager(filter, order, cancelToken, searchPage);
-            break;
-        default:
-            LOG_err << "Search not implemented for Location " << filter->byLocation();
-        }
-    } // end scope for mutex guard
+    case MegaApi::SEARCH_TARGET_ALL:
+    case MegaApi::SEARCH_TARGET_ROOTNODE: // Search on Cloud root and Vault, excluding Rubbish
+    case MegaApi::SEARCH_TARGET_INSHARE:
+    case MegaApi::SEARCH_TARGET_OUTSHARE:
+    case MegaApi::SEARCH_TARGET_PUBLICLINK:
+        searchResults = searchInNodeManager(filter, order, cancelToken, searchPage);
+        break;
+    default:
+        LOG_err << "Search not implemented for Location " << filter->byLocation();
+    }
 
     MegaNodeListPrivate* nodeList = new MegaNodeListPrivate(searchResults);
 
@@ -12464,7 +12514,7 @@ sharedNode_vector MegaApiImpl::searchInNodeManager(const MegaSearchFilter* filte
         nf.setIncludedShares(IN_SHARES);
     }
 
-    const NodeSearchPage& np = searchPage ? NodeSearchPage(searchPage->startingOffset(), searchPage->size()) : NodeSearchPage(0, 0);
+    const NodeSearchPage np = MegaSearchPagePrivate::toNodeSearchPage(searchPage);
     sharedNode_vector results = client->mNodeManager.searchNodes(nf, order, cancelToken, np);
     return results;
 }
@@ -18084,7 +18134,7 @@ MegaNodeList *MegaApiImpl::getChildren(const MegaSearchFilter* filter, int order
 
     NodeSearchFilter nf;
     nf.copyFrom(*filter);
-    const NodeSearchPage& np = searchPage ? NodeSearchPage(searchPage->startingOffset(), searchPage->size()) : NodeSearchPage(0u, 0u);
+    const NodeSearchPage np = MegaSearchPagePrivate::toNodeSearchPage(searchPage);
     sharedNode_vector results = client->mNodeManager.getChildren(nf, order, cancelToken, np);
 
     return new MegaNodeListPrivate(results);
@@ -25673,6 +25723,41 @@ unsigned long long MegaApiImpl::getNumNodesAtCacheLRU() const
     return client->mNodeManager.getNumNodesAtCacheLRU();
 }
 
+void MegaApiImpl::setNodeUnserializationThreads(unsigned int numThreads)
+{
+    client->mNodeManager.setUnserializationThreads(numThreads);
+}
+
+void MegaApiImpl::setFetchNodesRelaxedSync(bool enable)
+{
+    client->mNodeManager.setBulkLoadRelaxedSync(enable);
+}
+
+void MegaApiImpl::setLRUCacheMaxBytes(unsigned long long bytes)
+{
+    client->mNodeManager.setCacheLRUMaxBytes(bytes);
+}
+
+unsigned long long MegaApiImpl::getBytesAtCacheLRU() const
+{
+    return client->mNodeManager.getCacheLRUBytes();
+}
+
+unsigned long long MegaApiImpl::getNumNodesInRam() const
+{
+    return client->mNodeManager.getNumberNodesInRam();
+}
+
+unsigned long long MegaApiImpl::getNodeLookupHits() const
+{
+    return client->mNodeManager.getNodeByHandleHits();
+}
+
+unsigned long long MegaApiImpl::getNodeLookupMisses() const
+{
+    return client->mNodeManager.getNodeByHandleMisses();
+}
+
 long long MegaApiImpl::getTotalDownloadedBytes()
 {
     return totalDownloadedBytes;
@@ -20,6 +20,7 @@
  */
 
 #include "mega.h"
+#include "mega/bufferpool.h"
 #include "mega/mediafileattribute.h"
 #include <cctype>
 #include <ctime>
@@ -1710,6 +1711,10 @@ void MegaClient::init()
     pendingcs_serverBusySent = false;
 
     btcs.reset();
+    for (BackoffTimer& bt : btcsPipelined)
+    {
+        bt.reset();
+    }
     btsc.reset();
     btpfa.reset();
     btbadhost.reset();
@@ -1752,6 +1757,7 @@ MegaClient::MegaClient(MegaApp* a, shared_ptr<Waiter> w, HttpIO* h, DbAccess* d,
    , useralerts(*this)
    , btugexpiration(rng)
    , btcs(rng)
+   , btcsPipelined(RequestDispatcher::MAX_PIPELINED_REQUESTS, BackoffTimer(rng))
    , btbadhost(rng)
    , btworkinglock(rng)
    , btreqstat(rng)
@@ -1968,6 +1974,48 @@ std::string MegaClient::getWritableLinkAuthKey(handle nodeHandle)
     return {};
 }
 
+bool MegaClient::csrequestsslerror(const HttpReq& req)
+{
+    sendevent(99453, "Invalid public key");
+    sslfakeissuer = req.sslfakeissuer;
+    app->request_error(API_ESSL);
+    sslfakeissuer.clear();
+
+    return !retryessl;
+}
+
+// error of a failed API request, and its JSON for the commands of the batch
+static error csrequesterror(const string& in, string& requestError)
+{
+    JSON json;
+    json.pos = in.c_str();
+    error e;
+    bool valid = json.storeobject(&requestError);
+    if (valid)
+    {
+        if (strncmp(requestError.c_str(), "{\"err\":", 7) == 0)
+        {
+            e = (error)atoi(requestError.c_str() + 7);
+        }
+        else
+        {
+            e = (error)atoi(requestError.c_str());
+        }
+    }
+    else
+    {
+        e = API_EINTERNAL;
+        requestError = std::to_string(e);
+    }
+
+    if (!e)
+    {
+        e = API_EINTERNAL;
+        requestError = std::to_string(e);
+    }
+    return e;
+}
+
 // nonblocking state machine executing all operations currently in progress
 void MegaClient::exec()
 {
@@ -1980,6 +2028,9 @@ void MegaClient::exec()
         overquotauntil = 0;
     }
 
+    // the transfer buffers aren't kept once the transfers stop
+    BufferPool::instance().trimIfIdle();
+
     if (httpio->inetisback())
     {
         LOG_info << "Internet connectivity returned - resetting all backoff timers";
@@ -2028,6 +2079,19 @@ void MegaClient::exec()
         }
     }
 
+    // a pipelined connection with a batch to send (again) and no backoff pending
+    auto pipelinedcsready = [this]()
+    {
+        for (int i = 0; i < RequestDispatcher::MAX_PIPELINED_REQUESTS; i++)
+        {
+            if (btcsPipelined[i].armed() && reqs.readyToSendPipelined(i))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
     bool first = true;
     do
     {
@@ -2483,33 +2547,8 @@ void MegaClient::exec()
                             else
                             {
                                 // request failed
-                                JSON json;
-                                json.pos = pendingcs->in.c_str();
                                 std::string requestError;
-                                error e;
-                                bool valid = json.storeobject(&requestError);
-                                if (valid)
-                                {
-                                    if (strncmp(requestError.c_str(), "{\"err\":", 7) == 0)
-                                    {
-                                        e = (error)atoi(requestError.c_str() + 7);
-                                    }
-                                    else
-                                    {
-                                        e = (error)atoi(requestError.c_str());
-                                    }
-                                }
-                                else
-                                {
-                                    e = API_EINTERNAL;
-                                    requestError = std::to_string(e);
-                                }
-
-                                if (!e)
-                                {
-                                    e = API_EINTERNAL;
-                                    requestError = std::to_string(e);
-                                }
+                                error e = csrequesterror(pendingcs->in, requestError);
 
                                 if (e == API_EBLOCKED && sid.size())
                                 {
@@ -2575,22 +2614,14 @@ void MegaClient::exec()
                         }
 
                         abortlockrequest();
-                        if (pendingcs->sslcheckfailed)
+                        if (pendingcs->sslcheckfailed && csrequestsslerror(*pendingcs))
                         {
-                            sendevent(99453, "Invalid public key");
-                            sslfakeissuer = pendingcs->sslfakeissuer;
-                            app->request_error(API_ESSL);
-                            sslfakeissuer.clear();
+                            delete pendingcs;
+                            pendingcs = NULL;
+                            csretrying = false;
 
-                            if (!retryessl)
-                            {
-                                delete pendingcs;
-                                pendingcs = NULL;
-                                csretrying = false;
-
-                                reqs.servererror(std::to_string(API_ESSL), this);
-                                break;
-                            }
+                            reqs.servererror(std::to_string(API_ESSL), this);
+                            break;
                         }
 
                         // failure, repeat with capped exponential backoff
@@ -2633,24 +2664,7 @@ void MegaClient::exec()
                     string idempotenceId;
                     *pendingcs->out = reqs.serverrequest(pendingcs->includesFetchingNodes, v3, this, idempotenceId);
 
-                    pendingcs->posturl = httpio->APIURL;
-                    pendingcs->posturl.append("cs?id=");
-                    pendingcs->posturl.append(idempotenceId);
-                    pendingcs->posturl.append(getAuthURI());
-                    pendingcs->posturl.append(appkey);
-
-                    pendingcs->posturl.append(v3 ? "&v=3" : "&v=2");
-
-                    if (lang.size())
-                    {
-                        pendingcs->posturl.append("&");
-                        pendingcs->posturl.append(lang);
-                    }
-                    if (trackJourneyId())
-                    {
-                        pendingcs->posturl.append("&j=");
-                        pendingcs->posturl.append(mJourneyId.getValue());
-                    }
+                    pendingcs->posturl = csurl(idempotenceId, v3);
                     pendingcs->type = REQ_JSON;
 
                     if (pendingcs->includesFetchingNodes && !mNodeManager.hasCacheLoaded())
@@ -2672,6 +2686,8 @@ void MegaClient::exec()
             break;
         }
 
+        execpipelinedcs();
+
         // handle the request for the last 50 UserAlerts
         if (pendingscUserAlerts)
         {
@@ -3208,7 +3224,7 @@ void MegaClient::exec()
 
         httpio->updatedownloadspeed();
         httpio->updateuploadspeed();
-    } while (httpio->doio() || execdirectreads() || (!pendingcs && reqs.readyToSend() && btcs.armed()));
+    } while (httpio->doio() || execdirectreads() || (!pendingcs && reqs.readyToSend() && btcs.armed()) || pipelinedcsready());
 
 
     if (!fetchingnodes)
@@ -3319,6 +3335,14 @@ int MegaClient::preparewait()
             btcs.update(&nds);
         }
 
+        for (int i = 0; i < RequestDispatcher::MAX_PIPELINED_REQUESTS; i++)
+        {
+            if (!pendingcsPipelined[i])
+            {
+                btcsPipelined[i].update(&nds);
+            }
+        }
+
         // retry failed server-client requests
         if (!pendingsc && !pendingscUserAlerts && scsn.ready() && !mBlocked)
         {
@@ -3352,6 +3376,16 @@ int MegaClient::preparewait()
             btpfa.update(&nds);
         }
 
+        // free the idle transfer buffers once the transfers stop
+        if (BufferPool::instance().stats().idleBytes)
+        {
+            dstime trimds = Waiter::ds + dstime(BufferPool::IDLE_TRIM_DELAY.count() * 10);
+            if (trimds < nds)
+            {
+                nds = trimds;
+            }
+        }
+
         // retry failed file attribute gets
         for (fafc_map::iterator cit = fafcs.begin(); cit != fafcs.end(); cit++)
         {
@@ -3595,6 +3629,14 @@ bool MegaClient::abortbackoff(bool includexfers)
         r = true;
     }
 
+    for (BackoffTimer& bt : btcsPipelined)
+    {
+        if (bt.arm())
+        {
+            r = true;
+        }
+    }
+
     if (btbadhost.arm())
     {
         r = true;
@@ -4327,6 +4369,131 @@ void MegaClient::nexttransferretry(direction_t d, dstime* dsmin)
     }
 }
 
+string MegaClient::csurl(const string& idempotenceId, bool v3)
+{
+    string url = httpio->APIURL;
+    url.append("cs?id=");
+    url.append(idempotenceId);
+    url.append(getAuthURI());
+    url.append(appkey);
+
+    url.append(v3 ? "&v=3" : "&v=2");
+
+    if (lang.size())
+    {
+        url.append("&");
+        url.append(lang);
+    }
+    if (trackJourneyId())
+    {
+        url.append("&j=");
+        url.append(mJourneyId.getValue());
+    }
+    return url;
+}
+
+// the pipelined batches only contain independent commands: no seqtags to wait for, no fetchnodes
+// to report progress of, and failures are retried with the same idempotence id as the main batches
+void MegaClient::execpipelinedcs()
+{
+    for (int i = 0; i < RequestDispatcher::MAX_PIPELINED_REQUESTS; i++)
+    {
+        if (HttpReq* req = pendingcsPipelined[i])
+        {
+            retryreason_t reason = RETRY_NONE;
+
+            switch (static_cast<reqstatus_t>(req->status))
+            {
+                case REQ_SUCCESS:
+                    if (req->in != "-3" && req->in != "-4")
+                    {
+                        // the commands could log out, which deletes the pending requests
+                        std::unique_ptr<HttpReq> done(req);
+                        pendingcsPipelined[i] = nullptr;
+
+                        if (*done->in.c_str() == '[')
+                        {
+                            btcsPipelined[i].reset();
+                            reqs.serverresponsePipelined(i, std::move(done->in), this);
+                        }
+                        else
+                        {
+                            std::string requestError;
+                            error e = csrequesterror(done->in, requestError);
+                            if (e == API_EBLOCKED && sid.size())
+                            {
+                                block();
+                            }
+
+                            app->request_error(e);
+                            reqs.servererrorPipelined(i, requestError, this);
+                        }
+                        break;
+                    }
+
+                    reason = req->in == "-3" ? RETRY_API_LOCK : RETRY_RATE_LIMIT;
+
+                // fall through
+                case REQ_FAILURE:
+                    if (!reason)
+                    {
+                        if (req->httpstatus == 500)
+                        {
+                            reason = RETRY_SERVERS_BUSY;
+                        }
+                        else if (req->httpstatus == 0)
+                        {
+                            reason = RETRY_CONNECTIVITY;
+                        }
+                        else
+                        {
+                            reason = RETRY_UNKNOWN;
+                        }
+                    }
+
+                    if (req->sslcheckfailed && csrequestsslerror(*req))
+                    {
+                        delete req;
+                        pendingcsPipelined[i] = nullptr;
+                        reqs.servererrorPipelined(i, std::to_string(API_ESSL), this);
+                        break;
+                    }
+
+                    delete req;
+                    pendingcsPipelined[i] = nullptr;
+
+                    // resent unchanged when the backoff of this connection expires, the main one
+                    // and the other pipelined connections aren't held back
+                    btcsPipelined[i].backoff();
+                    LOG_warn << "Retrying pipelined cs request " << i << " in " << btcsPipelined[i].retryin() << " ds";
+                    reqs.inflightFailurePipelined(i, reason);
+                    break;
+
+                default:
+                    ;
+            }
+        }
+
+        if (!pendingcsPipelined[i] && btcsPipelined[i].armed() && reqs.readyToSendPipelined(i))
+        {
+            HttpReq* req = new HttpReq();
+            req->protect = true;
+            req->logname = clientname + "cs" + std::to_string(i + 1) + " ";
+
+            bool v3;
+            string idempotenceId;
+            *req->out = reqs.serverrequestPipelined(i, v3, this, idempotenceId);
+
+            req->posturl = csurl(idempotenceId, v3);
+            req->type = REQ_JSON;
+
+            pendingcsPipelined[i] = req;
+            ++performanceStats.csPipelinedRequests;
+            req->post(this);
+        }
+    }
+}
+
 // disconnect all HTTP connections (slows down operations, but is semantically neutral)
 void MegaClient::disconnect()
 {
@@ -4336,6 +4503,14 @@ void MegaClient::disconnect()
         pendingcs->disconnect();
     }
 
+    for (HttpReq* req : pendingcsPipelined)
+    {
+        if (req)
+        {
+            req->disconnect();
+        }
+    }
+
     if (pendingsc)
     {
         pendingsc->disconnect();
@@ -4595,6 +4770,11 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
 
     delete pendingcs;
     pendingcs = NULL;
+    for (HttpReq*& req : pendingcsPipelined)
+    {
+        delete req;
+        req = nullptr;
+    }
     scsn.clear();
     mBlocked = false;
     mBlockedSet = false;
@@ -5346,6 +5526,10 @@ size_t MegaClient::procreqstat()
         // resetting cs backoff here, because the account should be unlocked
         // and there should be connectivity with MEGA servers
         btcs.arm();
+        for (BackoffTimer& bt : btcsPipelined)
+        {
+            bt.arm();
+        }
         return 2;
     }
     size_t startPosUsers = sizeof(uint16_t);
@@ -6520,7 +6704,7 @@ bool MegaClient::sc_shares()
 
 bool MegaClient::sc_upgrade(nameid paymentType)
 {
-    string result;
+    std::string_view result;
     bool success = false;
     int proNumber = 0;
     int itemclass = 0;
@@ -6538,7 +6722,7 @@ bool MegaClient::sc_upgrade(nameid paymentType)
                 break;
 
             case 'r':
-                jsonsc.storeobject(&result);
+                jsonsc.storeobject(result);
                 if (result == "s")
                 {
                    success = true;
@@ -6721,7 +6905,7 @@ void MegaClient::sc_userattr()
     handle uh = UNDEF;
     User *u = NULL;
 
-    string ua, uav;
+    std::string_view ua, uav;
     string_vector ualist;    // stores attribute names
     string_vector uavlist;   // stores attribute versions
     string_vector::const_iterator itua, ituav;
@@ -6737,9 +6921,9 @@ void MegaClient::sc_userattr()
             case MAKENAMEID2('u', 'a'):
                 if (jsonsc.enterarray())
                 {
-                    while (jsonsc.storeobject(&ua))
+                    while (jsonsc.storeobject(ua))
                     {
-                        ualist.push_back(ua);
+                        ualist.emplace_back(ua);
                     }
                     jsonsc.leavearray();
                 }
@@ -6748,9 +6932,9 @@ void MegaClient::sc_userattr()
             case 'v':
                 if (jsonsc.enterarray())
                 {
-                    while (jsonsc.storeobject(&uav))
+                    while (jsonsc.storeobject(uav))
                     {
-                        uavlist.push_back(uav);
+                        uavlist.emplace_back(uav);
                     }
                     jsonsc.leavearray();
                 }
@@ -9772,10 +9956,13 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
             }
             else
             {
-                vector<byte> buf(SymmCipher::KEYLENGTH);
+                // only incoming shares need it: avoid the allocation for every other node
+                vector<byte> buf;
 
                 if (!ISUNDEF(su))
                 {
+                    buf.resize(SymmCipher::KEYLENGTH);
+
                     if (t != FOLDERNODE)
                     {
                         warn("Invalid share node type");
@@ -9806,10 +9993,6 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     }
                 }
 
-                string fas;
-
-                JSON::copystring(&fas, fa);
-
                 // fallback timestamps
                 if (!(ts + 1))
                 {
@@ -9821,7 +10004,7 @@ int MegaClient::readnode(JSON* j, int notify, putsource_t source, vector<NewNode
                     sts = ts;
                 }
 
-                n = std::make_shared<Node>(*this, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fas.c_str(), ts);
+                n = std::make_shared<Node>(*this, NodeHandle().set6byte(h), NodeHandle().set6byte(ph), t, s, u, fa, ts);
                 n->changed.newnode = true;
                 n->changed.modifiedByThisClient = modifiedByThisClient;
 
@@ -14743,6 +14926,7 @@ void MegaClient::fetchnodes(bool nocache, bool loadSyncs, bool forceLoadFromServ
             fnstats.cache = FetchNodesStats::API_NO_CACHE;
             fnstats.nodesCached = mNodeManager.getNodeCount();
             fnstats.timeToCached = Waiter::ds - fnstats.startTime;
+            fnstats.timeToReady = fnstats.timeToCached;
             fnstats.timeToResult = fnstats.timeToCached;
 
             statecurrent = false;
@@ -17390,7 +17574,7 @@ std::shared_ptr<Node> MegaClient::nodebyfingerprint(LocalNode* localNode)
                    remoteNodes.end(),
                    [&](std::shared_ptr<Node> remoteNode) -> bool
                    {
-                       return localNode->toName_of_localname == remoteNode->displayname();
+                       return localNode->toName_of_localname() == remoteNode->displayname();
                    });
 
     if (remoteNode != remoteNodes.end())
@@ -18604,9 +18788,11 @@ std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Wai
 #endif
         << " cs Request waiting time: " << csRequestWaitTime.report(reset) << "\n"
         << " cs requests sent/received: " << reqs.csRequestsSent << "/" << reqs.csRequestsCompleted << " batches: " << reqs.csBatchesSent << "/" << reqs.csBatchesReceived << "\n"
+        << " cs pipelined batches sent: " << csPipelinedRequests << "\n"
         << " transfers active time: " << transfersActiveTime.report(reset) << "\n"
         << " transfer starts/finishes: " << transferStarts << " " << transferFinishes << "\n"
         << " transfer temperror/fails: " << transferTempErrors << " " << transferFails << "\n"
+        << " transfer adaptive connections added/removed, request size changes: " << transferConnectionsAdded << " " << transferConnectionsRemoved << " " << transferRequestSizeChanges << "\n"
         << " nowait reason: immedate: " << prepwaitImmediate << " zero: " << prepwaitZero << " httpio: " << prepwaitHttpio << " fsaccess: " << prepwaitFsaccess << " nonzero waits: " << nonzeroWait << "\n";
     if (auto curlhttpio = dynamic_cast<CurlHttpIO*>(httpio))
     {
@@ -20746,6 +20932,7 @@ void FetchNodesStats::init()
     timeToFirstByte = NEVER;
     timeToLastByte = NEVER;
     timeToCached = NEVER;
+    timeToReady = NEVER;
     timeToResult = NEVER;
     timeToSyncsResumed = NEVER;
     timeToCurrent = NEVER;
@@ -20766,7 +20953,8 @@ void FetchNodesStats::toJsonArray(string *json)
         << timeToFirstByte << "," << timeToLastByte << ","
         << timeToCached << "," << timeToResult << ","
         << timeToSyncsResumed << "," << timeToCurrent << ","
-        << timeToTransfersResumed << "," << cache << "]";
+        << timeToTransfersResumed << "," << cache << ","
+        << timeToReady << "]";
     json->append(oss.str());
 }
 
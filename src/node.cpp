@@ -506,9 +506,7 @@ nameid Node::getExtensionNameId(const std::string& ext)
 // update node key data from JSON
 void Node::setkeyfromjson(const char* k)
 {
-    string tmp;
-    JSON::copystring(&tmp, k);
-    setKey(tmp);
+    setKey(JSON::stringView(k));
 }
 
 // update node key (already decrypted) and attempt to decrypt attributes
@@ -524,7 +522,7 @@ void Node::setkey(const byte* newkey)
 }
 
 // set the node key (encrypted or decrypted)
-void Node::setKey(const string& key)
+void Node::setKey(std::string_view key)
 {
     if (keyApplied()) --client->mAppliedKeyNodeCount;
     nodekeydata = key;
@@ -1309,6 +1307,66 @@ void Node::setCounter(const NodeCounter &counter)
     mCounter = counter;
 }
 
+size_t Node::getEstimatedMemoryUsage() const
+{
+    // Bookkeeping of the allocator and red-black trees (parent, children and color)
+    static constexpr size_t ALLOCATION_OVERHEAD = 2 * sizeof(void*);
+    static constexpr size_t MAP_ENTRY_OVERHEAD = ALLOCATION_OVERHEAD + 4 * sizeof(void*);
+    // Strings up to this capacity are usually stored in place (small string optimization)
+    static constexpr size_t SMALL_STRING_CAPACITY = 15;
+
+    auto heapSize = [](const string& s) -> size_t
+    {
+        return s.capacity() > SMALL_STRING_CAPACITY ? s.capacity() + 1 + ALLOCATION_OVERHEAD : 0;
+    };
+
+    auto sharesSize = [](const unique_ptr<share_map>& shares) -> size_t
+    {
+        if (!shares)
+        {
+            return 0;
+        }
+
+        return sizeof(share_map) + ALLOCATION_OVERHEAD +
+               shares->size() * (MAP_ENTRY_OVERHEAD + sizeof(share_map::value_type) + sizeof(Share) + ALLOCATION_OVERHEAD);
+    };
+
+    size_t size = sizeof(Node);
+
+    for (const auto& attr : attrs.map)
+    {
+        size += MAP_ENTRY_OVERHEAD + sizeof(attr) + heapSize(attr.second);
+    }
+
+    if (attrstring)
+    {
+        size += sizeof(string) + ALLOCATION_OVERHEAD + heapSize(*attrstring);
+    }
+
+    size += heapSize(fileattrstring);
+    size += heapSize(nodekeydata);
+
+    if (inshare)
+    {
+        size += sizeof(Share) + ALLOCATION_OVERHEAD;
+    }
+
+    size += sharesSize(outshares);
+    size += sharesSize(pendingshares);
+
+    if (sharekey)
+    {
+        size += sizeof(SymmCipher) + ALLOCATION_OVERHEAD;
+    }
+
+    if (plink)
+    {
+        size += sizeof(PublicLink) + ALLOCATION_OVERHEAD + heapSize(plink->mAuthKey);
+    }
+
+    return size;
+}
+
 // returns whether node was moved
 bool Node::setparent(std::shared_ptr<Node> p, bool updateNodeCounters)
 {
@@ -1321,6 +1379,13 @@ bool Node::setparent(std::shared_ptr<Node> p, bool updateNodeCounters)
     if (oldparent)
     {
         client->mNodeManager.removeChild(oldparent.get(), nodeHandle());
+
+        // moved (not just loaded)
+        client->mNodeManager.cloudChildrenCache().invalidate(oldparent->nodeHandle());
+        if (p)
+        {
+            client->mNodeManager.cloudChildrenCache().invalidate(p->nodeHandle());
+        }
     }
 
     parenthandle = p ? p->nodehandle : UNDEF;
@@ -1915,22 +1980,14 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         if (parentChange || localnameChange)
         {
             // remove existing child linkage for localname
-            auto it = parent->children.find(localname);
-            if (it != parent->children.end() && it->second == this)
-            {
-                parent->children.erase(it);
-            }
+            parent->children.erase(this);
         }
 
         if (slocalname && (
             parentChange || shortnameChange))
         {
             // remove existing child linkage for slocalname
-            auto it = parent->schildren.find(*slocalname);
-            if (it != parent->schildren.end() && it->second == this)
-            {
-                parent->schildren.erase(it);
-            }
+            parent->schildren.erase(this);
         }
     }
 
@@ -1947,7 +2004,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
     {
         // set new name
         localname = newlocalpath;
-        toName_of_localname = localname.toName(*sync->syncs.fsaccess);
+        updateToNameOfLocalname();
     }
 
     if (shortnameChange)
@@ -1971,12 +2028,9 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
     // add to parent map by localname
     if (parent && (parentChange || localnameChange))
     {
-        #ifndef NDEBUG
-            auto it = parent->children.find(localname);
-            assert(it == parent->children.end());   // check we are not about to orphan the old one at this location... if we do then how did we get a clash in the first place?
-        #endif
+        assert(!parent->children.find(localname));   // check we are not about to orphan the old one at this location... if we do then how did we get a clash in the first place?
 
-        parent->children[localname] = this;
+        parent->children.set(this);
     }
 
     // add to parent map by shortname
@@ -1984,7 +2038,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
     {
         // it's quite possible that the new folder still has an older LocalNode with clashing shortname, that represents a file/folder since moved, but which we don't know about yet.
         // just assign the new one, we forget the old reference.  The other LocalNode will not remove this one since the LocalNode* will not match.
-        parent->schildren[*slocalname] = this;
+        parent->schildren.set(this);
     }
 
     // reset treestate
@@ -2017,9 +2071,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
 
 void LocalNode::moveContentTo(LocalNode* ln, LocalPath& fullPath, bool setScanAgain)
 {
-    vector<LocalNode*> workingList;
-    workingList.reserve(children.size());
-    for (auto& c : children) workingList.push_back(c.second);
+    vector<LocalNode*> workingList(children.begin(), children.end());
     for (auto& c : workingList)
     {
         ScopedLengthRestore restoreLen(fullPath);
@@ -2135,7 +2187,7 @@ void LocalNode::init(nodetype_t ctype, LocalNode* cparent, const LocalPath& cful
     else
     {
         localname = cfullpath;
-        toName_of_localname = localname.toName(*sync->syncs.fsaccess);
+        updateToNameOfLocalname();
         slocalname.reset(shortname && *shortname != localname ? shortname.release() : nullptr);
 
         mExclusionState = ES_INCLUDED;
@@ -2307,10 +2359,10 @@ void LocalNode::initiateScanBlocked(bool folderBlocked, bool containsFingerprint
         LOG_verbose << sync->syncname << "Directory scan has become inaccesible for path: " << getLocalPath();
 
         // Mark all immediate children as requiring refingerprinting.
-        for (auto& childIt : children)
+        for (auto* child : children)
         {
-            if (childIt.second->type == FILENODE)
-                childIt.second->recomputeFingerprint = true;
+            if (child->type == FILENODE)
+                child->recomputeFingerprint = true;
         }
     }
 
@@ -2425,18 +2477,18 @@ bool LocalNode::syncRequired() const
 
 void LocalNode::propagateAnySubtreeFlags()
 {
-    for (auto& child : children)
+    for (auto* child : children)
     {
-        if (child.second->type != FILENODE)
+        if (child->type != FILENODE)
         {
             if (scanAgain == TREE_ACTION_SUBTREE)
             {
-                child.second->scanDelayUntil = std::max<dstime>(child.second->scanDelayUntil,  scanDelayUntil);
+                child->scanDelayUntil = std::max<dstime>(child->scanDelayUntil,  scanDelayUntil);
             }
 
-            child.second->scanAgain = propagateSubtreeFlag(scanAgain, child.second->scanAgain);
-            child.second->checkMovesAgain = propagateSubtreeFlag(checkMovesAgain, child.second->checkMovesAgain);
-            child.second->syncAgain = propagateSubtreeFlag(syncAgain, child.second->syncAgain);
+            child->scanAgain = propagateSubtreeFlag(scanAgain, child->scanAgain);
+            child->checkMovesAgain = propagateSubtreeFlag(checkMovesAgain, child->checkMovesAgain);
+            child->syncAgain = propagateSubtreeFlag(syncAgain, child->syncAgain);
         }
     }
     if (scanAgain == TREE_ACTION_SUBTREE) scanAgain = TREE_ACTION_HERE;
@@ -2463,19 +2515,21 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
     std::shared_ptr<ScanService::ScanRequest> ourScanRequest = scanInProgress ? rare().scanRequest  : nullptr;
 
     std::shared_ptr<ScanService::ScanRequest>* availableScanSlot = nullptr;
-    if (!sync->mActiveScanRequestGeneral || sync->mActiveScanRequestGeneral->completed())
+    if (!ourScanRequest)
     {
-        availableScanSlot = &sync->mActiveScanRequestGeneral;
-    }
-    else if (neverScanned &&
+        // disjoint folders can be scanned at the same time, up to one per scan thread
+        availableScanSlot = sync->availableGeneralScanSlot();
+
+        if (!availableScanSlot && neverScanned &&
             (!sync->mActiveScanRequestUnscanned || sync->mActiveScanRequestUnscanned->completed()))
-    {
-        availableScanSlot = &sync->mActiveScanRequestUnscanned;
+        {
+            availableScanSlot = &sync->mActiveScanRequestUnscanned;
+        }
     }
 
     if (!ourScanRequest && availableScanSlot)
     {
-        // we can start a single new request if we are still recursing and the last request from this sync completed already
+        // we can start a new request if we are still recursing and this sync has a free scan slot
         if (scanDelayUntil != 0 && Waiter::ds < scanDelayUntil)
         {
             LOG_verbose << sync->syncname << "Too soon to scan this folder, needs more ds: " << scanDelayUntil - Waiter::ds;
@@ -2502,9 +2556,9 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
                 }
             }
 
-            for (auto& childIt : children)
+            for (auto* childPtr : children)
             {
-                auto& child = *childIt.second;
+                auto& child = *childPtr;
 
                 bool useSyncedFP = child.oneTimeUseSyncedFingerprintInScan;
                 child.oneTimeUseSyncedFingerprintInScan = false;
@@ -2525,21 +2579,36 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
                     continue;
                 }
 
+                auto scannedFromDb = std::move(child.scannedFromDb);
+
                 if (child.scannedFingerprint.isvalid)
                 {
                     // as-scanned by this instance is more accurate if available
-                    priorScanChildren.emplace(childIt.first, child.getScannedFSDetails());
+                    priorScanChildren.emplace(child.localname, child.getScannedFSDetails());
+                }
+                else if (scannedFromDb)
+                {
+                    // as-scanned by the previous run, for files that were pending to sync
+                    FSNode n;
+                    n.localname = child.localname;
+                    n.type = FILENODE;
+                    n.fsid = scannedFromDb->fsid;
+                    n.fingerprint = scannedFromDb->fingerprint;
+                    n.ctime = child.scannedCtime;
+                    priorScanChildren.emplace(child.localname, std::move(n));
                 }
                 else if (useSyncedFP && child.fsid_lastSynced != UNDEF && child.syncedFingerprint.isvalid)
                 {
                     // But otherwise, already-synced syncs on startup should not re-fingerprint
-                    // files that match the synced fingerprint by fsid/size/mtime (for quick startup)
-                    priorScanChildren.emplace(childIt.first, child.getLastSyncedFSDetails());
+                    // files that match the synced fingerprint by fsid/size/mtime/ctime (for quick startup)
+                    FSNode n = child.getLastSyncedFSDetails();
+                    n.ctime = child.scannedCtime;
+                    priorScanChildren.emplace(child.localname, std::move(n));
                 }
             }
 
             ourScanRequest = sync->syncs.mScanService->queueScan(fullPath.localPath,
-                row.fsNode->fsid, false, move(priorScanChildren), sync->syncs.waiter);
+                row.fsNode->fsid, false, move(priorScanChildren), sync->syncs.waiter, sync->getConfig().mBackupId);
 
             rare().scanRequest = ourScanRequest;
             *availableScanSlot = ourScanRequest;
@@ -2550,8 +2619,7 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
     else if (ourScanRequest &&
              ourScanRequest->completed())
     {
-        if (ourScanRequest == sync->mActiveScanRequestGeneral) sync->mActiveScanRequestGeneral.reset();
-        if (ourScanRequest == sync->mActiveScanRequestUnscanned) sync->mActiveScanRequestUnscanned.reset();
+        sync->releaseScanSlot(ourScanRequest);
 
         scanInProgress = false;
 
@@ -2708,9 +2776,9 @@ void LocalNode::recursiveSetAndReportTreestate(treestate_t ts, bool recurse, boo
 
     if (recurse)
     {
-        for (auto& i : children)
+        for (auto* i : children)
         {
-            i.second->recursiveSetAndReportTreestate(ts, recurse, reportToApp);
+            i->recursiveSetAndReportTreestate(ts, recurse, reportToApp);
         }
     }
 }
@@ -2792,7 +2860,7 @@ void LocalNode::setSyncedFsid(handle newfsid, fsid_localnode_map& fsidnodes, con
 //        0 == compareUtf(localname, true, name, false, true));
 }
 
-void LocalNode::setScannedFsid(handle newfsid, fsid_localnode_map& fsidnodes, const LocalPath& fsName, const FileFingerprint& scanfp)
+void LocalNode::setScannedFsid(handle newfsid, fsid_localnode_map& fsidnodes, const LocalPath& fsName, const FileFingerprint& scanfp, m_time_t scanctime)
 {
     if (fsid_asScanned_it != fsidnodes.end())
     {
@@ -2803,6 +2871,8 @@ void LocalNode::setScannedFsid(handle newfsid, fsid_localnode_map& fsidnodes, co
     fsidScannedReused = false;
 
     scannedFingerprint = scanfp;
+    scannedCtime = scanctime;
+    scannedFromDb.reset();
 
     if (fsid_asScanned == UNDEF)
     {
@@ -2907,10 +2977,10 @@ LocalNode::~LocalNode()
 
 void LocalNode::deleteChildren()
 {
-    for (localnode_map::iterator it = children.begin(); it != children.end(); )
+    while (!children.empty())
     {
         // the destructor removes the child from our `children` map
-        delete it++->second;
+        delete *children.begin();
     }
     assert(children.empty());
 }
@@ -2946,11 +3016,11 @@ void LocalNode::setSubtreeNeedsRefingerprint()
     recomputeFingerprint = true;
     oneTimeUseSyncedFingerprintInScan = false;
 
-    for (auto& child : children)
+    for (auto* child : children)
     {
         if (type != FILENODE)  // no need to set it for file versions
         {
-            child.second->setSubtreeNeedsRefingerprint();
+            child->setSubtreeNeedsRefingerprint();
         }
     }
 }
@@ -3029,26 +3099,60 @@ string LocalNode::debugGetParentList()
     return s;
 }
 
+const string& LocalNode::toName_of_localname() const
+{
+    if (mToNameOfLocalname)
+    {
+        return *mToNameOfLocalname;
+    }
+
+#ifdef WIN32
+    static const string empty;
+    return empty;
+#else
+    return localname.rawValue();
+#endif
+}
+
+void LocalNode::updateToNameOfLocalname()
+{
+    string name = localname.toName(*sync->syncs.fsaccess);
+
+#ifndef WIN32
+    // usually the same bytes: no need for another copy of the name
+    if (name == localname.rawValue())
+    {
+        mToNameOfLocalname.reset();
+        return;
+    }
+#endif
+
+    mToNameOfLocalname = std::make_unique<string>(std::move(name));
+}
+
 // locate child by localname or slocalname
 LocalNode* LocalNode::childbyname(LocalPath* localname)
 {
-    localnode_map::iterator it;
-
-    if (!localname || ((it = children.find(*localname)) == children.end() && (it = schildren.find(*localname)) == schildren.end()))
+    if (!localname)
     {
         return NULL;
     }
 
-    return it->second;
+    if (LocalNode* child = children.find(*localname))
+    {
+        return child;
+    }
+
+    return schildren.find(*localname);
 }
 
 LocalNode* LocalNode::findChildWithSyncedNodeHandle(NodeHandle h)
 {
-    for (auto& c : children)
+    for (auto* c : children)
     {
-        if (c.second->syncedCloudNodeHandle == h)
+        if (c->syncedCloudNodeHandle == h)
         {
-            return c.second;
+            return c;
         }
     }
     return nullptr;
@@ -3079,6 +3183,7 @@ FSNode LocalNode::getScannedFSDetails() const
     n.fsid = fsid_asScanned;
     n.isSymlink = false;  // todo: store localndoes for symlinks but don't use them?
     n.fingerprint = scannedFingerprint;
+    n.ctime = scannedCtime;
     assert(scannedFingerprint.isvalid || type != FILENODE);
     return n;
 }
@@ -3231,7 +3336,7 @@ bool LocalNode::transferResetUnlessMatched(direction_t dir, const FileFingerprin
 // - corresponding Node handle
 // - local name
 // - fingerprint crc/mtime (filenodes only)
-bool LocalNodeCore::write(string& destination, uint32_t parentID) const
+bool LocalNodeCore::write(string& destination, uint32_t parentID, handle scannedFsid, const FileFingerprint& scannedFingerprint) const
 {
     // We need size even if we're not synced.
     auto size = syncedFingerprint.isvalid ? syncedFingerprint.size : 0;
@@ -3262,14 +3367,36 @@ bool LocalNodeCore::write(string& destination, uint32_t parentID) const
     // No longer meaningful but serialized to maintain compatibility.
     w.serializebyte(1u);
 
+    // third flag indicates we are storing the as-scanned details of a file,
+    // so it's not fingerprinted again on startup if it didn't change
+    bool scanned = type == FILENODE && scannedFsid != UNDEF && scannedFingerprint.isvalid;
+
     // first flag indicates we are storing slocalname.
     // Storing it is much, much faster than looking it up on startup.
-    w.serializeexpansionflags(1, 1);
+    w.serializeexpansionflags(1, 1, scanned);
     auto tmpstr = slocalname ? slocalname->platformEncoded() : string();
     w.serializepstr(slocalname ? &tmpstr : nullptr);
 
     w.serializebool(namesSynchronized);
 
+    if (scanned)
+    {
+        // usually the file is as synced, and then the ctime is all we need
+        bool asSynced = scannedFsid == fsid_lastSynced
+                        && syncedFingerprint.isvalid
+                        && scannedFingerprint == syncedFingerprint;
+
+        w.serializebool(asSynced);
+        w.serializecompressedi64(scannedCtime);
+        if (!asSynced)
+        {
+            w.serializehandle(scannedFsid);
+            w.serializei64(scannedFingerprint.size);
+            w.serializecompressedi64(scannedFingerprint.mtime);
+            w.serializebinary((byte*)scannedFingerprint.crc.data(), sizeof(scannedFingerprint.crc));
+        }
+    }
+
     return true;
 }
 
@@ -3312,7 +3439,12 @@ bool LocalNode::serialize(string* d) const
 #endif
 
     auto parentID = parent ? parent->dbid : 0;
-    auto result = LocalNodeCore::write(*d, parentID);
+
+    // details loaded from the db are kept until the file is scanned again
+    bool scanned = fsid_asScanned != UNDEF && scannedFingerprint.isvalid;
+    auto result = scanned || !scannedFromDb
+                ? LocalNodeCore::write(*d, parentID, fsid_asScanned, scannedFingerprint)
+                : LocalNodeCore::write(*d, parentID, scannedFromDb->fsid, scannedFromDb->fingerprint);
 
 #ifdef DEBUG
     // Quick (de)serizliation check.
@@ -3380,7 +3512,7 @@ bool LocalNodeCore::read(const string& source, uint32_t& parentID)
         (type == FILENODE && !r.unserializebinary((byte*)crc, sizeof(crc))) ||
         (type == FILENODE && !r.unserializecompressedi64(mtime)) ||
         (r.hasdataleft() && !r.unserializebyte(syncable)) ||
-        (r.hasdataleft() && !r.unserializeexpansionflags(expansionflags, 2)) ||
+        (r.hasdataleft() && !r.unserializeexpansionflags(expansionflags, 3)) ||
         (expansionflags[0] && !r.unserializecstr(shortname, false)) ||
         (expansionflags[1] && !r.unserializebool(ns)))
     {
@@ -3388,6 +3520,27 @@ bool LocalNodeCore::read(const string& source, uint32_t& parentID)
         assert(false);
         return false;
     }
+
+    bool scannedAsSynced = false;
+    m_time_t scannedCtime = 0;
+    handle scannedFsid = UNDEF;
+    m_off_t scannedSize = 0;
+    m_time_t scannedMtime = 0;
+    int32_t scannedCrc[4];
+    memset(scannedCrc, 0, sizeof scannedCrc);
+
+    if (expansionflags[2] &&
+        (!r.unserializebool(scannedAsSynced) ||
+         !r.unserializecompressedi64(scannedCtime) ||
+         (!scannedAsSynced && !r.unserializehandle(scannedFsid)) ||
+         (!scannedAsSynced && !r.unserializei64(scannedSize)) ||
+         (!scannedAsSynced && !r.unserializecompressedi64(scannedMtime)) ||
+         (!scannedAsSynced && !r.unserializebinary((byte*)scannedCrc, sizeof(scannedCrc)))))
+    {
+        LOG_err << "LocalNode unserialization failed at field " << r.fieldnum;
+        assert(false);
+        return false;
+    }
     assert(!r.hasdataleft());
 
     this->type = type;
@@ -3403,6 +3556,17 @@ bool LocalNodeCore::read(const string& source, uint32_t& parentID)
     this->syncedFingerprint.mtime = mtime;
     this->syncedFingerprint.isvalid = mtime != 0;
 
+    this->scannedCtime = scannedCtime;
+    if (expansionflags[2] && !scannedAsSynced)
+    {
+        this->scannedFromDb.reset(new ScannedDetails);
+        this->scannedFromDb->fsid = scannedFsid;
+        this->scannedFromDb->fingerprint.size = scannedSize;
+        this->scannedFromDb->fingerprint.mtime = scannedMtime;
+        memcpy(this->scannedFromDb->fingerprint.crc.data(), scannedCrc, sizeof scannedCrc);
+        this->scannedFromDb->fingerprint.isvalid = true;
+    }
+
     // previously we scanned and created the LocalNode, but we had not set syncedFingerprint
     this->syncedCloudNodeHandle.set6byte(h);
 
@@ -3484,6 +3648,25 @@ WatchResult LocalNode::watch(const LocalPath& path, handle fsid)
     // Get our hands on the notifier.
     auto& notifier = static_cast<LinuxDirNotify&>(*sync->dirnotify);
 
+#ifdef USE_FANOTIFY
+    // Changes are reported for the whole filesystem, no watch needed.
+    // Unless the directory is on a filesystem that couldn't be marked.
+    if (notifier.usesFanotify())
+    {
+        if (fsid != UNDEF && mFanotifyFsid == fsid)
+            return WR_SUCCESS;
+
+        if (notifier.fanotifyCovers(path))
+        {
+            mFanotifyFsid = fsid;
+            mWatchHandle = nullptr;
+            return WR_SUCCESS;
+        }
+
+        mFanotifyFsid = UNDEF;
+    }
+#endif // USE_FANOTIFY
+
     // Add the watch.
     auto result = notifier.addWatch(*this, path, fsid);
 
@@ -3580,7 +3763,7 @@ ExclusionState LocalNode::calcExcluded(RemotePathPair namePath, nodetype_t type,
         }
 
         // Update path so that it's applicable to the next node's path filters.
-        namePath.second.prependWithSeparator(node->toName_of_localname);
+        namePath.second.prependWithSeparator(node->toName_of_localname());
     }
 
     // If no rule matches, file's included.
@@ -3647,9 +3830,9 @@ void LocalNode::setRecomputeExclusionState(bool includingThisOne, bool scan)
     {
         auto& node = *pending.front();
 
-        for (auto& childIt : node.children)
+        for (auto* childPtr : node.children)
         {
-            auto& child = *childIt.second;
+            auto& child = *childPtr;
 
             if (child.mExclusionState == ES_UNKNOWN)
                 continue;
@@ -3782,7 +3965,7 @@ ExclusionState LocalNode::exclusionState(const string& name, nodetype_t type, m_
 
 ExclusionState LocalNode::exclusionState() const
 {
-    if (isDoNotSyncFileName(toName_of_localname)) return ES_EXCLUDED;
+    if (isDoNotSyncFileName(toName_of_localname())) return ES_EXCLUDED;
     return mExclusionState;
 }
 
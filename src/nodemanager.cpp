@@ -29,6 +29,22 @@
 namespace mega {
 
 
+NodeSearchCursor::NodeSearchCursor(const Node& node)
+    : nodeHandle(node.nodehandle)
+    , type(node.type)
+    , name(node.displayname())
+    , size(node.size)
+    , ctime(node.ctime)
+    , mtime(node.mtime)
+{
+    // same values as written into DB (see SqliteAccountState::put())
+    auto favIt = node.attrs.map.find(AttrMap::string2nameid("fav"));
+    fav = favIt != node.attrs.map.end() && favIt->second == "1";
+
+    auto labelIt = node.attrs.map.find(AttrMap::string2nameid("lbl"));
+    label = labelIt == node.attrs.map.end() ? LBL_UNKNOWN : std::atoi(labelIt->second.c_str());
+}
+
 NodeManager::NodeManager(MegaClient& client)
     : mClient(client)
     , mNodesInRam{0}
@@ -112,6 +128,10 @@ void NodeManager::notifyNode_internal(std::shared_ptr<Node> n, sharedNode_vector
     assert(mMutex.owns_lock());
     n->applykey();
 
+    // any change (name, fingerprint, removal...) is seen in the children of its parent
+    mCloudChildrenCache.invalidate(n->parentHandle());
+    mCloudChildrenCache.invalidate(n->nodeHandle());
+
     if (!mClient.fetchingnodes)
     {
         if (n->changed.modifiedByThisClient && !n->changed.removed && n->attrstring)
@@ -190,6 +210,8 @@ bool NodeManager::addNode_internal(std::shared_ptr<Node> node, bool notify, bool
 
     bool rootNode = node->type == ROOTNODE || node->type == RUBBISHNODE || node->type == VAULTNODE;
 
+    mCloudChildrenCache.invalidate(node->parentHandle());
+
     // getRootNodeFiles() is always set for folder links before adding any node (upon login)
     bool isFolderLink = rootnodes.files == node->nodeHandle();
 
@@ -260,8 +282,13 @@ std::shared_ptr<Node> NodeManager::getNodeByHandle_internal(NodeHandle handle)
     }
 
     std::shared_ptr<Node> node = getNodeInRAM(handle);
-    if (!node)
+    if (node)
     {
+        ++mNodeByHandleHits;
+    }
+    else
+    {
+        ++mNodeByHandleMisses;
         node = getNodeFromDataBase(handle);
     }
 
@@ -382,11 +409,17 @@ sharedNode_list NodeManager::getChildren_internal(const Node *parent, CancelToke
 
 sharedNode_vector NodeManager::getChildren(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
 {
+    PrefetchedNodes prefetched;
+    ReadOnlyQuery query = prefetchNodes(prefetched, [&](DBTableNodes& table, vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable)
+    {
+        return table.getChildren(filter, order, nodesFromTable, cancelFlag, page);
+    }, cancelFlag);
+
     LockGuard g(mMutex);
-    return getChildren_internal(filter, order, cancelFlag, page);
+    return getChildren_internal(filter, order, cancelFlag, page, isCurrent(query) ? &prefetched : nullptr);
 }
 
-sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, PrefetchedNodes* prefetched)
 {
     assert(mMutex.owns_lock());
 
@@ -408,6 +441,11 @@ sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filt
     }
 
     // db look-up
+    if (prefetched)
+    {
+        return processUnserializedNodes(prefetched->nodesFromTable, cancelFlag, &prefetched->nodesData);
+    }
+
     vector<pair<NodeHandle, NodeSerialized>> nodesFromTable;
     if (!mTable->getChildren(filter, order, nodesFromTable, cancelFlag, page))
     {
@@ -529,12 +567,24 @@ uint64_t NodeManager::getNodeCount_internal()
 
 std::set<std::string> NodeManager::getAllNodeTags(const char* searchString, CancelToken cancelFlag)
 {
+    std::set<std::string> tags;
+    const std::string auxSearchString = searchString ? searchString : "";
+    ReadOnlyQuery query;
+    if (auxSearchString.find(MegaClient::TAG_DELIMITER) == std::string::npos)
+    {
+        query = queryReadOnlyTable([&](DBTableNodes& table)
+        {
+            return table.getAllNodeTags(auxSearchString, tags, cancelFlag);
+        });
+    }
+
     LockGuard g(mMutex);
-    return getAllNodeTags_internal(searchString, cancelFlag);
+    return getAllNodeTags_internal(searchString, cancelFlag, isCurrent(query) ? &tags : nullptr);
 }
 
 std::set<std::string> NodeManager::getAllNodeTags_internal(const char* searchString,
-                                                           CancelToken cancelFlag)
+                                                           CancelToken cancelFlag,
+                                                           std::set<std::string>* tagsFromReadOnlyTable)
 {
     assert(mMutex.owns_lock());
     // validation
@@ -553,6 +603,11 @@ std::set<std::string> NodeManager::getAllNodeTags_internal(const char* searchStr
                  << ") contains an invalid character (,)";
         return {};
     }
+    if (tagsFromReadOnlyTable)
+    {
+        return std::move(*tagsFromReadOnlyTable);
+    }
+
     std::set<std::string> result;
     if (!mTable->getAllNodeTags(auxSearchString, result, cancelFlag))
         return {};
@@ -560,13 +615,61 @@ std::set<std::string> NodeManager::getAllNodeTags_internal(const char* searchStr
     return result;
 }
 
+NodeManager::ReadOnlyQuery NodeManager::queryReadOnlyTable(const std::function<bool(DBTableNodes&)>& query)
+{
+    ReadOnlyQuery result;
+    std::shared_ptr<DBTableNodes> readOnlyTable;
+
+    {
+        LockGuard g(mMutex);
+        if (!mTable)
+        {
+            return result;
+        }
+
+        readOnlyTable = mTable->getReadOnlyTable(result.version);
+        result.table = mTable;
+    }
+
+    result.succeeded = readOnlyTable && query(*readOnlyTable);
+    return result;
+}
+
+bool NodeManager::isCurrent(const ReadOnlyQuery& query) const
+{
+    assert(mMutex.owns_lock());
+    return query.succeeded && mTable && mTable == query.table && mTable->getNodesVersion() == query.version;
+}
+
+NodeManager::ReadOnlyQuery NodeManager::prefetchNodes(PrefetchedNodes& prefetched, const std::function<bool(DBTableNodes&, vector<pair<NodeHandle, NodeSerialized>>&)>& query, CancelToken cancelFlag)
+{
+    ReadOnlyQuery result = queryReadOnlyTable([&](DBTableNodes& table)
+    {
+        return query(table, prefetched.nodesFromTable);
+    });
+
+    // nodes already in RAM can't be skipped without mMutex: some may be decoded in vain
+    if (result.succeeded)
+    {
+        prefetched.nodesData = decodeNodes(prefetched.nodesFromTable, false, cancelFlag);
+    }
+
+    return result;
+}
+
 sharedNode_vector NodeManager::searchNodes(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
 {
+    PrefetchedNodes prefetched;
+    ReadOnlyQuery query = prefetchNodes(prefetched, [&](DBTableNodes& table, vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable)
+    {
+        return table.searchNodes(filter, order, nodesFromTable, cancelFlag, page);
+    }, cancelFlag);
+
     LockGuard g(mMutex);
-    return searchNodes_internal(filter, order, cancelFlag, page);
+    return searchNodes_internal(filter, order, cancelFlag, page, isCurrent(query) ? &prefetched : nullptr);
 }
 
-sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, PrefetchedNodes* prefetched)
 {
     assert(mMutex.owns_lock());
 
@@ -593,6 +696,11 @@ sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filt
     }
 
     // db look-up
+    if (prefetched)
+    {
+        return processUnserializedNodes(prefetched->nodesFromTable, cancelFlag, &prefetched->nodesData);
+    }
+
     vector<pair<NodeHandle, NodeSerialized>> nodesFromTable;
     if (!mTable->searchNodes(filter, order, nodesFromTable, cancelFlag, page))
     {
@@ -804,11 +912,17 @@ sharedNode_vector NodeManager::getNodesByFingerprint_internal(FileFingerprint &f
 
 sharedNode_vector NodeManager::getNodesByOrigFingerprint(const std::string &fingerprint, Node *parent)
 {
+    PrefetchedNodes prefetched;
+    ReadOnlyQuery query = prefetchNodes(prefetched, [&](DBTableNodes& table, vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable)
+    {
+        return table.getNodesByOrigFingerprint(fingerprint, nodesFromTable);
+    }, CancelToken());
+
     LockGuard g(mMutex);
-    return getNodesByOrigFingerprint_internal(fingerprint, parent);
+    return getNodesByOrigFingerprint_internal(fingerprint, parent, isCurrent(query) ? &prefetched : nullptr);
 }
 
-sharedNode_vector NodeManager::getNodesByOrigFingerprint_internal(const std::string &fingerprint, Node *parent)
+sharedNode_vector NodeManager::getNodesByOrigFingerprint_internal(const std::string &fingerprint, Node *parent, PrefetchedNodes* prefetched)
 {
     assert(mMutex.owns_lock());
 
@@ -819,6 +933,11 @@ sharedNode_vector NodeManager::getNodesByOrigFingerprint_internal(const std::str
         return nodes;
     }
 
+    if (prefetched)
+    {
+        return processUnserializedNodes(prefetched->nodesFromTable, parent ? parent->nodeHandle() : NodeHandle(), CancelToken(), &prefetched->nodesData);
+    }
+
     std::vector<std::pair<NodeHandle, NodeSerialized>> nodesFromTable;
     mTable->getNodesByOrigFingerprint(fingerprint, nodesFromTable);
 
@@ -1098,11 +1217,12 @@ sharedNode_vector NodeManager::getNodesWithSharesOrLink_internal(ShareType_t sha
     return processUnserializedNodes(nodesFromTable);
 }
 
-shared_ptr<Node> NodeManager::getNodeFromNodeSerialized(const NodeSerialized &nodeSerialized)
+shared_ptr<Node> NodeManager::getNodeFromNodeSerialized(const NodeSerialized &nodeSerialized, NodeData* nodeData)
 {
     assert(mMutex.owns_lock());
 
-    shared_ptr<Node> node = unserializeNode(&nodeSerialized.mNode, false);
+    shared_ptr<Node> node = nodeData ? unserializeNode(*nodeData, false)
+                                     : unserializeNode(&nodeSerialized.mNode, false);
     if (!node)
     {
         assert(false);
@@ -1357,9 +1477,11 @@ void NodeManager::cleanNodes_internal()
     mFingerPrints.clear();
     mNodes.clear();
     mCacheLRU.clear();
+    mCacheLRUBytes = 0;
     mNodesInRam = 0;
     mNodeToWriteInDb.reset();
     mNodeNotify.clear();
+    mCloudChildrenCache.clear();
 
     rootnodes.clear();
 
@@ -1383,12 +1505,18 @@ std::shared_ptr<Node> NodeManager::getNodeFromBlob_internal(const std::string* n
 // parse serialized node and return Node object - updates nodes hash and parent
 // mismatch vector
 shared_ptr<Node> NodeManager::unserializeNode(const std::string *d, bool fromOldCache)
+{
+    NodeData nodeData(d->data(), d->size(), NodeData::COMPONENT_ALL);
+    return unserializeNode(nodeData, fromOldCache);
+}
+
+shared_ptr<Node> NodeManager::unserializeNode(NodeData& nodeData, bool fromOldCache)
 {
     assert(mMutex.owns_lock());
 
     std::list<std::unique_ptr<NewShare>> ownNewshares;
 
-    if (shared_ptr<Node> n = Node::unserialize(mClient, d, fromOldCache, ownNewshares))
+    if (shared_ptr<Node> n = nodeData.createNode(mClient, fromOldCache, ownNewshares))
     {
 
         auto pair = mNodes.emplace(n->nodeHandle(), NodeManagerNode(*this, n->nodeHandle()));
@@ -1432,7 +1560,10 @@ void NodeManager::applyKeys_internal(uint32_t appliedKeys)
         {
             if (shared_ptr<Node> node = it.second.getNodeInRam(false))
             {
-               node->applykey();
+               if (node->applykey())
+               {
+                   mCloudChildrenCache.invalidate(node->parentHandle());
+               }
             }
         }
     }
@@ -1529,6 +1660,7 @@ void NodeManager::notifyPurge()
                 // effectively delete node from RAM
                 if (n->mNodePosition->second.mLRUPosition != invalidCacheLRUPos())
                 {
+                    mCacheLRUBytes -= n->mNodePosition->second.mLRUBytes;
                     mCacheLRU.erase(n->mNodePosition->second.mLRUPosition);
                 }
 
@@ -1749,6 +1881,28 @@ void NodeManager::initCompleted()
     initCompleted_internal();
 }
 
+void NodeManager::startBulkLoad()
+{
+    LockGuard g(mMutex);
+
+    if (!mTable)
+    {
+        return;
+    }
+
+    mTable->startBulkLoad(mBulkLoadRelaxedSync);
+}
+
+bool NodeManager::getBulkLoadRelaxedSync() const
+{
+    return mBulkLoadRelaxedSync;
+}
+
+void NodeManager::setBulkLoadRelaxedSync(bool enable)
+{
+    mBulkLoadRelaxedSync = enable;
+}
+
 std::shared_ptr<Node> NodeManager::getNodeFromNodeManagerNode(NodeManagerNode& nodeManagerNode)
 {
     LockGuard g(mMutex);
@@ -1796,6 +1950,48 @@ uint64_t NodeManager::getNumNodesAtCacheLRU() const
     return mCacheLRU.size();
 }
 
+unsigned NodeManager::getUnserializationThreads() const
+{
+    return mUnserializationThreads;
+}
+
+void NodeManager::setUnserializationThreads(unsigned numThreads)
+{
+    mUnserializationThreads = numThreads;
+
+    // the thread of the caller of decode() takes part too
+    mDecodePool.setNumThreads(numThreads > 1 ? numThreads - 1 : 0);
+}
+
+uint64_t NodeManager::getCacheLRUMaxBytes() const
+{
+    return mCacheLRUMaxBytes;
+}
+
+void NodeManager::setCacheLRUMaxBytes(uint64_t cacheLRUMaxBytes)
+{
+    LockGuard g(mMutex);
+    mCacheLRUMaxBytes = cacheLRUMaxBytes;
+
+    unLoadNodeFromCacheLRU(); // check if it's necessary unload nodes
+}
+
+uint64_t NodeManager::getCacheLRUBytes() const
+{
+    LockGuard g(mMutex);
+    return mCacheLRUBytes;
+}
+
+uint64_t NodeManager::getNodeByHandleHits() const
+{
+    return mNodeByHandleHits;
+}
+
+uint64_t NodeManager::getNodeByHandleMisses() const
+{
+    return mNodeByHandleMisses;
+}
+
 void NodeManager::initCompleted_internal()
 {
     assert(mMutex.owns_lock());
@@ -1806,13 +2002,15 @@ void NodeManager::initCompleted_internal()
         return;
     }
 
+    // Indexes may have been dropped for a bulk load, rebuild them before querying the DB
+    mTable->createIndexes();
+
     sharedNode_vector rootNodes = getRootNodesAndInshares();
     for (auto& node : rootNodes)
     {
         calculateNodeCounter(node->nodeHandle(), TYPE_UNKNOWN, node, node->type == RUBBISHNODE);
     }
 
-    mTable->createIndexes();
     mInitialized = true;
 }
 
@@ -1824,12 +2022,17 @@ bool NodeManager::ready()
 void NodeManager::insertNodeCacheLRU_internal(std::shared_ptr<Node> node)
 {
     assert(mMutex.owns_lock() && "Mutex should be locked by this thread");
-    if (node->mNodePosition->second.mLRUPosition != mCacheLRU.end())
+    NodeManagerNode& nodeManagerNode = node->mNodePosition->second;
+    if (nodeManagerNode.mLRUPosition != mCacheLRU.end())
     {
-        mCacheLRU.erase(node->mNodePosition->second.mLRUPosition);
+        mCacheLRUBytes -= nodeManagerNode.mLRUBytes;
+        mCacheLRU.erase(nodeManagerNode.mLRUPosition);
     }
 
-    node->mNodePosition->second.mLRUPosition = mCacheLRU.insert(mCacheLRU.begin(), node);
+    // estimated again, since node could have changed meanwhile
+    nodeManagerNode.mLRUBytes = node->getEstimatedMemoryUsage();
+    mCacheLRUBytes += nodeManagerNode.mLRUBytes;
+    nodeManagerNode.mLRUPosition = mCacheLRU.insert(mCacheLRU.begin(), node);
     unLoadNodeFromCacheLRU(); // check if it's necessary unload nodes
 
     // setfingerprint again to force to insert into NodeManager::mFingerPrints
@@ -1843,10 +2046,11 @@ void NodeManager::insertNodeCacheLRU_internal(std::shared_ptr<Node> node)
 void NodeManager::unLoadNodeFromCacheLRU()
 {
     assert(mMutex.owns_lock() && "Mutex should be locked by this thread");
-    while (mCacheLRU.size() > mCacheLRUMaxSize)
+    while (mCacheLRU.size() > mCacheLRUMaxSize || (mCacheLRUBytes > mCacheLRUMaxBytes && mCacheLRU.size() > 1))
     {
         std::shared_ptr<Node> node = mCacheLRU.back();
         removeFingerprint(node.get(), true);
+        mCacheLRUBytes -= node->mNodePosition->second.mLRUBytes;
         node->mNodePosition->second.mLRUPosition = invalidCacheLRUPos();
         mCacheLRU.pop_back();
     }
@@ -2119,21 +2323,64 @@ sharedNode_vector NodeManager::getRootNodesAndInshares()
     return rootnodes;
 }
 
-sharedNode_vector NodeManager::processUnserializedNodes(const vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag)
+std::vector<std::unique_ptr<NodeData>> NodeManager::decodeNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, bool onlyNotInRAM, CancelToken cancelFlag)
+{
+    assert(!onlyNotInRAM || mMutex.owns_lock());
+
+    // below these amounts, the cost of handing them to other threads is not compensated
+    static constexpr size_t MIN_NODES_TO_DECODE_IN_PARALLEL = 1000;
+
+    std::vector<std::unique_ptr<NodeData>> nodesData(nodesFromTable.size());
+    if (mUnserializationThreads < 2 || nodesFromTable.size() < MIN_NODES_TO_DECODE_IN_PARALLEL)
+    {
+        return nodesData;
+    }
+
+    std::vector<NodeData*> pending;
+    for (size_t i = 0; i < nodesFromTable.size(); ++i)
+    {
+        if (onlyNotInRAM)
+        {
+            auto it = mNodes.find(nodesFromTable[i].first);
+            if (it != mNodes.end() && it->second.getNodeInRam(false))
+            {
+                continue;
+            }
+        }
+
+        const std::string& blob = nodesFromTable[i].second.mNode;
+        nodesData[i] = std::make_unique<NodeData>(blob.data(), blob.size(), NodeData::COMPONENT_ALL);
+        pending.push_back(nodesData[i].get());
+    }
+
+    if (pending.size() < MIN_NODES_TO_DECODE_IN_PARALLEL)
+    {
+        return nodesData;
+    }
+
+    mDecodePool.decode(pending, cancelFlag);
+    return nodesData;
+}
+
+sharedNode_vector NodeManager::processUnserializedNodes(const vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag, std::vector<std::unique_ptr<NodeData>>* decodedNodesData)
 {
     assert(mMutex.owns_lock());
 
     sharedNode_vector nodes;
+    std::vector<std::unique_ptr<NodeData>> nodesData = decodedNodesData ? std::move(*decodedNodesData) : decodeNodes(nodesFromTable, true, cancelFlag);
 
-    for (const auto& nodeIt : nodesFromTable)
+    for (size_t i = 0; i < nodesFromTable.size(); ++i)
     {
+        const auto& nodeIt = nodesFromTable[i];
+
         // Check pointer and value
         if (cancelFlag.isCancelled()) break;
 
+        // node could have been loaded meanwhile (i.e. as parent of a previous one)
         shared_ptr<Node> n = getNodeInRAM(nodeIt.first);
         if (!n)
         {
-            n = getNodeFromNodeSerialized(nodeIt.second);
+            n = getNodeFromNodeSerialized(nodeIt.second, nodesData[i].get());
             if (!n)
             {
                 nodes.clear();
@@ -2147,14 +2394,18 @@ sharedNode_vector NodeManager::processUnserializedNodes(const vector<pair<NodeHa
     return nodes;
 }
 
-sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized> >& nodesFromTable, NodeHandle ancestorHandle, CancelToken cancelFlag)
+sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized> >& nodesFromTable, NodeHandle ancestorHandle, CancelToken cancelFlag, std::vector<std::unique_ptr<NodeData>>* decodedNodesData)
 {
     assert(mMutex.owns_lock());
 
     sharedNode_vector nodes;
+    // with an ancestor, some nodes may be decoded in vain, but filtering takes a lookup per node
+    std::vector<std::unique_ptr<NodeData>> nodesData = decodedNodesData ? std::move(*decodedNodesData) : decodeNodes(nodesFromTable, true, cancelFlag);
 
-    for (const auto& nodeIt : nodesFromTable)
+    for (size_t i = 0; i < nodesFromTable.size(); ++i)
     {
+        const auto& nodeIt = nodesFromTable[i];
+
         // Check pointer and value
         if (cancelFlag.isCancelled()) break;
 
@@ -2170,7 +2421,7 @@ sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::p
 
         if (!n)
         {
-            n = std::shared_ptr<Node> (getNodeFromNodeSerialized(nodeIt.second));
+            n = std::shared_ptr<Node> (getNodeFromNodeSerialized(nodeIt.second, nodesData[i].get()));
             if (!n)
             {
                 nodes.clear();
@@ -2243,4 +2494,244 @@ void NodeManager::Rootnodes::clear()
     vault.setUndef();
 }
 
+NodeDecodePool::~NodeDecodePool()
+{
+    stop();
+}
+
+void NodeDecodePool::setNumThreads(unsigned numThreads)
+{
+    stop();
+
+    std::lock_guard<std::mutex> g(mMutex);
+    mStopping = false;
+
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        try
+        {
+            mThreads.emplace_back([this]() { threadLoop(); });
+        }
+        catch (const std::system_error& e)
+        {
+            LOG_warn << "Unable to start thread to decode nodes: " << e.what();
+            break;
+        }
+    }
+}
+
+void NodeDecodePool::stop()
+{
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+
+    for (auto& t : mThreads)
+    {
+        t.join();
+    }
+    mThreads.clear();
+}
+
+void NodeDecodePool::decode(const std::vector<NodeData*>& nodes, CancelToken cancelFlag)
+{
+    Job job(nodes, cancelFlag);
+
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        if (!mThreads.empty())
+        {
+            mJobs.push_back(&job);
+        }
+    }
+    mCondition.notify_all();
+
+    run(job);
+
+    // nothing left to take from it: wait for the threads still decoding its last nodes
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto it = std::find(mJobs.begin(), mJobs.end(), &job);
+    if (it != mJobs.end())
+    {
+        mJobs.erase(it);
+    }
+    mCondition.wait(lock, [&job]() { return !job.workers; });
+}
+
+void NodeDecodePool::run(Job& job)
+{
+    static constexpr size_t NODES_PER_BATCH = 256;
+
+    for (size_t first = job.next.fetch_add(NODES_PER_BATCH);
+         first < job.nodes.size() && !job.cancelFlag.isCancelled();
+         first = job.next.fetch_add(NODES_PER_BATCH))
+    {
+        size_t last = std::min(first + NODES_PER_BATCH, job.nodes.size());
+        for (size_t i = first; i < last; ++i)
+        {
+            job.nodes[i]->decode();
+        }
+    }
+}
+
+void NodeDecodePool::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for (;;)
+    {
+        mCondition.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+        if (mStopping)
+        {
+            return;
+        }
+
+        Job* job = mJobs.front();
+        ++job->workers;
+
+        lock.unlock();
+        run(*job);
+        lock.lock();
+
+        auto it = std::find(mJobs.begin(), mJobs.end(), job);
+        if (it != mJobs.end())
+        {
+            mJobs.erase(it);
+        }
+
+        --job->workers;
+        mCondition.notify_all();
+    }
+}
+
+#if defined(__ANDROID__) || defined(USE_IOS)
+const size_t CloudChildrenCache::DEFAULT_MAX_NODES = 50000;
+#else
+const size_t CloudChildrenCache::DEFAULT_MAX_NODES = 200000;
+#endif
+
+CloudChildrenCache::CloudChildrenCache(size_t maxNodes)
+    : mMaxNodes(maxNodes)
+{
+}
+
+bool CloudChildrenCache::get(NodeHandle parent, vector<CloudNode>& children)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    auto it = mEntries.find(parent);
+    if (it == mEntries.end())
+    {
+        ++mMisses;
+        return false;
+    }
+
+    mLRU.splice(mLRU.begin(), mLRU, it->second.lruPosition);
+    children = it->second.children;
+    ++mHits;
+    return true;
+}
+
+uint64_t CloudChildrenCache::generation() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mGeneration;
+}
+
+void CloudChildrenCache::put(NodeHandle parent, const vector<CloudNode>& children, uint64_t generation)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    if (generation != mGeneration || parent.isUndef() || children.size() > mMaxNodes)
+    {
+        return;
+    }
+
+    // nodes not decrypted yet: their names would be outdated as soon as the keys arrive
+    for (auto& child : children)
+    {
+        if (child.name.empty())
+        {
+            return;
+        }
+    }
+
+    auto it = mEntries.find(parent);
+    if (it != mEntries.end())
+    {
+        mNumNodes -= it->second.children.size();
+        mLRU.splice(mLRU.begin(), mLRU, it->second.lruPosition);
+    }
+    else
+    {
+        mLRU.push_front(parent);
+        it = mEntries.emplace(parent, Entry{ {}, mLRU.begin() }).first;
+    }
+
+    it->second.children = children;
+    mNumNodes += children.size();
+
+    trimTo(mMaxNodes);
+}
+
+void CloudChildrenCache::invalidate(NodeHandle parent)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    // even if not cached: it could be in the middle of a put()
+    ++mGeneration;
+
+    auto it = mEntries.find(parent);
+    if (it != mEntries.end())
+    {
+        mNumNodes -= it->second.children.size();
+        mLRU.erase(it->second.lruPosition);
+        mEntries.erase(it);
+    }
+}
+
+void CloudChildrenCache::clear()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+
+    ++mGeneration;
+    mEntries.clear();
+    mLRU.clear();
+    mNumNodes = 0;
+}
+
+void CloudChildrenCache::setMaxNodes(size_t maxNodes)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mMaxNodes = maxNodes;
+    trimTo(maxNodes);
+}
+
+size_t CloudChildrenCache::maxNodes() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mMaxNodes;
+}
+
+size_t CloudChildrenCache::numNodes() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mNumNodes;
+}
+
+void CloudChildrenCache::trimTo(size_t maxNodes)
+{
+    // least recently used first
+    while (mNumNodes > maxNodes)
+    {
+        auto it = mEntries.find(mLRU.back());
+        assert(it != mEntries.end());
+        mNumNodes -= it->second.children.size();
+        mEntries.erase(it);
+        mLRU.pop_back();
+    }
+}
+
 } // namespace
@@ -27,6 +27,7 @@
 #endif // ! __APPLE__
 
 #include "mega.h"
+#include "mega/posix/megaiouring.h"
 #include <sys/utsname.h>
 #include <sys/ioctl.h>
 #include <sys/statvfs.h>
@@ -334,6 +335,13 @@ void PosixFileAccess::sysclose()
 
 bool PosixFileAccess::asyncavailable()
 {
+#ifdef USE_IO_URING
+    if (IoUring::instance())
+    {
+        return true;
+    }
+#endif
+
 #ifdef HAVE_AIO_RT
     #ifdef __APPLE__
         return false;
@@ -345,11 +353,26 @@ bool PosixFileAccess::asyncavailable()
 #endif
 }
 
-#ifdef HAVE_AIO_RT
+#if defined(HAVE_AIO_RT) || defined(USE_IO_URING)
 AsyncIOContext *PosixFileAccess::newasynccontext()
 {
+#ifdef USE_IO_URING
+    // io_uring is preferred when the kernel supports it
+    if (IoUring::instance())
+    {
+        return new IoUringAsyncIOContext();
+    }
+#endif
+
+#ifdef HAVE_AIO_RT
     return new PosixAsyncIOContext();
+#else
+    return FileAccess::newasynccontext();
+#endif
 }
+#endif
+
+#ifdef HAVE_AIO_RT
 
 void PosixFileAccess::asyncopfinished(sigval sigev_value)
 {
@@ -388,7 +411,7 @@ void PosixFileAccess::asyncopfinished(sigval sigev_value)
 
 void PosixFileAccess::asyncsysopen([[maybe_unused]] AsyncIOContext *context)
 {
-#ifdef HAVE_AIO_RT
+#if defined(HAVE_AIO_RT) || defined(USE_IO_URING)
     context->failed = !fopen(context->openPath, context->access & AsyncIOContext::ACCESS_READ,
                              context->access & AsyncIOContext::ACCESS_WRITE, FSLogging::logOnError);
     if (context->failed)
@@ -406,6 +429,14 @@ void PosixFileAccess::asyncsysopen([[maybe_unused]] AsyncIOContext *context)
 
 void PosixFileAccess::asyncsysread([[maybe_unused]] AsyncIOContext *context)
 {
+#ifdef USE_IO_URING
+    if (auto ringContext = dynamic_cast<IoUringAsyncIOContext*>(context))
+    {
+        IoUring::instance()->submit(fd, ringContext);
+        return;
+    }
+#endif
+
 #ifdef HAVE_AIO_RT
     if (!context)
     {
@@ -455,6 +486,14 @@ void PosixFileAccess::asyncsysread([[maybe_unused]] AsyncIOContext *context)
 
 void PosixFileAccess::asyncsyswrite([[maybe_unused]] AsyncIOContext *context)
 {
+#ifdef USE_IO_URING
+    if (auto ringContext = dynamic_cast<IoUringAsyncIOContext*>(context))
+    {
+        IoUring::instance()->submit(fd, ringContext);
+        return;
+    }
+#endif
+
 #ifdef HAVE_AIO_RT
     if (!context)
     {
@@ -816,6 +855,19 @@ PosixFileSystemAccess::PosixFileSystemAccess()
 
 bool LinuxFileSystemAccess::initFilesystemNotificationSystem()
 {
+#ifdef USE_FANOTIFY
+    // Marking whole filesystems needs CAP_SYS_ADMIN: without it, syncs use inotify watches as usual.
+    mFanotifyFd = fanotify_init(FAN_CLASS_NOTIF
+                                | FAN_REPORT_DFID_NAME
+                                | FAN_UNLIMITED_QUEUE
+                                | FAN_CLOEXEC
+                                | FAN_NONBLOCK,
+                                O_RDONLY | O_LARGEFILE);
+
+    if (mFanotifyFd < 0)
+        LOG_debug << "fanotify is not available, using inotify. Error: " << errno;
+#endif // USE_FANOTIFY
+
     mNotifyFd = inotify_init1(IN_NONBLOCK);
 
     if (mNotifyFd < 0)
@@ -836,6 +888,13 @@ LinuxFileSystemAccess::~LinuxFileSystemAccess()
     if (mNotifyFd >= 0)
         close(mNotifyFd);
 
+#ifdef USE_FANOTIFY
+    assert(mFanotifyFilesystems.empty());
+
+    if (mFanotifyFd >= 0)
+        close(mFanotifyFd);
+#endif // USE_FANOTIFY
+
 #endif // ENABLE_SYNC
 }
 
@@ -876,11 +935,21 @@ void LinuxFileSystemAccess::addevents(Waiter* waiter, int flags)
 {
 #ifdef ENABLE_SYNC
 
+    auto w = static_cast<PosixWaiter*>(waiter);
+
+#ifdef USE_FANOTIFY
+    if (mFanotifyFd >= 0 && !mFanotifyFilesystems.empty())
+    {
+        MEGA_FD_SET(mFanotifyFd, &w->rfds);
+        MEGA_FD_SET(mFanotifyFd, &w->ignorefds);
+
+        w->bumpmaxfd(mFanotifyFd);
+    }
+#endif // USE_FANOTIFY
+
     if (mNotifyFd < 0)
         return;
 
-    auto w = static_cast<PosixWaiter*>(waiter);
-
     MEGA_FD_SET(mNotifyFd, &w->rfds);
     MEGA_FD_SET(mNotifyFd, &w->ignorefds);
 
@@ -896,6 +965,11 @@ int LinuxFileSystemAccess::checkevents(Waiter* waiter)
 
 #ifdef ENABLE_SYNC
 
+#ifdef USE_FANOTIFY
+    if (mFanotifyFd >= 0 && MEGA_FD_ISSET(mFanotifyFd, &static_cast<PosixWaiter*>(waiter)->rfds))
+        result |= checkFanotifyEvents();
+#endif // USE_FANOTIFY
+
     if (mNotifyFd < 0)
         return result;
 
@@ -1007,6 +1081,255 @@ int LinuxFileSystemAccess::checkevents(Waiter* waiter)
 
 #endif //  __linux__
 
+#if defined(__linux__) && defined(ENABLE_SYNC) && defined(USE_FANOTIFY)
+
+// Changes reported for the marked filesystems.
+static const uint64_t FANOTIFY_EVENTS = FAN_ATTRIB
+                                        | FAN_CLOSE_WRITE
+                                        | FAN_CREATE
+                                        | FAN_DELETE
+                                        | FAN_MOVED_FROM
+                                        | FAN_MOVED_TO
+                                        | FAN_ONDIR;
+
+// Resolved directory paths kept before starting over.
+static const size_t MAX_FANOTIFY_DIRECTORIES = 16384;
+
+template<typename Fsid>
+static uint64_t fsidKey(const Fsid& fsid)
+{
+    static_assert(sizeof(fsid) == sizeof(uint64_t), "Unexpected size of fsid");
+
+    uint64_t key;
+    memcpy(&key, &fsid, sizeof(key));
+    return key;
+}
+
+bool LinuxFileSystemAccess::addFanotifyFilesystem(const string& path, uint64_t& fsid)
+{
+    struct statfs info;
+
+    if (statfs(path.c_str(), &info))
+        return false;
+
+    // Events are told apart by the fsid: filesystems without one can't be marked.
+    fsid = fsidKey(info.f_fsid);
+    if (!fsid)
+        return false;
+
+    // Events are mapped back to paths with open_by_handle_at(), which needs CAP_DAC_READ_SEARCH.
+    vector<char> buffer(sizeof(file_handle) + MAX_HANDLE_SZ);
+    auto& handle = *reinterpret_cast<file_handle*>(buffer.data());
+    handle.handle_bytes = MAX_HANDLE_SZ;
+
+    int mountId = 0;
+    bool hasHandle = !name_to_handle_at(AT_FDCWD, path.c_str(), &handle, &mountId, 0);
+
+    auto& filesystem = mFanotifyFilesystems[fsid];
+
+    // Paths are resolved through the mount marked first: through another mount of the
+    // same filesystem (a bind mount...) they wouldn't be below the root of the sync.
+    if (filesystem.users && (!hasHandle || mountId != filesystem.mountId))
+    {
+        LOG_debug << "Filesystem of "
+                  << path
+                  << " already marked for fanotify through another mount";
+
+        return false;
+    }
+
+    if (!filesystem.users)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        int probe = -1;
+
+        if (fd >= 0 && hasHandle)
+            probe = open_by_handle_at(fd, &handle, O_PATH | O_CLOEXEC);
+
+        if (probe < 0
+            || fanotify_mark(mFanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FANOTIFY_EVENTS, AT_FDCWD, path.c_str()))
+        {
+            auto error = errno;
+
+            LOG_warn << "Unable to use fanotify for the filesystem of: "
+                     << path
+                     << ". Error: "
+                     << error;
+
+            if (probe >= 0)
+                close(probe);
+
+            if (fd >= 0)
+                close(fd);
+
+            mFanotifyFilesystems.erase(fsid);
+            return false;
+        }
+
+        close(probe);
+        filesystem.mountFd = fd;
+        filesystem.mountId = mountId;
+    }
+
+    ++filesystem.users;
+    return true;
+}
+
+void LinuxFileSystemAccess::removeFanotifyFilesystem(uint64_t fsid)
+{
+    auto i = mFanotifyFilesystems.find(fsid);
+
+    assert(i != mFanotifyFilesystems.end());
+
+    if (i == mFanotifyFilesystems.end() || --i->second.users)
+        return;
+
+    if (fanotify_mark(mFanotifyFd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM, FANOTIFY_EVENTS, i->second.mountFd, nullptr))
+        LOG_warn << "Unable to remove fanotify mark. Error: " << errno;
+
+    close(i->second.mountFd);
+    mFanotifyFilesystems.erase(i);
+    mFanotifyDirectories.clear();
+}
+
+bool LinuxFileSystemAccess::fanotifyFilesystemMarked(const string& path, uint64_t fsid) const
+{
+    auto i = mFanotifyFilesystems.find(fsid);
+
+    if (i == mFanotifyFilesystems.end())
+        return false;
+
+    vector<char> buffer(sizeof(file_handle) + MAX_HANDLE_SZ);
+    auto& handle = *reinterpret_cast<file_handle*>(buffer.data());
+    handle.handle_bytes = MAX_HANDLE_SZ;
+
+    int mountId = 0;
+
+    return !name_to_handle_at(AT_FDCWD, path.c_str(), &handle, &mountId, 0)
+           && mountId == i->second.mountId;
+}
+
+bool LinuxFileSystemAccess::fanotifyDirectoryPath(uint64_t fsid, file_handle& handle, LocalPath& path)
+{
+    string key(reinterpret_cast<const char*>(&fsid), sizeof(fsid));
+    key.append(reinterpret_cast<const char*>(&handle.handle_type), sizeof(handle.handle_type));
+    key.append(reinterpret_cast<const char*>(handle.f_handle), handle.handle_bytes);
+
+    auto i = mFanotifyDirectories.find(key);
+
+    if (i != mFanotifyDirectories.end())
+    {
+        path = i->second;
+        return true;
+    }
+
+    auto filesystem = mFanotifyFilesystems.find(fsid);
+
+    if (filesystem == mFanotifyFilesystems.end())
+        return false;
+
+    int fd = open_by_handle_at(filesystem->second.mountFd, &handle, O_PATH | O_CLOEXEC);
+
+    // Deleted meanwhile: the event of its own removal will be reported in its parent.
+    if (fd < 0)
+    {
+        LOG_verbose << "Unable to open directory of fanotify event. Error: " << errno;
+        return false;
+    }
+
+    string buffer(PATH_MAX, '\0');
+    auto length = readlink(("/proc/self/fd/" + std::to_string(fd)).c_str(), &buffer[0], buffer.size());
+
+    close(fd);
+
+    if (length <= 0 || static_cast<size_t>(length) >= buffer.size())
+        return false;
+
+    buffer.resize(static_cast<size_t>(length));
+    path = LocalPath::fromPlatformEncodedAbsolute(std::move(buffer));
+
+    if (mFanotifyDirectories.size() >= MAX_FANOTIFY_DIRECTORIES)
+        mFanotifyDirectories.clear();
+
+    mFanotifyDirectories.emplace(std::move(key), path);
+
+    return true;
+}
+
+int LinuxFileSystemAccess::checkFanotifyEvents()
+{
+    int result = 0;
+
+    alignas(fanotify_event_metadata) char buf[16384];
+    ssize_t l;
+
+    while ((l = read(mFanotifyFd, buf, sizeof buf)) > 0)
+    {
+        auto* event = reinterpret_cast<fanotify_event_metadata*>(buf);
+
+        for ( ; FAN_EVENT_OK(event, l); event = FAN_EVENT_NEXT(event, l))
+        {
+            if (event->vers != FANOTIFY_METADATA_VERSION)
+            {
+                LOG_err << "Unexpected fanotify version: " << int(event->vers);
+                break;
+            }
+
+            if (event->fd >= 0)
+                close(event->fd);
+
+            if ((event->mask & FAN_Q_OVERFLOW))
+            {
+                LOG_err << "fanotify FAN_Q_OVERFLOW";
+
+                // So that related syncs perform a rescan.
+                for (auto* notifier : mNotifiers)
+                {
+                    if (static_cast<LinuxDirNotify*>(notifier)->usesFanotify())
+                        ++notifier->mErrorCount;
+                }
+
+                continue;
+            }
+
+            auto* info = reinterpret_cast<fanotify_event_info_fid*>(event + 1);
+            auto* end = reinterpret_cast<char*>(event) + event->event_len;
+
+            // Only the events about an entry of a directory.
+            if (reinterpret_cast<char*>(info) + sizeof(*info) > end
+                || info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                continue;
+
+            auto& handle = *reinterpret_cast<file_handle*>(info->handle);
+            auto* name = reinterpret_cast<const char*>(handle.f_handle + handle.handle_bytes);
+
+            LOG_verbose << "Filesystem notification:"
+                << " event " << name << ": " << std::hex << event->mask;
+
+            LocalPath dirPath;
+
+            if (fanotifyDirectoryPath(fsidKey(info->fsid), handle, dirPath))
+            {
+                for (auto* notifier : mNotifiers)
+                {
+                    auto& linuxNotifier = static_cast<LinuxDirNotify&>(*notifier);
+
+                    if (linuxNotifier.usesFanotify())
+                        result |= linuxNotifier.notifyFanotifyEvent(dirPath, name, event->mask);
+                }
+            }
+
+            // The cached paths of the directories below may not be valid anymore.
+            if ((event->mask & FAN_ONDIR) && (event->mask & (FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO)))
+                mFanotifyDirectories.clear();
+        }
+    }
+
+    return result;
+}
+
+#endif // __linux__ && ENABLE_SYNC && USE_FANOTIFY
+
 
 // no legacy DOS garbage here...
 bool PosixFileSystemAccess::getsname(const LocalPath&, LocalPath&) const
@@ -1633,6 +1956,9 @@ LinuxDirNotify::LinuxDirNotify(LinuxFileSystemAccess& owner,
     : DirNotify(rootPath)
     , mOwner(owner)
     , mNotifiersIt(owner.mNotifiers.insert(owner.mNotifiers.end(), this))
+#ifdef USE_FANOTIFY
+    , mRoot(root)
+#endif // USE_FANOTIFY
 {
     // Assume our owner couldn't initialize.
     setFailed(-owner.mNotifyFd, "Unable to create filesystem monitor.");
@@ -1640,14 +1966,148 @@ LinuxDirNotify::LinuxDirNotify(LinuxFileSystemAccess& owner,
     // Did our owner initialize correctly?
     if (owner.mNotifyFd >= 0)
         setFailed(0, "");
+
+#ifdef USE_FANOTIFY
+    useFanotify(rootPath);
+#endif // USE_FANOTIFY
 }
 
 LinuxDirNotify::~LinuxDirNotify()
 {
+#ifdef USE_FANOTIFY
+    for (auto fsid : mFanotifyFilesystems)
+        mOwner.removeFanotifyFilesystem(fsid);
+#endif // USE_FANOTIFY
+
     // Remove ourselves from our owner's list of notiifers.
     mOwner.mNotifiers.erase(mNotifiersIt);
 }
 
+#ifdef USE_FANOTIFY
+
+// Mount points strictly below path.
+static vector<string> mountPointsBelow(const string& path)
+{
+    using FileDeleter = std::function<int(FILE*)>;
+    using FilePtr     = std::unique_ptr<FILE, FileDeleter>;
+
+    vector<string> mountPoints;
+
+    FilePtr mounts(setmntent("/proc/self/mounts", "r"), endmntent);
+
+    if (!mounts)
+        return mountPoints;
+
+    auto prefix = path.back() == '/' ? path : path + '/';
+
+    std::string storage(3 * PATH_MAX, '\x0');
+    struct mntent entry;
+
+    while (getmntent_r(mounts.get(), &entry, storage.data(), static_cast<int>(storage.size())))
+    {
+        std::string target = entry.mnt_dir;
+
+        if (target.size() > prefix.size() && !target.compare(0, prefix.size(), prefix))
+            mountPoints.emplace_back(std::move(target));
+    }
+
+    return mountPoints;
+}
+
+void LinuxDirNotify::useFanotify(const LocalPath& rootPath)
+{
+    if (mOwner.mFanotifyFd < 0)
+        return;
+
+    // The kernel reports paths without symlinks.
+    unique_ptr<char, decltype(&free)> canonical(realpath(rootPath.localpath.c_str(), nullptr), &free);
+
+    if (!canonical)
+        return;
+
+    string root = canonical.get();
+    mCanonicalRoot = LocalPath::fromPlatformEncodedAbsolute(root);
+
+    // A mark covers a single filesystem: those mounted below the root need their own.
+    auto paths = mountPointsBelow(root);
+    paths.insert(paths.begin(), root);
+
+    for (auto& path : paths)
+    {
+        uint64_t fsid;
+
+        if (!mOwner.addFanotifyFilesystem(path, fsid))
+        {
+            // Otherwise, inotify watches for the whole sync.
+            for (auto marked : mFanotifyFilesystems)
+                mOwner.removeFanotifyFilesystem(marked);
+
+            mFanotifyFilesystems.clear();
+            return;
+        }
+
+        mFanotifyFilesystems.emplace_back(fsid);
+    }
+
+    LOG_info << "Filesystem notifications from fanotify for: " << rootPath;
+}
+
+bool LinuxDirNotify::fanotifyCovers(const LocalPath& path)
+{
+    if (!usesFanotify())
+        return false;
+
+    struct statfs info;
+
+    if (statfs(path.localpath.c_str(), &info))
+        return false;
+
+    auto fsid = fsidKey(info.f_fsid);
+
+    if (std::find(mFanotifyFilesystems.begin(), mFanotifyFilesystems.end(), fsid) != mFanotifyFilesystems.end())
+        return mOwner.fanotifyFilesystemMarked(path.localpath, fsid);
+
+    // A filesystem mounted below the root after the sync started.
+    if (!mOwner.addFanotifyFilesystem(path.localpath, fsid))
+        return false;
+
+    mFanotifyFilesystems.emplace_back(fsid);
+
+    LOG_info << "Filesystem notifications from fanotify for: " << path;
+
+    return true;
+}
+
+int LinuxDirNotify::notifyFanotifyEvent(const LocalPath& dirPath, const char* name, uint64_t mask)
+{
+    size_t index = 0;
+
+    if (!mCanonicalRoot.isContainingPathOf(dirPath, &index))
+        return 0;
+
+    auto path = dirPath.subpathFrom(index);
+
+    // "." is the directory itself.
+    if (*name && strcmp(name, "."))
+        path.appendWithSeparator(LocalPath::fromPlatformEncodedRelative(name), false);
+
+    LOG_debug << "Filesystem notification:"
+        << " Root: "
+        << mRoot.localname
+        << " Path: "
+        << path;
+
+    notify(fsEventq, &mRoot, Notification::NEEDS_PARENT_SCAN, LocalPath(path));
+
+    // We need to rescan the directory if it's changed permissions, as with inotify.
+    if ((mask & FAN_ATTRIB) && (mask & FAN_ONDIR))
+        notify(fsEventq, &mRoot, Notification::FOLDER_NEEDS_SELF_SCAN, std::move(path));
+
+    return Waiter::NEEDEXEC;
+}
+
+#endif // USE_FANOTIFY
+
 #if defined(USE_INOTIFY)
 
 AddWatchResult LinuxDirNotify::addWatch(LocalNode& node,
@@ -1823,15 +2283,6 @@ ScanResult PosixFileSystemAccess::directoryScan(const LocalPath& targetPath,
     // Scan path should always be absolute.
     assert(targetPath.isAbsolute());
 
-    // Whether we can reuse an existing fingerprint.
-    // I.e. Can we avoid computing the CRC?
-    auto reuse = [](const FSNode& lhs, const FSNode& rhs) {
-        return lhs.type == rhs.type
-               && lhs.fsid == rhs.fsid
-               && lhs.fingerprint.mtime == rhs.fingerprint.mtime
-               && lhs.fingerprint.size == rhs.fingerprint.size;
-    };
-
     // So we don't duplicate link chasing logic.
     auto stat = [&](const char* path, struct stat& metadata, bool* followSymLinkHere = nullptr) {
         auto result = !lstat(path, &metadata);
@@ -1992,6 +2443,12 @@ ScanResult PosixFileSystemAccess::directoryScan(const LocalPath& targetPath,
         // We're dealing with a regular file.
         result.type = FILENODE;
 
+#ifdef __MACH__
+        result.ctime = metadata.st_ctimespec.tv_sec * 1000000000ll + metadata.st_ctimespec.tv_nsec;
+#else
+        result.ctime = metadata.st_ctim.tv_sec * 1000000000ll + metadata.st_ctim.tv_nsec;
+#endif
+
 #ifdef __MACH__
         // 1904/01/01 00:00:00 +0000 GMT.
         //
@@ -2020,7 +2477,7 @@ ScanResult PosixFileSystemAccess::directoryScan(const LocalPath& targetPath,
         auto it = known.find(result.localname);
 
         // Can we avoid recomputing this file's fingerprint?
-        if (it != known.end() && reuse(result, it->second))
+        if (it != known.end() && result.canReuseFingerprint(it->second))
         {
             result.fingerprint = std::move(it->second.fingerprint);
             continue;
@@ -0,0 +1,320 @@
+/**
+ * @file posix/iouring.cpp
+ * @brief Linux io_uring backend for asynchronous file reads and writes
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "mega.h"
+
+#ifdef USE_IO_URING
+
+#include "mega/posix/megaiouring.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace mega {
+
+namespace {
+
+// enough for the parallel connections of several transfers
+const unsigned RING_ENTRIES = 128;
+
+void* mapRing(int fd, size_t size, off_t offset)
+{
+    void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return ring == MAP_FAILED ? nullptr : ring;
+}
+
+} // namespace
+
+IoUringAsyncIOContext::~IoUringAsyncIOContext()
+{
+    LOG_verbose << "Deleting IoUringAsyncIOContext";
+    finish();
+}
+
+void IoUringAsyncIOContext::finish()
+{
+    if (inflight)
+    {
+        if (!finished)
+        {
+            LOG_debug << "Synchronously waiting for async operation";
+            AsyncIOContext::finish();
+        }
+        inflight = false;
+    }
+    assert(finished);
+}
+
+IoUring* IoUring::instance()
+{
+    static std::unique_ptr<IoUring> ring = []()
+    {
+        std::unique_ptr<IoUring> r(new IoUring());
+        if (!r->init(RING_ENTRIES))
+        {
+            r.reset();
+        }
+        return r;
+    }();
+
+    return ring.get();
+}
+
+bool IoUring::init(unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof params);
+
+    mRingFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (mRingFd < 0)
+    {
+        LOG_info << "io_uring not available, using POSIX AIO: " << errno;
+        return false;
+    }
+
+    mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+    {
+        mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+    }
+
+    mSqRing = mapRing(mRingFd, mSqRingSize, IORING_OFF_SQ_RING);
+    mCqRing = singleMmap ? mSqRing : mapRing(mRingFd, mCqRingSize, IORING_OFF_CQ_RING);
+    mSqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    mSqes = mapRing(mRingFd, mSqesSize, IORING_OFF_SQES);
+    if (!mSqRing || !mCqRing || !mSqes)
+    {
+        LOG_err << "Unable to map the io_uring rings: " << errno;
+        return false;
+    }
+
+    char* sq = static_cast<char*>(mSqRing);
+    mSqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    mSqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    mSqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    mSqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    mSqEntries = params.sq_entries;
+
+    char* cq = static_cast<char*>(mCqRing);
+    mCqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    mCqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    mCqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    mCqes = cq + params.cq_off.cqes;
+    mCqEntries = params.cq_entries;
+
+    mReaper = std::thread([this]() { reap(); });
+
+    LOG_info << "Using io_uring for async file I/O (" << mSqEntries << " entries)";
+    return true;
+}
+
+IoUring::~IoUring()
+{
+    if (mReaper.joinable())
+    {
+        mExit = true;
+
+        // wake up the reaper with a NOP
+        bool woken = false;
+        {
+            std::lock_guard<std::mutex> g(mSubmitMutex);
+            unsigned tail = *mSqTail;
+            if (tail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) < mSqEntries)
+            {
+                unsigned index = tail & *mSqMask;
+                auto sqe = static_cast<struct io_uring_sqe*>(mSqes) + index;
+                memset(sqe, 0, sizeof *sqe);
+                sqe->opcode = IORING_OP_NOP;
+                mSqArray[index] = index;
+                __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+                woken = enter(1, 0, 0);
+            }
+        }
+
+        if (woken)
+        {
+            mReaper.join();
+        }
+        else
+        {
+            LOG_err << "Unable to stop the io_uring completion thread";
+            mReaper.detach();
+            return;  // the thread may still use the rings
+        }
+    }
+
+    if (mSqes)
+    {
+        munmap(mSqes, mSqesSize);
+    }
+    if (mCqRing && mCqRing != mSqRing)
+    {
+        munmap(mCqRing, mCqRingSize);
+    }
+    if (mSqRing)
+    {
+        munmap(mSqRing, mSqRingSize);
+    }
+    if (mRingFd >= 0)
+    {
+        close(mRingFd);
+    }
+}
+
+bool IoUring::enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    for (;;)
+    {
+        if (syscall(__NR_io_uring_enter, mRingFd, toSubmit, minComplete, flags, nullptr, 0) >= 0)
+        {
+            return true;
+        }
+
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+}
+
+void IoUring::submit(int fd, IoUringAsyncIOContext* context)
+{
+    context->iov.iov_base = context->dataBuffer;
+    context->iov.iov_len = context->dataBufferLen;
+
+    int e = EAGAIN;
+    {
+        std::lock_guard<std::mutex> g(mSubmitMutex);
+
+        unsigned tail = *mSqTail;
+        if (mInflight < mCqEntries && tail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) < mSqEntries)
+        {
+            unsigned index = tail & *mSqMask;
+            auto sqe = static_cast<struct io_uring_sqe*>(mSqes) + index;
+            memset(sqe, 0, sizeof *sqe);
+            sqe->opcode = context->op == AsyncIOContext::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->fd = fd;
+            sqe->off = static_cast<uint64_t>(context->posOfBuffer);
+            sqe->addr = reinterpret_cast<uint64_t>(&context->iov);
+            sqe->len = 1;
+            sqe->user_data = reinterpret_cast<uint64_t>(context);
+            mSqArray[index] = index;
+
+            context->inflight = true;
+            ++mInflight;
+            __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+
+            if (enter(1, 0, 0))
+            {
+                return;
+            }
+            e = errno;
+
+            if (__atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) != tail)
+            {
+                // consumed by the kernel despite the error: its completion will arrive
+                return;
+            }
+
+            // take it back, so it's not submitted with the next operation
+            __atomic_store_n(mSqTail, tail, __ATOMIC_RELEASE);
+            --mInflight;
+            context->inflight = false;
+        }
+    }
+
+    LOG_warn << "Async " << (context->op == AsyncIOContext::READ ? "read" : "write") << " failed at startup: " << e;
+    context->retry = (e == EAGAIN || e == EBUSY);
+    context->failed = true;
+    context->finished = true;
+    if (context->userCallback)
+    {
+        context->userCallback(context->userData);
+    }
+}
+
+void IoUring::reap()
+{
+    while (!mExit)
+    {
+        if (!enter(0, 1, IORING_ENTER_GETEVENTS))
+        {
+            LOG_err << "Error waiting for io_uring completions: " << errno;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        unsigned head = *mCqHead;
+        unsigned tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            auto cqe = static_cast<struct io_uring_cqe*>(mCqes) + (head & *mCqMask);
+            if (auto context = reinterpret_cast<IoUringAsyncIOContext*>(cqe->user_data))
+            {
+                --mInflight;
+                complete(context, cqe->res);
+            }
+        }
+        __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+void IoUring::complete(IoUringAsyncIOContext* context, int result)
+{
+    // A short read means the end of the file was reached (it shrank since it was opened): retrying
+    // would get the same result. A short write is retried: writing the whole buffer again is
+    // harmless, and persistent failures (no space...) are reported as errors by the next attempt.
+    bool shortTransfer = result >= 0 && static_cast<unsigned>(result) != context->dataBufferLen;
+    context->retry = result == -EAGAIN || result == -EINTR || (shortTransfer && context->op == AsyncIOContext::WRITE);
+    context->failed = result < 0 || shortTransfer;
+    if (!context->failed)
+    {
+        if (context->op == AsyncIOContext::READ)
+        {
+            memset(context->dataBuffer + context->dataBufferLen, 0, context->pad);
+            LOG_verbose << "Async read finished OK";
+        }
+        else
+        {
+            LOG_verbose << "Async write finished OK";
+        }
+    }
+    else
+    {
+        LOG_warn << "Async operation finished with error: " << (result < 0 ? -result : 0)
+                 << " transferred: " << (result < 0 ? 0 : result) << " of " << context->dataBufferLen;
+    }
+
+    // the context can be deleted as soon as it's finished
+    asyncfscallback userCallback = context->userCallback;
+    void *userData = context->userData;
+    context->finished = true;
+    if (userCallback)
+    {
+        userCallback(userData);
+    }
+}
+
+} // namespace
+
+#endif // USE_IO_URING
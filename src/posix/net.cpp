@@ -366,6 +366,7 @@ CurlHttpIO::CurlHttpIO()
 
     curltimeoutreset[PUT] = -1;
     arerequestspaused[PUT] = false;
+    setmultiplexing();
 
     curlsh = curl_share_init();
     curl_share_setopt(curlsh, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
@@ -612,6 +613,13 @@ void CurlHttpIO::addcurlevents(Waiter *waiter, direction_t d)
         anyWriters = anyWriters || info.signalledWrite;
         info.signalledWrite = false;
         info.createAssociateEvent();
+#elif defined(USE_EPOLL)
+        // the socket stays in the waiter until cURL changes its mode or removes it
+        if (info.watched != info.mode)
+        {
+            ((PosixWaiter *)waiter)->watch(info.fd, info.mode & SockInfo::READ, info.mode & SockInfo::WRITE);
+            info.watched = info.mode;
+        }
 #else
 
         if (info.mode & SockInfo::READ)
@@ -673,10 +681,26 @@ void CurlHttpIO::closecurlevents(direction_t d)
     {
         it->second.closeEvent(false);
     }
+#elif defined(USE_EPOLL)
+    for (auto& mapPair : socketmap)
+    {
+        unwatchcurlsocket(mapPair.second);
+    }
 #endif
     socketmap.clear();
 }
 
+#ifdef USE_EPOLL
+void CurlHttpIO::unwatchcurlsocket(SockInfo& info)
+{
+    if (info.watched && waiter)
+    {
+        ((PosixWaiter *)waiter)->unwatch(info.fd);
+    }
+    info.watched = SockInfo::NONE;
+}
+#endif
+
 #ifdef MEGA_USE_C_ARES
 void CurlHttpIO::processaresevents()
 {
@@ -927,6 +951,7 @@ void CurlHttpIO::disconnect()
 #endif
     curltimeoutreset[PUT] = -1;
     arerequestspaused[PUT] = false;
+    setmultiplexing();
 
     disconnecting = false;
 #ifdef MEGA_USE_C_ARES
@@ -970,6 +995,31 @@ m_off_t CurlHttpIO::getmaxuploadspeed()
     return maxspeed[PUT];
 }
 
+bool CurlHttpIO::sethttp2(bool enable)
+{
+    if (enable && !(curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2))
+    {
+        LOG_warn << "HTTP/2 not supported by libcurl " << curl_version_info(CURLVERSION_NOW)->version;
+        return false;
+    }
+
+    LOG_info << "HTTP/2 " << (enable ? "enabled" : "disabled");
+    http2 = enable;
+    setmultiplexing();
+
+    // only new requests are affected
+    return true;
+}
+
+void CurlHttpIO::setmultiplexing()
+{
+    // requests to the same host share an HTTP/2 connection, as streams, up to the limit set by the server
+    long pipelining = http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING;
+    curl_multi_setopt(curlm[API], CURLMOPT_PIPELINING, pipelining);
+    curl_multi_setopt(curlm[GET], CURLMOPT_PIPELINING, pipelining);
+    curl_multi_setopt(curlm[PUT], CURLMOPT_PIPELINING, pipelining);
+}
+
 bool CurlHttpIO::cacheresolvedurls(const std::vector<string>& urls, std::vector<string>&& ips)
 {
     // for each URL there should be 2 IPs (IPv4 first, IPv6 second)
@@ -1039,6 +1089,13 @@ void CurlHttpIO::addevents(Waiter* w, int)
     {
         if (arerequestspaused[d])
         {
+#ifdef USE_EPOLL
+            // sockets of paused transfers must not wake the waiter up
+            for (auto& mapPair : curlsockets[d])
+            {
+                unwatchcurlsocket(mapPair.second);
+            }
+#endif
             if (curltimeoutms < 0 || curltimeoutms > 100)
             {
                 curltimeoutms = 100;
@@ -1557,6 +1614,18 @@ void CurlHttpIO::send_request(CurlHttpContext* httpctx)
         curl_easy_setopt(curl, CURLOPT_SOCKOPTFUNCTION, sockopt_callback);
         curl_easy_setopt(curl, CURLOPT_SOCKOPTDATA, (void*)req);
         curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+
+        if (httpio->http2)
+        {
+            // HTTP/2 over TLS, and wait for a connection being established to the same host
+            // to know if it can be multiplexed rather than opening a new one
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        }
+        else
+        {
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+        }
 #ifndef MEGA_USE_C_ARES
         curl_easy_setopt(curl, CURLOPT_QUICK_EXIT, 1L);
 #endif
@@ -2298,8 +2367,13 @@ bool CurlHttpIO::multidoio(CURLM *curlmhandle)
                 curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpstatus);
                 req->httpstatus = int(httpstatus);
 
+                long newconnections = 0;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_NUM_CONNECTS, &newconnections);
+                req->mNewConnections = int(newconnections);
+
                 LOG_debug << req->logname << "CURLMSG_DONE with HTTP status: " << req->httpstatus << " from "
-                          << (req->httpiohandle ? (((CurlHttpContext*)req->httpiohandle)->hostname + " - " + ((CurlHttpContext*)req->httpiohandle)->hostip) : "(unknown) ");
+                          << (req->httpiohandle ? (((CurlHttpContext*)req->httpiohandle)->hostname + " - " + ((CurlHttpContext*)req->httpiohandle)->hostip) : "(unknown) ")
+                          << (req->mNewConnections ? "" : " (reused connection)");
                 if (req->httpstatus)
                 {
                     if (req->mExpectRedirect && req->isRedirection()) // HTTP 3xx response
@@ -2660,22 +2734,23 @@ size_t CurlHttpIO::check_header(void* ptr, size_t size, size_t nmemb, void* targ
 
         return size * nmemb;
     }
-    else if (len > 15 && !memcmp(ptr, "Content-Length:", 15))
+    // header names are lowercase in HTTP/2
+    else if (len > 15 && !strncasecmp(static_cast<const char*>(ptr), "Content-Length:", 15))
     {
         if (req->contentlength < 0)
         {
             req->setcontentlength(atoll((char*)ptr + 15));
         }
     }
-    else if (len > 24 && !memcmp(ptr, "Original-Content-Length:", 24))
+    else if (len > 24 && !strncasecmp(static_cast<const char*>(ptr), "Original-Content-Length:", 24))
     {
         req->setcontentlength(atoll((char*)ptr + 24));
     }
-    else if (len > 17 && !memcmp(ptr, "X-MEGA-Time-Left:", 17))
+    else if (len > 17 && !strncasecmp(static_cast<const char*>(ptr), "X-MEGA-Time-Left:", 17))
     {
         req->timeleft = atol((char*)ptr + 17);
     }
-    else if (len > 15 && !memcmp(ptr, "Content-Type:", 13))
+    else if (len > 15 && !strncasecmp(static_cast<const char*>(ptr), "Content-Type:", 13))
     {
         req->contenttype.assign((char *)ptr + 13, len - 15);
     }
@@ -2750,6 +2825,8 @@ int CurlHttpIO::socket_callback(CURL *, curl_socket_t s, int what, void *userp,
 
 #if defined(_WIN32)
             it->second.closeEvent();
+#elif defined(USE_EPOLL)
+            httpio->unwatchcurlsocket(it->second);
 #endif
             it->second.mode = 0;
         }
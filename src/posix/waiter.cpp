@@ -22,12 +22,29 @@
 #include "mega.h"
 
 
-#ifdef USE_POLL
+#if defined(USE_POLL) || defined(USE_EPOLL)
     #include <poll.h> //poll
 #endif
 
 namespace mega {
 
+namespace {
+
+// poll()/epoll_wait() timeout for maxds
+int timeoutInMs(dstime maxds)
+{
+    // wait infinite (-1) if maxds is max dstime OR it would overflow platform's int
+    int ms = -1;
+    if (maxds != std::numeric_limits<dstime>::max() &&
+        maxds <= std::numeric_limits<int>::max() / 100)
+    {
+        ms = static_cast<int>(maxds) * 100;
+    }
+    return ms;
+}
+
+} // namespace
+
 PosixWaiter::PosixWaiter()
 {
     // pipe to be able to leave the select() call
@@ -43,14 +60,261 @@ PosixWaiter::PosixWaiter()
     }
 
     maxfd = -1;
+
+    useEpoll(true);
 }
 
 PosixWaiter::~PosixWaiter()
 {
+    useEpoll(false);
+
     close(m_pipe[0]);
     close(m_pipe[1]);
 }
 
+bool PosixWaiter::useEpoll(bool enable)
+{
+#ifdef USE_EPOLL
+    if (!enable && mEpollFd >= 0)
+    {
+        close(mEpollFd);
+        mEpollFd = -1;
+        mRegistered.clear();
+        mCycleFds.clear();
+    }
+    else if (enable && mEpollFd < 0)
+    {
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFd < 0)
+        {
+            LOG_warn << "Unable to create the epoll instance, using poll(): " << errno;
+            return false;
+        }
+
+        // the pipe and the watched fds stay registered, the fds of each cycle are registered in wait()
+        updateEpoll(m_pipe[0], EPOLLIN);
+        for (auto& w : mWatched)
+        {
+            updateEpoll(w.first, epollEvents(w.first));
+        }
+    }
+    return mEpollFd >= 0;
+#else
+    static_cast<void>(enable);
+    return false;
+#endif
+}
+
+void PosixWaiter::watch(int fd, bool read, bool write)
+{
+    if (!read && !write)
+    {
+        return unwatch(fd);
+    }
+
+    mWatched[fd] = (read ? WATCH_READ : 0) | (write ? WATCH_WRITE : 0);
+
+#ifdef USE_EPOLL
+    if (mEpollFd >= 0)
+    {
+        updateEpoll(fd, epollEvents(fd));
+    }
+#endif
+}
+
+void PosixWaiter::unwatch(int fd)
+{
+    if (!mWatched.erase(fd))
+    {
+        return;
+    }
+
+#ifdef USE_EPOLL
+    if (mEpollFd >= 0)
+    {
+        updateEpoll(fd, epollEvents(fd));
+    }
+#endif
+}
+
+#ifdef USE_EPOLL
+// events of a fd that is watched and/or was added to the sets in the current cycle
+uint32_t PosixWaiter::epollEvents(int fd) const
+{
+    uint32_t events = 0;
+
+    auto w = mWatched.find(fd);
+    if (w != mWatched.end())
+    {
+        events |= (w->second & WATCH_READ) ? uint32_t(EPOLLIN) : 0;
+        events |= (w->second & WATCH_WRITE) ? uint32_t(EPOLLOUT) : 0;
+    }
+
+    auto c = mCycleFds.find(fd);
+    if (c != mCycleFds.end())
+    {
+        events |= c->second;
+    }
+
+    return events;
+}
+
+// updates the registration of a fd in the epoll instance, only if its events changed unless 'force' is set
+// (a fd that may have been closed and reopened with the same number, which dropped its registration)
+// returns false if the fd can't be registered
+bool PosixWaiter::updateEpoll(int fd, uint32_t events, bool force)
+{
+    auto it = mRegistered.find(fd);
+    if (it != mRegistered.end() && it->second == events && (!force || !events))
+    {
+        return true;
+    }
+
+    if (!events)
+    {
+        if (it == mRegistered.end())
+        {
+            return true;
+        }
+
+        // it fails if the fd was closed, which already removed it
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+        mRegistered.erase(it);
+        return true;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+
+    int op = it == mRegistered.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    int result = epoll_ctl(mEpollFd, op, fd, &ev);
+
+    // the fd was closed and reused without being unwatched, or it was closed and registered again
+    if (result < 0 && ((op == EPOLL_CTL_MOD && errno == ENOENT) || (op == EPOLL_CTL_ADD && errno == EEXIST)))
+    {
+        op = op == EPOLL_CTL_MOD ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        result = epoll_ctl(mEpollFd, op, fd, &ev);
+    }
+
+    if (result < 0)
+    {
+        // regular files (EPERM) are always ready, as with poll()
+        if (errno != EPERM)
+        {
+            LOG_err << "epoll_ctl error for fd " << fd << ": " << errno;
+        }
+
+        if (it != mRegistered.end())
+        {
+            mRegistered.erase(it);
+        }
+        return false;
+    }
+
+    mRegistered[fd] = events;
+    return true;
+}
+
+// only the fds that changed since the previous cycle are updated in the epoll instance,
+// and only the ready ones are reported in rfds/wfds/efds
+int PosixWaiter::waitEpoll(int timeoutMs)
+{
+    std::map<int, uint32_t> cycleFds;
+    for (int fd : rfds)
+    {
+        cycleFds[fd] |= EPOLLIN;
+    }
+    for (int fd : wfds)
+    {
+        cycleFds[fd] |= EPOLLOUT;
+    }
+    for (int fd : efds)
+    {
+        cycleFds[fd] |= EPOLLPRI;
+    }
+    mCycleFds.swap(cycleFds);
+
+    // fds of the previous cycle that aren't there anymore
+    for (auto& c : cycleFds)
+    {
+        if (!mCycleFds.count(c.first))
+        {
+            updateEpoll(c.first, epollEvents(c.first));
+        }
+    }
+
+    // the fds of each cycle (c-ares sockets...) can be closed and reopened with the same number
+    // between cycles without the waiter knowing, so they are registered again every time
+    // (unlike watched fds, which are unwatched before being closed)
+    std::vector<int> alwaysReady;
+    for (auto& c : mCycleFds)
+    {
+        if (!updateEpoll(c.first, epollEvents(c.first), !mWatched.count(c.first)))
+        {
+            alwaysReady.push_back(c.first);
+        }
+    }
+
+    mEvents.resize(mRegistered.size());
+    int numfd = epoll_wait(mEpollFd, mEvents.data(), static_cast<int>(mEvents.size()), alwaysReady.empty() ? timeoutMs : 0);
+
+    MEGA_FD_ZERO(&rfds);
+    MEGA_FD_ZERO(&wfds);
+    MEGA_FD_ZERO(&efds);
+
+    bool needexec = false;
+    for (int i = 0; i < numfd; i++)
+    {
+        int fd = mEvents[i].data.fd;
+        uint32_t events = mEvents[i].events;
+
+        if (fd == m_pipe[0])
+        {
+            continue;
+        }
+
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+        {
+            MEGA_FD_SET(fd, &rfds);
+        }
+        if (events & (EPOLLOUT | EPOLLERR))
+        {
+            MEGA_FD_SET(fd, &wfds);
+        }
+        if (events & EPOLLPRI)
+        {
+            MEGA_FD_SET(fd, &efds);
+        }
+
+        needexec |= !MEGA_FD_ISSET(fd, &ignorefds);
+    }
+
+    for (int fd : alwaysReady)
+    {
+        uint32_t events = mCycleFds[fd];
+        if (events & EPOLLIN)
+        {
+            MEGA_FD_SET(fd, &rfds);
+        }
+        if (events & EPOLLOUT)
+        {
+            MEGA_FD_SET(fd, &wfds);
+        }
+
+        needexec |= !MEGA_FD_ISSET(fd, &ignorefds);
+    }
+
+    // timeout or error
+    if (drainpipe() || numfd <= 0)
+    {
+        return NEEDEXEC;
+    }
+
+    return needexec ? NEEDEXEC : 0;
+}
+#endif
+
 void PosixWaiter::init(dstime ds)
 {
     Waiter::init(ds);
@@ -99,9 +363,29 @@ bool PosixWaiter::fd_filter(int nfds, mega_fd_set_t* fds, mega_fd_set_t* ignoref
 // returns application-specific bitmask. bit 0 set indicates that exec() needs to be called.
 int PosixWaiter::wait()
 {
+#ifdef USE_EPOLL
+    if (mEpollFd >= 0)
+    {
+        return waitEpoll(timeoutInMs(maxds));
+    }
+#endif
+
     int numfd = 0;
     timeval tv;
 
+    for (auto& w : mWatched)
+    {
+        if (w.second & WATCH_READ)
+        {
+            MEGA_FD_SET(w.first, &rfds);
+        }
+        if (w.second & WATCH_WRITE)
+        {
+            MEGA_FD_SET(w.first, &wfds);
+        }
+        bumpmaxfd(w.first);
+    }
+
     //Pipe added to rfds to be able to leave select() when needed
     MEGA_FD_SET(m_pipe[0], &rfds);
 
@@ -115,14 +399,7 @@ int PosixWaiter::wait()
         tv.tv_usec = (suseconds_t)(us - tv.tv_sec * 1000000);
     }
 
-#ifdef USE_POLL
-    // wait infinite (-1) if maxds is max dstime OR it would overflow platform's int
-    int timeoutInMs = -1;
-    if (maxds != std::numeric_limits<dstime>::max() &&
-        maxds <= std::numeric_limits<int>::max() / 100)
-    {
-        timeoutInMs = static_cast<int>(maxds) * 100;
-    }
+#if defined(USE_POLL) || defined(USE_EPOLL)
     auto total = rfds.size() + wfds.size() + efds.size();
     struct pollfd fds[total];
 
@@ -147,32 +424,31 @@ int PosixWaiter::wait()
         fds[polli].events = POLLEX_SET;
         polli++;
     }
-    numfd = poll(fds, total, timeoutInMs);
-#else
-    numfd = select(maxfd + 1, &rfds, &wfds, &efds, maxds + 1 ? &tv : NULL);
-#endif
-
-    // empty pipe
-    uint8_t buf;
-    bool external = false;
+    numfd = poll(fds, total, timeoutInMs(maxds));
 
+    // leave only the ready fds in the sets, as select() does
+    MEGA_FD_ZERO(&rfds);
+    MEGA_FD_ZERO(&wfds);
+    MEGA_FD_ZERO(&efds);
+    for (unsigned int i = 0 ; numfd > 0 && i < total ; i++)
     {
-        std::lock_guard<std::mutex> g(mMutex);
-        while (read(m_pipe[0], &buf, sizeof buf) > 0)
+        if (fds[i].revents & fds[i].events)
         {
-            external = true;
+            MEGA_FD_SET(fds[i].fd, fds[i].events == POLLIN_SET ? &rfds : (fds[i].events == POLLOUT_SET ? &wfds : &efds));
         }
-        alreadyNotified = false;
     }
+#else
+    numfd = select(maxfd + 1, &rfds, &wfds, &efds, maxds + 1 ? &tv : NULL);
+#endif
 
     // timeout or error
-    if (external || numfd <= 0)
+    if (drainpipe() || numfd <= 0)
     {
         return NEEDEXEC;
     }
 
     // request exec() to be run only if a non-ignored fd was triggered
-#ifdef USE_POLL
+#if defined(USE_POLL) || defined(USE_EPOLL)
     for (unsigned int i = 0 ; i < total ; i++)
     {
         if  ((fds[i].revents & (POLLIN_SET | POLLOUT_SET | POLLEX_SET) )  && !MEGA_FD_ISSET(fds[i].fd, &ignorefds) )
@@ -189,6 +465,21 @@ int PosixWaiter::wait()
 #endif
 }
 
+bool PosixWaiter::drainpipe()
+{
+    uint8_t buf;
+    bool external = false;
+
+    std::lock_guard<std::mutex> g(mMutex);
+    while (read(m_pipe[0], &buf, sizeof buf) > 0)
+    {
+        external = true;
+    }
+    alreadyNotified = false;
+
+    return external;
+}
+
 void PosixWaiter::notify()
 {
     std::lock_guard<std::mutex> g(mMutex);
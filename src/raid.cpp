@@ -20,6 +20,7 @@
  */
 
 #include "mega/raid.h"
+#include "mega/bufferpool.h"
 
 #include "mega/transfer.h"
 #include "mega/testhooks.h"
@@ -28,9 +29,177 @@
 
 #undef min //avoids issues with std::min
 
+// RAID lines are combined with 16-byte vectors (baseline on x86-64 and arm64), and with 32-byte ones
+// on x86-64 CPUs with AVX2, selected at runtime. Those functions are compiled for that target only.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MEGA_RAID_SSE2 1
+#include <emmintrin.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MEGA_RAID_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define MEGA_RAID_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace mega
 {
 
+namespace {
+
+// a RAID sector in a vector register
+#if defined(MEGA_RAID_SSE2)
+typedef __m128i sector_t;
+inline sector_t loadSector(const byte* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void storeSector(byte* p, sector_t v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline sector_t xorSector(sector_t a, sector_t b) { return _mm_xor_si128(a, b); }
+#elif defined(MEGA_RAID_NEON)
+typedef uint8x16_t sector_t;
+inline sector_t loadSector(const byte* p) { return vld1q_u8(p); }
+inline void storeSector(byte* p, sector_t v) { vst1q_u8(p, v); }
+inline sector_t xorSector(sector_t a, sector_t b) { return veorq_u8(a, b); }
+#else
+struct sector_t { uint64_t h, l; };
+inline sector_t loadSector(const byte* p) { sector_t v; memcpy(&v, p, sizeof v); return v; }
+inline void storeSector(byte* p, sector_t v) { memcpy(p, &v, sizeof v); }
+inline sector_t xorSector(sector_t a, sector_t b) { return { a.h ^ b.h, a.l ^ b.l }; }
+#endif
+
+static_assert(sizeof(sector_t) == RAIDSECTOR, "a RAID sector must fill a vector");
+
+// 'missing' is the null data part (1-5), or 0 if all of them are present
+void combineRaidLinesVector(byte* dest, const byte* const parts[RAIDPARTS], unsigned missing, size_t lines)
+{
+    size_t end = lines * RAIDSECTOR;
+    if (!missing)
+    {
+        for (size_t i = 0; i < end; i += RAIDSECTOR, dest += RAIDLINE)
+        {
+            for (unsigned j = 1; j < RAIDPARTS; ++j)
+            {
+                storeSector(dest + (j - 1) * RAIDSECTOR, loadSector(parts[j] + i));
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < end; i += RAIDSECTOR, dest += RAIDLINE)
+    {
+        sector_t parity = loadSector(parts[0] + i);
+        for (unsigned j = 1; j < RAIDPARTS; ++j)
+        {
+            if (j != missing)
+            {
+                sector_t v = loadSector(parts[j] + i);
+                storeSector(dest + (j - 1) * RAIDSECTOR, v);
+                parity = xorSector(parity, v);
+            }
+        }
+        storeSector(dest + (missing - 1) * RAIDSECTOR, parity);
+    }
+}
+
+#ifdef MEGA_RAID_AVX2
+// Two lines per iteration: each part is read and XORed 32 bytes at a time,
+// and the two sectors go to consecutive lines
+__attribute__((target("avx2")))
+void combineRaidLinesAvx2(byte* dest, const byte* const parts[RAIDPARTS], unsigned missing, size_t lines)
+{
+    size_t end = (lines & ~size_t(1)) * RAIDSECTOR;
+    size_t i = 0;
+    if (!missing)
+    {
+        // the parity part may be null when all the data parts are present
+        for (; i < end; i += 2 * RAIDSECTOR, dest += 2 * RAIDLINE)
+        {
+            for (unsigned j = 1; j < RAIDPARTS; ++j)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(parts[j] + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + (j - 1) * RAIDSECTOR), _mm256_castsi256_si128(v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + RAIDLINE + (j - 1) * RAIDSECTOR), _mm256_extracti128_si256(v, 1));
+            }
+        }
+    }
+    else
+    {
+        for (; i < end; i += 2 * RAIDSECTOR, dest += 2 * RAIDLINE)
+        {
+            __m256i parity = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(parts[0] + i));
+            for (unsigned j = 1; j < RAIDPARTS; ++j)
+            {
+                if (j != missing)
+                {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(parts[j] + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + (j - 1) * RAIDSECTOR), _mm256_castsi256_si128(v));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + RAIDLINE + (j - 1) * RAIDSECTOR), _mm256_extracti128_si256(v, 1));
+                    parity = _mm256_xor_si256(parity, v);
+                }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + (missing - 1) * RAIDSECTOR), _mm256_castsi256_si128(parity));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + RAIDLINE + (missing - 1) * RAIDSECTOR), _mm256_extracti128_si256(parity, 1));
+        }
+    }
+
+    if (lines & 1)
+    {
+        const byte* last[RAIDPARTS];
+        for (unsigned j = 0; j < RAIDPARTS; ++j)
+        {
+            last[j] = parts[j] ? parts[j] + i : nullptr;
+        }
+        combineRaidLinesVector(dest, last, missing, 1);
+    }
+}
+
+const bool avx2Available = []()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+#endif
+
+} // namespace
+
+void combineRaidLines(byte* dest, const byte* const parts[RAIDPARTS], size_t lines)
+{
+    unsigned missing = 0;
+    for (unsigned j = 1; j < RAIDPARTS; ++j)
+    {
+        if (!parts[j])
+        {
+            assert(!missing && parts[0]);
+            missing = j;
+        }
+    }
+
+#ifdef MEGA_RAID_AVX2
+    if (avx2Available)
+    {
+        combineRaidLinesAvx2(dest, parts, missing, lines);
+        return;
+    }
+#endif
+    combineRaidLinesVector(dest, parts, missing, lines);
+}
+
+void recoverRaidLines(byte* data, const byte* parity, unsigned missing, size_t lines)
+{
+    assert(missing < EFFECTIVE_RAIDPARTS);
+    for (size_t k = 0; k < lines; ++k, data += RAIDLINE, parity += RAIDSECTOR)
+    {
+        sector_t v = loadSector(parity);
+        for (unsigned j = 0; j < EFFECTIVE_RAIDPARTS; ++j)
+        {
+            if (j != missing)
+            {
+                v = xorSector(v, loadSector(data + j * RAIDSECTOR));
+            }
+        }
+        storeSector(data + missing * RAIDSECTOR, v);
+    }
+}
+
 const unsigned RAID_ACTIVE_CHANNEL_FAIL_THRESHOLD = 5;
 
 struct FaultyServers
@@ -115,7 +284,7 @@ RaidBufferManager::FilePiece::FilePiece()
 
 RaidBufferManager::FilePiece::FilePiece(m_off_t p, size_t len)
     : pos(p)
-    , buf(new byte[len + std::min<size_t>(SymmCipher::BLOCKSIZE, RAIDSECTOR)], 0, len)   // SymmCipher::ctr_crypt requirement: decryption: data must be padded to BLOCKSIZE.  Also make sure we can xor up to RAIDSECTOR more for convenience
+    , buf(BufferPool::instance().acquire(len + std::min<size_t>(SymmCipher::BLOCKSIZE, RAIDSECTOR)), 0, len)   // SymmCipher::ctr_crypt requirement: decryption: data must be padded to BLOCKSIZE.  Also make sure we can xor up to RAIDSECTOR more for convenience
 {
 }
 
@@ -581,7 +750,7 @@ RaidBufferManager::FilePiece* RaidBufferManager::combineRaidParts(size_t partsle
     // usual case, for simple and fast processing: all input buffers are the same size, and aligned, and a multiple of raidsector
     if (partslen > 0)
     {
-        byte* inputbufs[RAIDPARTS];
+        const byte* inputbufs[RAIDPARTS];
         for (unsigned i = RAIDPARTS; i--; )
         {
             FilePiece* inputPiece = raidinputparts[i].front();
@@ -589,51 +758,12 @@ RaidBufferManager::FilePiece* RaidBufferManager::combineRaidParts(size_t partsle
         }
 
         byte* b = result->buf.datastart() + prevleftoverchunk.buf.datalen();
-        byte* endpos = b + partslen * EFFECTIVE_RAIDPARTS;
-
-        for (unsigned i = 0; b < endpos; i += RAIDSECTOR)
-        {
-            for (unsigned j = 1; j < RAIDPARTS; ++j)
-            {
-                assert(b + RAIDSECTOR <= result->buf.datastart() + result->buf.datalen());
-                if (inputbufs[j])
-                {
-                    memcpy(b, inputbufs[j] + i, RAIDSECTOR);
-                }
-                else
-                {
-                    recoverSectorFromParity(b, inputbufs, i);
-                }
-                b += RAIDSECTOR;
-            }
-        }
-        assert(b == endpos);
+        assert(b + partslen * EFFECTIVE_RAIDPARTS <= result->buf.datastart() + result->buf.datalen());
+        combineRaidLines(b, inputbufs, partslen / RAIDSECTOR);
     }
     return result;
 }
 
-void RaidBufferManager::recoverSectorFromParity(byte* dest, byte* inputbufs[], unsigned offset)
-{
-    assert(sizeof(m_off_t)*2 == RAIDSECTOR);
-    bool set = false;
-    for (unsigned i = RAIDPARTS; i--; )
-    {
-        if (inputbufs[i])
-        {
-            if (!set)
-            {
-                memcpy(dest, inputbufs[i] + offset, RAIDSECTOR);
-                set = true;
-            }
-            else
-            {
-                *(m_off_t*)dest ^= *(m_off_t*)(inputbufs[i] + offset);
-                *(m_off_t*)(dest + sizeof(m_off_t)) ^= *(m_off_t*)(inputbufs[i] + offset + sizeof(m_off_t));
-            }
-        }
-    }
-}
-
 void RaidBufferManager::combineLastRaidLine(byte* dest, size_t remainingbytes)
 {
     // we have to be careful to use the right number of bytes from each sector
@@ -1099,15 +1099,15 @@ void RaidReq::procdata(uint8_t part, byte* ptr, m_off_t pos, m_off_t len)
 #endif
                 if (index != -1) // index > 0 && index < RAIDLINE
                 {
-                    auto sectors = reinterpret_cast<raidsector_t*>(mData.get() + (RAIDLINE * mCompleted));
-                    raidsector_t& target = sectors[index - 1];
-
-                    target = reinterpret_cast<raidsector_t*>(mParity.get())[mCompleted];
-                    if (!(mask & (1 << 1))) target ^= sectors[0]; // this method requires source and target are both aligned to their size
-                    if (!(mask & (1 << 2))) target ^= sectors[1];
-                    if (!(mask & (1 << 3))) target ^= sectors[2];
-                    if (!(mask & (1 << 4))) target ^= sectors[3];
-                    if (!(mask & (1 << 5))) target ^= sectors[4];
+                    // the same part is usually missing for a run of lines: recover them at once
+                    m_off_t lines = 1;
+                    while (mCompleted + lines < until && mInvalid[mCompleted + lines] == mask)
+                    {
+                        lines++;
+                    }
+
+                    recoverRaidLines(mData.get() + (RAIDLINE * mCompleted), mParity.get() + (RAIDSECTOR * mCompleted), static_cast<unsigned>(index - 1), static_cast<size_t>(lines));
+                    mCompleted += lines - 1;
                 }
             }
         }
@@ -115,8 +115,8 @@ bool Request::processCmdJSON(Command* cmd, bool couldBeError, JSON& json)
 
 bool Request::processSeqTag(Command* cmd, bool withJSON, bool& parsedOk, bool inSeqTagArray, JSON& processingJson)
 {
-    string st;
-    processingJson.storeobject(&st);
+    std::string_view st;
+    processingJson.storeobject(st);
 
     if (inSeqTagArray)
     {
@@ -414,31 +414,48 @@ void RequestDispatcher::add(Command *c)
     }
 #endif
 
-    if (nextreqs.back().size() >= MAX_COMMANDS)
+    if (mPipelining && c->mIndependent && !c->batchSeparately)
+    {
+        addToQueue(nextIndependentReqs, c);
+    }
+    else
+    {
+        addToQueue(nextreqs, c);
+    }
+}
+
+void RequestDispatcher::addToQueue(deque<Request>& queue, Command* c)
+{
+    if (queue.empty())
+    {
+        queue.push_back(Request());
+    }
+
+    if (queue.back().size() >= MAX_COMMANDS)
     {
         LOG_debug << "Starting an additional Request due to MAX_COMMANDS";
-        nextreqs.push_back(Request());
+        queue.push_back(Request());
     }
-    if (c->batchSeparately && !nextreqs.back().empty())
+    if (c->batchSeparately && !queue.back().empty())
     {
         LOG_debug << "Starting an additional Request for a batch-separately command";
-        nextreqs.push_back(Request());
+        queue.push_back(Request());
     }
 
-    if (!nextreqs.back().empty() && nextreqs.back().mV3 != c->mV3)
+    if (!queue.back().empty() && queue.back().mV3 != c->mV3)
     {
         LOG_debug << "Starting an additional Request for v3 transition " << c->mV3;
-        nextreqs.push_back(Request());
+        queue.push_back(Request());
     }
-    if (nextreqs.back().empty())
+    if (queue.back().empty())
     {
-        nextreqs.back().mV3 = c->mV3;
+        queue.back().mV3 = c->mV3;
     }
 
-    nextreqs.back().add(c);
+    queue.back().add(c);
     if (c->batchSeparately)
     {
-        nextreqs.push_back(Request());
+        queue.push_back(Request());
     }
 }
 
@@ -580,6 +597,10 @@ void RequestDispatcher::clear()
         // we are being called from a command that is in progress (eg. logout) - delay wiping the data structure until that call ends.
         clearWhenSafe = true;
         inflightreq.stopProcessing = true;
+        for (auto& p : pipelinedreqs)
+        {
+            p.req.stopProcessing = true;
+        }
     }
     else
     {
@@ -591,9 +612,134 @@ void RequestDispatcher::clear()
         }
         nextreqs.clear();
         nextreqs.push_back(Request());
+        for (auto& p : pipelinedreqs)
+        {
+            p.req.clear();
+            p.failReason = RETRY_NONE;
+        }
+        for (auto& r : nextIndependentReqs)
+        {
+            r.clear();
+        }
+        nextIndependentReqs.clear();
         processing = false;
         clearWhenSafe = false;
     }
 }
 
+void RequestDispatcher::setPipelining(bool enable)
+{
+    // already queued independent batches are still sent when disabling it
+    mPipelining = enable;
+}
+
+bool RequestDispatcher::pipelining() const
+{
+    return mPipelining;
+}
+
+bool RequestDispatcher::readyToSendPipelined(int channel) const
+{
+    assert(channel >= 0 && channel < MAX_PIPELINED_REQUESTS);
+    const PipelinedRequest& p = pipelinedreqs[channel];
+    if (!p.req.empty())
+    {
+        return p.failReason != RETRY_NONE;
+    }
+
+    // a batch that is still being filled is sent as well, the next commands go to a new one
+    return !nextIndependentReqs.empty() && !nextIndependentReqs.front().empty();
+}
+
+bool RequestDispatcher::readyToSendPipelined() const
+{
+    for (int i = 0; i < MAX_PIPELINED_REQUESTS; ++i)
+    {
+        if (readyToSendPipelined(i))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+string RequestDispatcher::serverrequestPipelined(int channel, bool& v3, MegaClient* client, string& idempotenceId)
+{
+    assert(channel >= 0 && channel < MAX_PIPELINED_REQUESTS);
+    PipelinedRequest& p = pipelinedreqs[channel];
+    if (!p.req.empty() && p.failReason != RETRY_NONE)
+    {
+        // same JSON and idempotence id as the failed attempt
+        LOG_debug << "cs Retrying the pipelined request " << channel << " after code: " << p.failReason;
+    }
+    else
+    {
+        assert(p.req.empty());
+        p.req.swap(nextIndependentReqs.front());
+        nextIndependentReqs.pop_front();
+    }
+    string requestJSON = p.req.get(client, reqid, idempotenceId);
+    v3 = p.req.mV3;
+#ifdef MEGA_MEASURE_CODE
+    csRequestsSent += p.req.size();
+    csBatchesSent += 1;
+#endif
+    p.failReason = RETRY_NONE;
+    return requestJSON;
+}
+
+void RequestDispatcher::serverresponsePipelined(int channel, std::string&& movestring, MegaClient* client)
+{
+    CodeCounter::ScopeTimer ccst(client->performanceStats.csResponseProcessingTime);
+
+    assert(channel >= 0 && channel < MAX_PIPELINED_REQUESTS);
+    Request& req = pipelinedreqs[channel].req;
+#ifdef MEGA_MEASURE_CODE
+    csBatchesReceived += 1;
+    csRequestsCompleted += req.size();
+#endif
+    processing = true;
+    req.serverresponse(std::move(movestring), client);
+    req.process(client);
+    if (!req.empty())
+    {
+        // independent commands don't return seqtags, so there is nothing to wait for
+        LOG_err << "Pipelined request waiting for a seqtag, discarding it";
+        assert(false);
+        req.clear();
+    }
+    processing = false;
+    if (clearWhenSafe)
+    {
+        clear();
+    }
+}
+
+void RequestDispatcher::inflightFailurePipelined(int channel, retryreason_t reason)
+{
+#ifdef MEGA_MEASURE_CODE
+    csBatchesReceived += 1;
+#endif
+    assert(channel >= 0 && channel < MAX_PIPELINED_REQUESTS);
+    assert(!pipelinedreqs[channel].req.empty());
+    assert(reason != RETRY_NONE);
+    pipelinedreqs[channel].failReason = reason;
+}
+
+void RequestDispatcher::servererrorPipelined(int channel, const std::string& e, MegaClient* client)
+{
+    assert(channel >= 0 && channel < MAX_PIPELINED_REQUESTS);
+    Request& req = pipelinedreqs[channel].req;
+    processing = true;
+    req.servererror(e, client);
+    req.process(client);
+    assert(req.empty());
+    pipelinedreqs[channel].failReason = RETRY_NONE;
+    processing = false;
+    if (clearWhenSafe)
+    {
+        clear();
+    }
+}
+
 } // namespace
@@ -176,7 +176,7 @@ bool SyncPath::appendRowNames(const SyncRow& row, FileSystemType filesystemType)
     }
     else if (row.syncNode)
     {
-        cloudPath += row.syncNode->toName_of_localname;
+        cloudPath += row.syncNode->toName_of_localname();
     }
     else if (row.fsNode)
     {
@@ -201,7 +201,7 @@ bool SyncPath::appendRowNames(const SyncRow& row, FileSystemType filesystemType)
     }
     else if (row.syncNode)
     {
-        syncPath += row.syncNode->toName_of_localname;
+        syncPath += row.syncNode->toName_of_localname();
     }
     else if (row.fsNode)
     {
@@ -811,6 +811,61 @@ void Sync::setBackupMonitoring()
     syncs.saveSyncConfig(config);
 }
 
+std::shared_ptr<ScanService::ScanRequest>* Sync::availableGeneralScanSlot()
+{
+    std::shared_ptr<ScanService::ScanRequest>* free = nullptr;
+    size_t inProgress = 0;
+
+    for (auto& request : mActiveScanRequestsGeneral)
+    {
+        if (request && !request->completed())
+        {
+            ++inProgress;
+        }
+        else if (!free)
+        {
+            free = &request;
+        }
+    }
+
+    if (inProgress >= ScanService::numThreads())
+    {
+        return nullptr;
+    }
+
+    if (!free)
+    {
+        mActiveScanRequestsGeneral.emplace_back();
+        free = &mActiveScanRequestsGeneral.back();
+    }
+
+    return free;
+}
+
+bool Sync::generalScanSlotsFull() const
+{
+    auto inProgress = std::count_if(mActiveScanRequestsGeneral.begin(), mActiveScanRequestsGeneral.end(),
+        [](const std::shared_ptr<ScanService::ScanRequest>& request) { return request && !request->completed(); });
+
+    return size_t(inProgress) >= ScanService::numThreads();
+}
+
+bool Sync::hasGeneralScanRequests() const
+{
+    return std::any_of(mActiveScanRequestsGeneral.begin(), mActiveScanRequestsGeneral.end(),
+        [](const std::shared_ptr<ScanService::ScanRequest>& request) { return !!request; });
+}
+
+void Sync::releaseScanSlot(const std::shared_ptr<ScanService::ScanRequest>& request)
+{
+    for (auto& slot : mActiveScanRequestsGeneral)
+    {
+        if (slot == request) slot.reset();
+    }
+
+    if (request == mActiveScanRequestUnscanned) mActiveScanRequestUnscanned.reset();
+}
+
 bool Sync::shouldHaveDatabase() const
 {
     return syncs.mClient.dbaccess && !mUnifiedSync.mConfig.isExternal();
@@ -832,13 +887,12 @@ void Sync::addstatecachechildren(uint32_t parent_dbid, idlocalnode_map* tmap, Lo
     {
         LocalNode* const l = it->second;
 
-        auto preExisting = p->children.find(l->localname);
-        if (preExisting != p->children.end())
+        if (LocalNode* preExisting = p->children.find(l->localname))
         {
             // tidying up from prior versions of the SDK which might have duplicate LocalNodes
-            LOG_debug << "Removing duplicate LocalNode: " << preExisting->second->debugGetParentList();
-            delete preExisting->second;   // also detaches and preps removal from db
-            assert(p->children.find(l->localname) == p->children.end());
+            LOG_debug << "Removing duplicate LocalNode: " << preExisting->debugGetParentList();
+            delete preExisting;   // also detaches and preps removal from db
+            assert(!p->children.find(l->localname));
             // l will be added in its place.  Later entries were the ones used by the old algorithm
         }
 
@@ -1158,9 +1212,8 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             *parent = l;
         }
 
-        localnode_map::iterator it;
-        if ((it = l->children.find(component)) == l->children.end()
-            && (it = l->schildren.find(component)) == l->schildren.end())
+        LocalNode* child = l->children.find(component);
+        if (!child && !(child = l->schildren.find(component)))
         {
             // no full match: store residual path, return NULL with the
             // matching component LocalNode in parent
@@ -1177,7 +1230,7 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             return NULL;
         }
 
-        l = it->second;
+        l = child;
     }
 
     // full match: no residual path, return corresponding LocalNode
@@ -2340,9 +2393,9 @@ bool Sync::checkLocalPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
                     // But for this case we are reusing this existing LocalNode and it may be a folder with children
                     // Those children should be removed, should this whole operation succeed.  Make a list
                     // and remove them if the cloud actions succeed.
-                    for (auto& c : row.syncNode->children)
+                    for (auto* c : row.syncNode->children)
                     {
-                        movePtr->priorChildrenToRemove[c.second->localname] = c.second;
+                        movePtr->priorChildrenToRemove[c->localname] = c;
                     }
                 }
 
@@ -2862,11 +2915,11 @@ bool Sync::checkForCompletedCloudMoveToHere(SyncRow& row, SyncRow& parentRow, Sy
                 // TODO: however, there is a risk of name collisions - probably we should use a multimap for LocalNode::children.
                 for (auto& oldc : moveHerePtr->priorChildrenToRemove)
                 {
-                    for (auto& c : row.syncNode->children)
+                    for (auto* c : row.syncNode->children)
                     {
-                        if (c.first == oldc.first && c.second == oldc.second)
+                        if (c->localname == oldc.first && c == oldc.second)
                         {
-                            delete c.second; // removes itself from the parent map
+                            delete c; // removes itself from the parent map
                             break;
                         }
                     }
@@ -3278,7 +3331,7 @@ bool Sync::checkCloudPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
             childrenToDeleteOnFunctionExit.reset(new LocalNode(this));
             while (!row.syncNode->children.empty())
             {
-                auto* child = row.syncNode->children.begin()->second;
+                auto* child = *row.syncNode->children.begin();
                 child->setnameparent(childrenToDeleteOnFunctionExit.get(), child->localname, child->cloneShortname());
             }
         }
@@ -3345,7 +3398,7 @@ bool Sync::checkCloudPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
                     // Make this new fsNode part of our sync data structure
                     parentRow.fsAddedSiblings.emplace_back(std::move(*fsNode));
                     row.fsNode = &parentRow.fsAddedSiblings.back();
-                    row.syncNode->slocalname = row.fsNode->cloneShortname();
+                    row.syncNode->setnameparent(row.syncNode->parent, row.syncNode->localname, row.fsNode->cloneShortname());
 
                     row.syncNode->setSyncedFsid(row.fsNode->fsid, syncs.localnodeBySyncedFsid, row.fsNode->localname, row.fsNode->cloneShortname());
                     row.syncNode->syncedFingerprint = row.fsNode->fingerprint;
@@ -3446,7 +3499,7 @@ dstime Sync::procscanq()
     assert(syncs.onSyncThread());
     assert(dirnotify.get());
 
-    NotificationDeque& queue = dirnotify->fsEventq;
+    NotificationQueue& queue = dirnotify->fsEventq;
 
     if (queue.empty())
     {
@@ -3456,155 +3509,167 @@ dstime Sync::procscanq()
     LOG_verbose << syncname << "Marking sync tree with filesystem notifications: "
                 << queue.size();
 
-    Notification notification;
+    // Taken in batches so that repeats, common in bulk operations, are only processed once.
+    static const size_t BATCH_SIZE = 1024;
+
+    vector<Notification> batch;
+    auto coalesced = queue.coalescedCount();
     dstime delay = NEVER;
 
-    while (queue.popFront(notification))
+    while (queue.popBatch(batch, BATCH_SIZE))
     {
-        lastFSNotificationTime = syncs.waiter->ds;
-
-        // Skip invalidated notifications.
-        if (notification.invalidated())
+        for (auto& notification : batch)
         {
-            LOG_debug << syncname << "Notification skipped: "
-                      << notification.path;
-            continue;
-        }
+            lastFSNotificationTime = syncs.waiter->ds;
 
-        // Skip notifications from this sync's debris folder.
-        if (notification.fromDebris(*this))
-        {
-            LOG_debug << syncname
-                      << "Debris notification skipped: "
-                      << notification.path;
-            continue;
-        }
-
-        LocalPath remainder;
-        LocalNode* nearest = nullptr;
-        LocalNode* node = notification.localnode;
-
-        // Notify the node or its parent
-        LocalNode* match = localnodebypath(node, notification.path, &nearest, &remainder, false);
-
-        // Check it's not below an excluded path
-        if (nearest && !remainder.empty())
-        {
-            if (nearest->type == TYPE_DONOTSYNC)
+            // Skip invalidated notifications.
+            if (notification.invalidated())
             {
-                SYNC_verbose << "Ignoring notification under do-not-sync node: "
-                             << node->getLocalPath() << string(LocalPath::localPathSeparator_utf8, 1) << notification.path;
+                LOG_debug << syncname << "Notification skipped: "
+                          << notification.path;
                 continue;
             }
 
-            LocalPath firstComponent;
-            size_t index = 0;
-            if (remainder.nextPathComponent(index, firstComponent))
+            // Skip notifications from this sync's debris folder.
+            if (notification.fromDebris(*this))
             {
-                // firstComponent is a folder if has next path component, otherwise it is unknown
-                auto type = remainder.hasNextPathComponent(index) ? FOLDERNODE : TYPE_UNKNOWN;
+                LOG_debug << syncname
+                          << "Debris notification skipped: "
+                          << notification.path;
+                continue;
+            }
 
-                if (!(firstComponent == IGNORE_FILE_NAME) &&
-                    (isDoNotSyncFileName(firstComponent.toPath(false)) ||
-                    ES_EXCLUDED == nearest->exclusionState(firstComponent, type, 0)))
+            LocalPath remainder;
+            LocalNode* nearest = nullptr;
+            LocalNode* node = notification.localnode;
+
+            // Notify the node or its parent
+            LocalNode* match = localnodebypath(node, notification.path, &nearest, &remainder, false);
+
+            // Check it's not below an excluded path
+            if (nearest && !remainder.empty())
+            {
+                if (nearest->type == TYPE_DONOTSYNC)
                 {
-                    // no need to rescan anything when the change was in an excluded folder
-                    SYNC_verbose << "Ignoring notification under excluded/do-not-sync node:"
-                                 << node->getLocalPath() << string(1, LocalPath::localPathSeparator_utf8) << notification.path;;
+                    SYNC_verbose << "Ignoring notification under do-not-sync node: "
+                                 << node->getLocalPath() << string(LocalPath::localPathSeparator_utf8, 1) << notification.path;
                     continue;
                 }
+
+                LocalPath firstComponent;
+                size_t index = 0;
+                if (remainder.nextPathComponent(index, firstComponent))
+                {
+                    // firstComponent is a folder if has next path component, otherwise it is unknown
+                    auto type = remainder.hasNextPathComponent(index) ? FOLDERNODE : TYPE_UNKNOWN;
+
+                    if (!(firstComponent == IGNORE_FILE_NAME) &&
+                        (isDoNotSyncFileName(firstComponent.toPath(false)) ||
+                        ES_EXCLUDED == nearest->exclusionState(firstComponent, type, 0)))
+                    {
+                        // no need to rescan anything when the change was in an excluded folder
+                        SYNC_verbose << "Ignoring notification under excluded/do-not-sync node:"
+                                     << node->getLocalPath() << string(1, LocalPath::localPathSeparator_utf8) << notification.path;;
+                        continue;
+                    }
+                }
             }
-        }
 
-        bool scanDescendants = false;
+            bool scanDescendants = false;
 
-        // figure out which node we are going to scan.  'nearest' will be assigned the one (or it is already)
-        if (match)
-        {
-            if (match->type == FILENODE)
+            // figure out which node we are going to scan.  'nearest' will be assigned the one (or it is already)
+            if (match)
             {
-                // the node was a file, so it's always the parent that needs scanning so we see the
-                // updated file metadata in the directory entry.  Additionally, re-fingerprint to detect data change
-                match->recomputeFingerprint = true;
-                nearest = match->parent;
-                if (!nearest) continue;
+                if (match->type == FILENODE)
+                {
+                    // the node was a file, so it's always the parent that needs scanning so we see the
+                    // updated file metadata in the directory entry.  Additionally, re-fingerprint to detect data change
+                    match->recomputeFingerprint = true;
+                    nearest = match->parent;
+                    if (!nearest) continue;
+                }
+                else
+                {
+                    // we found the exact node specified, recursion on request makes sense
+                    scanDescendants = notification.scanRequirement == Notification::FOLDER_NEEDS_SCAN_RECURSIVE;
+
+                    // for a folder path, we support either path specified (entries added/removed)
+                    // or the parent (eg access changed), depending on flags passed from platform layer
+                    nearest = match->parent && notification.scanRequirement == Notification::NEEDS_PARENT_SCAN
+                            ? match->parent
+                            : match;
+
+                }
             }
             else
             {
-                // we found the exact node specified, recursion on request makes sense
-                scanDescendants = notification.scanRequirement == Notification::FOLDER_NEEDS_SCAN_RECURSIVE;
-
-                // for a folder path, we support either path specified (entries added/removed)
-                // or the parent (eg access changed), depending on flags passed from platform layer
-                nearest = match->parent && notification.scanRequirement == Notification::NEEDS_PARENT_SCAN
-                        ? match->parent
-                        : match;
+                // we didn't find the exact path specified. But, if we are only one layer up
+                // and we would have scanned parent anyway (ie, file or NEEDS_PARENT_SCAN), then it's equivalent
+                // if we are higher up the tree than that, it's again the same
+                // basically, scan the folder we can determine this notification is below: nearest.
 
+                if (nearest && nearest->type == FILENODE)
+                {
+                    nearest->recomputeFingerprint = true;
+                    nearest = nearest->parent;
+                    assert(nearest && nearest->type != FILENODE);
+                }
             }
-        }
-        else
-        {
-            // we didn't find the exact path specified. But, if we are only one layer up
-            // and we would have scanned parent anyway (ie, file or NEEDS_PARENT_SCAN), then it's equivalent
-            // if we are higher up the tree than that, it's again the same
-            // basically, scan the folder we can determine this notification is below: nearest.
 
-            if (nearest && nearest->type == FILENODE)
+            if (!nearest)
             {
-                nearest->recomputeFingerprint = true;
-                nearest = nearest->parent;
-                assert(nearest && nearest->type != FILENODE);
+                // we didn't find any suitable ancestor within the sync
+                LOG_debug << "Notification had no scannable result:"  << node->getLocalPath() << " " << notification.path;;
+                continue;
             }
-        }
-
-        if (!nearest)
-        {
-            // we didn't find any suitable ancestor within the sync
-            LOG_debug << "Notification had no scannable result:"  << node->getLocalPath() << " " << notification.path;;
-            continue;
-        }
 
-        if (nearest->expectedSelfNotificationCount > 0)
-        {
-            if (nearest->scanDelayUntil >= syncs.waiter->ds)
+            if (nearest->expectedSelfNotificationCount > 0)
             {
-                // self-caused notifications shouldn't cause extra waiting
-                --nearest->expectedSelfNotificationCount;
+                if (nearest->scanDelayUntil >= syncs.waiter->ds)
+                {
+                    // self-caused notifications shouldn't cause extra waiting
+                    --nearest->expectedSelfNotificationCount;
 
-                SYNC_verbose << "Skipping self-notification (remaining: "
-                    << nearest->expectedSelfNotificationCount << ") at: "
-                    << nearest->getLocalPath();
+                    SYNC_verbose << "Skipping self-notification (remaining: "
+                        << nearest->expectedSelfNotificationCount << ") at: "
+                        << nearest->getLocalPath();
 
-                continue;
+                    continue;
+                }
+                else
+                {
+                    SYNC_verbose << "Expected more self-notifications ("
+                        << nearest->expectedSelfNotificationCount << ") but they were late, at: "
+                        << nearest->getLocalPath();
+                    nearest->expectedSelfNotificationCount = 0;
+                }
             }
-            else
+
+            // Let the parent know it needs to perform a scan.
+            //if (nearest->scanAgain < TREE_ACTION_HERE)
             {
-                SYNC_verbose << "Expected more self-notifications ("
-                    << nearest->expectedSelfNotificationCount << ") but they were late, at: "
-                    << nearest->getLocalPath();
-                nearest->expectedSelfNotificationCount = 0;
+                SYNC_verbose << "Trigger scan flag by fs notification on "
+                             << nearest->getLocalPath()
+                             << (scanDescendants ? " (recursive)" : "");
             }
-        }
 
-        // Let the parent know it needs to perform a scan.
-        //if (nearest->scanAgain < TREE_ACTION_HERE)
-        {
-            SYNC_verbose << "Trigger scan flag by fs notification on "
-                         << nearest->getLocalPath()
-                         << (scanDescendants ? " (recursive)" : "");
-        }
+            nearest->setScanAgain(false, true, scanDescendants, SCANNING_DELAY_DS);
 
-        nearest->setScanAgain(false, true, scanDescendants, SCANNING_DELAY_DS);
+            if (nearest->rareRO().scanBlocked)
+            {
+                // in case permissions changed on a scan-blocked folder
+                // retry straight away, but don't reset the backoff delay
+                nearest->rare().scanBlocked->scanBlockedTimer.set(syncs.waiter->ds);
+            }
 
-        if (nearest->rareRO().scanBlocked)
-        {
-            // in case permissions changed on a scan-blocked folder
-            // retry straight away, but don't reset the backoff delay
-            nearest->rare().scanBlocked->scanBlockedTimer.set(syncs.waiter->ds);
+            // How long the caller should wait before syncing.
+            delay = SCANNING_DELAY_DS;
         }
+    }
 
-        // How long the caller should wait before syncing.
-        delay = SCANNING_DELAY_DS;
+    if (auto repeats = queue.coalescedCount() - coalesced)
+    {
+        LOG_verbose << syncname << "Repeated filesystem notifications skipped: " << repeats;
     }
 
     return delay;
@@ -4407,8 +4472,8 @@ void Syncs::getSyncStatusInfoInThread(handle backupID,
                 info.mTotalSyncedBytes += node.syncedFingerprint.size;
 
             // Process children, if any.
-            for (auto& childIt : node.children)
-                tally(info, *childIt.second);
+            for (auto* child : node.children)
+                tally(info, *child);
         }
 
         const Sync& mSync;
@@ -6781,20 +6846,19 @@ void SyncRow::inferOrCalculateChildSyncRows(bool wasSynced, vector<SyncRow>& chi
             // Otherwise, we can reconstruct the filesystem entries from the LocalNodes
             fsChildren.reserve(syncNode->children.size() + 50);  // leave some room for others to be added in syncItem()
 
-            for (auto &childIt : syncNode->children)
+            for (auto* child : syncNode->children)
             {
-                assert(childIt.first == childIt.second->localname);
                 if (belowRemovedFsNode)
                 {
-                    if (childIt.second->fsid_asScanned != UNDEF)
+                    if (child->fsid_asScanned != UNDEF)
                     {
-                        childIt.second->setScannedFsid(UNDEF, localnodeByScannedFsid, LocalPath(), FileFingerprint());
-                        childIt.second->scannedFingerprint = FileFingerprint();
+                        child->setScannedFsid(UNDEF, localnodeByScannedFsid, LocalPath(), FileFingerprint());
+                        child->scannedFingerprint = FileFingerprint();
                     }
                 }
-                else if (childIt.second->fsid_asScanned != UNDEF)
+                else if (child->fsid_asScanned != UNDEF)
                 {
-                    fsChildren.emplace_back(childIt.second->getScannedFSDetails());
+                    fsChildren.emplace_back(child->getScannedFSDetails());
                 }
             }
 
@@ -7234,7 +7298,7 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
     triplets.reserve(cloudNodes.size() + syncParent.children.size() + fsNodes.size());
 
     for (auto& cn : cloudNodes)          triplets.emplace_back(&cn, nullptr, nullptr);
-    for (auto& sn : syncParent.children) triplets.emplace_back(nullptr, sn.second, nullptr);
+    for (auto* sn : syncParent.children) triplets.emplace_back(nullptr, sn, nullptr);
     for (auto& fsn : fsNodes)            triplets.emplace_back(nullptr, nullptr, &fsn);
 
     auto tripletCompare = [this](const SyncRow& lhs, const SyncRow& rhs) -> int {
@@ -7259,7 +7323,7 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
             }
             else if (rhs.syncNode)
             {
-                return compareUtf(lhs.cloudNode->name, true, rhs.syncNode->toName_of_localname, false, mCaseInsensitive);
+                return compareUtf(lhs.cloudNode->name, true, rhs.syncNode->toName_of_localname(), false, mCaseInsensitive);
             }
             else // rhs.fsNode
             {
@@ -7270,15 +7334,15 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
         {
             if (rhs.cloudNode)
             {
-                return compareUtf(lhs.syncNode->toName_of_localname, false, rhs.cloudNode->name, true, mCaseInsensitive);
+                return compareUtf(lhs.syncNode->toName_of_localname(), false, rhs.cloudNode->name, true, mCaseInsensitive);
             }
             else if (rhs.syncNode)
             {
-                return compareUtf(lhs.syncNode->toName_of_localname, false, rhs.syncNode->toName_of_localname, false, mCaseInsensitive);
+                return compareUtf(lhs.syncNode->toName_of_localname(), false, rhs.syncNode->toName_of_localname(), false, mCaseInsensitive);
             }
             else // rhs.fsNode
             {
-                return compareUtf(lhs.syncNode->toName_of_localname, false, rhs.fsNode->toName_of_localname(*syncs.fsaccess), false, mCaseInsensitive);
+                return compareUtf(lhs.syncNode->toName_of_localname(), false, rhs.fsNode->toName_of_localname(*syncs.fsaccess), false, mCaseInsensitive);
             }
         }
         else // lhs.fsNode
@@ -7289,7 +7353,7 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
             }
             else if (rhs.syncNode)
             {
-                return compareUtf(lhs.fsNode->toName_of_localname(*syncs.fsaccess), false, rhs.syncNode->toName_of_localname, false, mCaseInsensitive);
+                return compareUtf(lhs.fsNode->toName_of_localname(*syncs.fsaccess), false, rhs.syncNode->toName_of_localname(), false, mCaseInsensitive);
             }
             else // rhs.fsNode
             {
@@ -7339,11 +7403,11 @@ bool Sync::inferRegeneratableTriplets(vector<CloudNode>& cloudChildren, const Lo
     auto cloudHandleLess = [](const CloudNode& a, const CloudNode& b){ return a.handle < b.handle; };
     std::sort(cloudChildren.begin(), cloudChildren.end(), cloudHandleLess);
 
-    for (auto& child : syncParent.children)
+    for (auto* child : syncParent.children)
     {
 
         CloudNode compareTo;
-        compareTo.handle = child.second->syncedCloudNodeHandle;
+        compareTo.handle = child->syncedCloudNodeHandle;
         auto iters = std::equal_range(cloudChildren.begin(), cloudChildren.end(), compareTo, cloudHandleLess);
 
         if (std::distance(iters.first, iters.second) != 1)
@@ -7361,15 +7425,15 @@ bool Sync::inferRegeneratableTriplets(vector<CloudNode>& cloudChildren, const Lo
             return false;
         }
 
-        if (child.second->fsid_asScanned == UNDEF ||
-           (!child.second->scannedFingerprint.isvalid && child.second->type == FILENODE))
+        if (child->fsid_asScanned == UNDEF ||
+           (!child->scannedFingerprint.isvalid && child->type == FILENODE))
         {
             // we haven't scanned yet, or the scans don't match up with LocalNodes yet
             return false;
         }
 
-        inferredFsNodes.push_back(child.second->getScannedFSDetails());
-        inferredRows.emplace_back(node, child.second, &inferredFsNodes.back());
+        inferredFsNodes.push_back(child->getScannedFSDetails());
+        inferredRows.emplace_back(node, child, &inferredFsNodes.back());
     }
     return true;
 }
@@ -7497,12 +7561,14 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
             row.syncNode->fsid_asScanned != row.fsNode->fsid)
         {
             row.syncNode->scanAgain = TREE_ACTION_HERE;
-            row.syncNode->setScannedFsid(row.fsNode->fsid, syncs.localnodeByScannedFsid, row.fsNode->localname, row.fsNode->fingerprint);
+            row.syncNode->setScannedFsid(row.fsNode->fsid, syncs.localnodeByScannedFsid, row.fsNode->localname, row.fsNode->fingerprint, row.fsNode->ctime);
         }
-        else if (row.syncNode->scannedFingerprint != row.fsNode->fingerprint)
+        else if (row.syncNode->scannedFingerprint != row.fsNode->fingerprint
+                 || row.syncNode->scannedCtime != row.fsNode->ctime)
         {
             // this can change anytime, set it anyway
             row.syncNode->scannedFingerprint = row.fsNode->fingerprint;
+            row.syncNode->scannedCtime = row.fsNode->ctime;
         }
     }
 
@@ -7702,12 +7768,14 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
                             if (s->fsid_asScanned != f->fsid)
                             {
                                 syncs.setScannedFsidReused(fsfp(), f->fsid);
-                                s->setScannedFsid(f->fsid, syncs.localnodeByScannedFsid, f->localname, f->fingerprint);
+                                s->setScannedFsid(f->fsid, syncs.localnodeByScannedFsid, f->localname, f->fingerprint, f->ctime);
                             }
-                            else if (s->scannedFingerprint != f->fingerprint)
+                            else if (s->scannedFingerprint != f->fingerprint
+                                     || s->scannedCtime != f->ctime)
                             {
                                 // Maintain the scanned fingerprint.
                                 s->scannedFingerprint = f->fingerprint;
+                                s->scannedCtime = f->ctime;
                             }
                         }
 
@@ -7729,9 +7797,9 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
                                 LOG_debug << syncname << "Removing " << s->children.size() << " child LocalNodes from excluded " << s->getLocalPath();
                                 vector<LocalNode*> cs;
                                 cs.reserve(s->children.size());
-                                for (auto& i : s->children)
+                                for (auto* i : s->children)
                                 {
-                                    cs.push_back(i.second);
+                                    cs.push_back(i);
                                 }
                                 // this technique might seem a bit roundabout, but deletion will cause these to
                                 // remove themselves from s->children. // we can't have that happening while we iterate that map.
@@ -7929,29 +7997,29 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
     // Flags for this row could have been set during calls to the node
     // If we skipped a child node this time (or if not), the set-parent
     // flags let us know if future actions are needed at this level
-    for (auto& child : row.syncNode->children)
+    for (auto* child : row.syncNode->children)
     {
-        assert(child.first == child.second->localname);
+        assert(row.syncNode->children.find(child->localname) == child);
 
-        if (child.second->exclusionState() == ES_EXCLUDED)
+        if (child->exclusionState() == ES_EXCLUDED)
         {
             continue;
         }
 
-        if (child.second->type > FILENODE)
+        if (child->type > FILENODE)
         {
-            row.syncNode->scanAgain = updateTreestateFromChild(row.syncNode->scanAgain, child.second->scanAgain);
-            row.syncNode->syncAgain = updateTreestateFromChild(row.syncNode->syncAgain, child.second->syncAgain);
+            row.syncNode->scanAgain = updateTreestateFromChild(row.syncNode->scanAgain, child->scanAgain);
+            row.syncNode->syncAgain = updateTreestateFromChild(row.syncNode->syncAgain, child->syncAgain);
         }
-        row.syncNode->checkMovesAgain = updateTreestateFromChild(row.syncNode->checkMovesAgain, child.second->checkMovesAgain);
-        row.syncNode->conflicts = updateTreestateFromChild(row.syncNode->conflicts, child.second->conflicts);
+        row.syncNode->checkMovesAgain = updateTreestateFromChild(row.syncNode->checkMovesAgain, child->checkMovesAgain);
+        row.syncNode->conflicts = updateTreestateFromChild(row.syncNode->conflicts, child->conflicts);
 
-        if (child.second->parentSetScanAgain) row.syncNode->setScanAgain(false, true, false, 0);
-        if (child.second->parentSetCheckMovesAgain) row.syncNode->setCheckMovesAgain(false, true, false);
-        if (child.second->parentSetSyncAgain) row.syncNode->setSyncAgain(false, true, false);
-        if (child.second->parentSetContainsConflicts) row.syncNode->setContainsConflicts(false, true, false);
+        if (child->parentSetScanAgain) row.syncNode->setScanAgain(false, true, false, 0);
+        if (child->parentSetCheckMovesAgain) row.syncNode->setCheckMovesAgain(false, true, false);
+        if (child->parentSetSyncAgain) row.syncNode->setSyncAgain(false, true, false);
+        if (child->parentSetContainsConflicts) row.syncNode->setContainsConflicts(false, true, false);
 
-        child.second->parentSetScanAgain = false;  // we should only use this one once
+        child->parentSetScanAgain = false;  // we should only use this one once
     }
 
     // keep sync overlay icons up to date as we recurse (including the sync root node)
@@ -8432,7 +8500,7 @@ bool Sync::syncItem_checkDownloadCompletion(SyncRow& row, SyncRow& parentRow, Sy
                 // Make this new fsNode part of our sync data structure
                 parentRow.fsAddedSiblings.emplace_back(std::move(*fsNode));
                 row.fsNode = &parentRow.fsAddedSiblings.back();
-                row.syncNode->slocalname = row.fsNode->cloneShortname();
+                row.syncNode->setnameparent(row.syncNode->parent, row.syncNode->localname, row.fsNode->cloneShortname());
             }
             else
             {
@@ -8718,9 +8786,9 @@ bool Sync::syncItem(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath, PerFol
                     LOG_debug << syncname << "syncItem removing child LocalNodes from excluded " << s->getLocalPath();
                     vector<LocalNode*> cs;
                     cs.resize(s->children.size());
-                    for (auto& i : s->children)
+                    for (auto* i : s->children)
                     {
-                        cs.push_back(i.second);
+                        cs.push_back(i);
                     }
                     for (auto p : cs)
                     {
@@ -9223,11 +9291,11 @@ bool Sync::resolve_checkMoveComplete(SyncRow& row, SyncRow& parentRow, SyncPath&
         // TODO: however, there is a risk of name collisions - probably we should use a multimap for LocalNode::children.
         for (auto& oldc : movePtr->priorChildrenToRemove)
         {
-            for (auto& c : row.syncNode->children)
+            for (auto* c : row.syncNode->children)
             {
-                if (c.first == oldc.first && c.second == oldc.second)
+                if (c->localname == oldc.first && c == oldc.second)
                 {
-                    delete c.second; // removes itself from the parent map
+                    delete c; // removes itself from the parent map
                     break;
                 }
             }
@@ -9365,7 +9433,7 @@ bool Sync::makeSyncNode_fromFS(SyncRow& row, SyncRow& parentRow, SyncPath& fullP
     row.syncNode = new LocalNode(this);
 
     row.syncNode->init(row.fsNode->type, parentRow.syncNode, fullPath.localPath, row.fsNode->cloneShortname());
-    row.syncNode->setScannedFsid(row.fsNode->fsid, syncs.localnodeByScannedFsid, row.fsNode->localname, row.fsNode->fingerprint);
+    row.syncNode->setScannedFsid(row.fsNode->fsid, syncs.localnodeByScannedFsid, row.fsNode->localname, row.fsNode->fingerprint, row.fsNode->ctime);
 
     if (row.fsNode->type == FILENODE)
     {
@@ -9876,7 +9944,7 @@ bool Sync::resolve_upsync(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath,
             if (parentRow.cloudNode)
             {
                 // there can't be a matching cloud node in this row (for folders), so just toName() is correct
-                string foldername = row.syncNode->toName_of_localname;
+                string foldername = row.syncNode->toName_of_localname();
 
                 LOG_verbose << syncname << "Creating cloud node for: " << fullPath.localPath << " as " << foldername << logTriplet(row, fullPath);
                 // while the operation is in progress sync() will skip over the parent folder
@@ -10087,13 +10155,13 @@ bool Sync::resolve_downsync(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath
                     syncs.setSyncedFsidReused(fsfp(), fsnode->fsid);
                     syncs.setScannedFsidReused(fsfp(), fsnode->fsid);
 
-                    row.syncNode->localname = fsnode->localname;
-                    row.syncNode->slocalname = fsnode->cloneShortname();
+                    // through setnameparent() so the parent's child tables follow the new names
+                    row.syncNode->setnameparent(row.syncNode->parent, fsnode->localname, fsnode->cloneShortname());
 
 					// setting synced variables here means we can skip a scan of the parent folder, if just the one expected notification arrives for it
                     row.syncNode->setSyncedNodeHandle(row.cloudNode->handle);
                     row.syncNode->setSyncedFsid(fsnode->fsid, syncs.localnodeBySyncedFsid, fsnode->localname, fsnode->cloneShortname());
-					row.syncNode->setScannedFsid(fsnode->fsid, syncs.localnodeByScannedFsid, fsnode->localname, fsnode->fingerprint);
+					row.syncNode->setScannedFsid(fsnode->fsid, syncs.localnodeByScannedFsid, fsnode->localname, fsnode->fingerprint, fsnode->ctime);
                     statecacheadd(row.syncNode);
 
                     // So that we can recurse into the new directory immediately.
@@ -12404,7 +12472,8 @@ void Syncs::syncLoop()
                         // Then issue a full scan.
                         LOG_err << "Sync "
                                 << toHandle(sync->getConfig().mBackupId)
-                                << " had a filesystem notification buffer overflow. Triggering full scan.";
+                                << " had a filesystem notification buffer overflow. Triggering full scan."
+                                << " Notifications dropped so far: " << notifier->fsEventq.droppedCount();
 
                         // Reset the error counter.
                         notifier->mErrorCount.store(0);
@@ -12448,15 +12517,14 @@ void Syncs::syncLoop()
                 }
 
                 {
-                    bool activeIncomplete = sync->mActiveScanRequestGeneral &&
-                        !sync->mActiveScanRequestGeneral->completed();
+                    bool activeIncomplete = sync->generalScanSlotsFull();
 
                     bool unscannedIncomplete = sync->mActiveScanRequestUnscanned &&
                         !sync->mActiveScanRequestUnscanned->completed();
 
                     if ((activeIncomplete && unscannedIncomplete) ||
                         (activeIncomplete && sync->threadSafeState->neverScannedFolderCount.load() == 0) ||
-                        (unscannedIncomplete && !sync->mActiveScanRequestGeneral))
+                        (unscannedIncomplete && !sync->hasGeneralScanRequests()))
                     {
                         // Save CPU by not starting another recurse of the LocalNode tree
                         // if a scan is not finished yet.  Scans can take a fair while for large
@@ -13046,11 +13114,10 @@ void Syncs::proclocaltree(LocalNode* n, LocalTreeProc* tp)
 
     if (n->type > FILENODE)
     {
-        for (localnode_map::iterator it = n->children.begin(); it != n->children.end(); )
+        // the procedure may remove the child from the table, so don't iterate the table itself
+        vector<LocalNode*> children(n->children.begin(), n->children.end());
+        for (LocalNode* child : children)
         {
-            assert(it->first == it->second->localname);
-            LocalNode *child = it->second;
-            it++;
             proclocaltree(child, tp);
         }
     }
@@ -13182,7 +13249,18 @@ bool Syncs::lookupCloudChildren(NodeHandle h, vector<CloudNode>& cloudChildren)
     // so we use the mutex to prevent access during that time - which is only actionpacket processing.
     assert(onSyncThread());
 
+    // folders visited again, and not changed since, don't need their child Nodes
+    // (nor the mutex: the cache has its own, and holds copies taken before any change)
+    auto& cache = mClient.mNodeManager.cloudChildrenCache();
+    if (cache.get(h, cloudChildren))
+    {
+        return true;
+    }
+
     lock_guard<mutex> g(mClient.nodeTreeMutex);
+
+    auto generation = cache.generation();
+
     if (std::shared_ptr<Node> n = mClient.mNodeManager.getNodeByHandle(h))
     {
         assert(n->type > FILENODE);
@@ -13196,6 +13274,8 @@ bool Syncs::lookupCloudChildren(NodeHandle h, vector<CloudNode>& cloudChildren)
             cloudChildren.push_back(*c);
             assert(cloudChildren.back().parentHandle == h);
         }
+
+        cache.put(h, cloudChildren, generation);
         return true;
     }
     return false;
@@ -13233,7 +13313,7 @@ bool Syncs::isDefinitelyExcluded(const pair<std::shared_ptr<Node>, Sync*>& root,
             break;
 
         // Name doesn't match so we'll have to check by remote path.
-        if (node->toName_of_localname != i->second)
+        if (node->toName_of_localname() != i->second)
             break;
 
         // Children are definitely excluded if their parent is.
@@ -73,6 +73,10 @@ const m_off_t TransferSlot::UPPER_FILESIZE_LIMIT_FOR_SMALLER_CHUNKS = 25 * 1024
 const m_off_t TransferSlot::MIN_FILESIZE_FOR_MULTIPLE_CONNECTIONS = 131072 + 1; // 128 KB + 1 -> legacy value
 const m_off_t TransferSlot::MAX_GAP_SIZE = 256 * 1024 * 1024; // 256 MB
 
+const dstime TransferConnectionController::EVALUATION_PERIOD = 50; // 5 seconds
+const unsigned TransferConnectionController::HOLD_PERIODS = 12;
+const m_off_t TransferConnectionController::REQUEST_SECONDS = 4;
+
 TransferSlot::TransferSlot(Transfer* ctransfer)
     : fa(ctransfer->client->fsaccess->newfileaccess(), ctransfer)
     , retrybt(ctransfer->client->rng, ctransfer->client->transferSlotsBackoff)
@@ -155,10 +159,20 @@ bool TransferSlot::createconnectionsonce()
             DEBUG_TEST_HOOK_NUMBER_OF_CONNECTIONS(connections, transfer->client->connections[transfer->type])
         }
 #endif
-        LOG_debug << "Populating transfer slot with " << connections << " connections, max request size of " << maxRequestSize << " bytes [transferbuf.isNewRaid() = " << transferbuf.isNewRaid() << "] [isDownload = " << (transfer->type == GET) << "]";
-        reqs.resize(connections);
-        mReqSpeeds.resize(connections);
-        asyncIO = new AsyncIOContext*[connections]();
+        // the connections of an adaptive slot vary up to the maximum, so there is room for all of them from the start
+        int maxConnections = connections;
+        if (transfer->client->adaptiveconnections && !transferbuf.isRaid() && !transferbuf.isNewRaid()
+                && transfer->size >= MIN_FILESIZE_FOR_MULTIPLE_CONNECTIONS)
+        {
+            maxConnections = std::max<int>(connections, MegaClient::MAX_NUM_CONNECTIONS);
+            mConnectionController = std::make_unique<TransferConnectionController>(connections, 1, maxConnections,
+                                                                                   maxRequestSize, std::min<m_off_t>(1024 * 1024, maxRequestSize), maxRequestSize);
+        }
+
+        LOG_debug << "Populating transfer slot with " << connections << " connections" << (mConnectionController ? " (adaptive)" : "") << ", max request size of " << maxRequestSize << " bytes [transferbuf.isNewRaid() = " << transferbuf.isNewRaid() << "] [isDownload = " << (transfer->type == GET) << "]";
+        reqs.resize(maxConnections);
+        mReqSpeeds.resize(maxConnections);
+        asyncIO = new AsyncIOContext*[maxConnections]();
 
         if (transferbuf.isNewRaid())
         {
@@ -1066,6 +1080,11 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 
                 case REQ_FAILURE:
                     {
+                        if (mConnectionController)
+                        {
+                            mConnectionController->requestFailed();
+                        }
+
                         auto failValue = processRequestFailure(client, reqs[i], backoff, i);
                         if (failValue.first != API_OK)
                         {
@@ -1242,6 +1261,12 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
             {
                 if (reqs[i]->status == REQ_PREPARED)
                 {
+                    // the previous request of this connection is over
+                    if (mConnectionController && mReqSpeeds[i].lastRequestMeanSpeed() > 0)
+                    {
+                        mConnectionController->requestFinished(mReqSpeeds[i].lastRequestMeanSpeed(), mReqSpeeds[i].requestLatencyDs());
+                    }
+
                     mReqSpeeds[i].requestStarted();
                     reqs[i]->minspeed = true;
 
@@ -1337,6 +1362,8 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
         progress();
     }
 
+    adaptConnections(client);
+
     assert(lastdata != NEVER);
     if (Waiter::ds - lastdata >= XFERTIMEOUT && !failure)
     {
@@ -1396,6 +1423,46 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 }
 
 
+void TransferSlot::adaptConnections(MegaClient* client)
+{
+    if (!mConnectionController)
+    {
+        return;
+    }
+
+    TransferConnectionController::Stats before = mConnectionController->stats();
+    if (mConnectionController->evaluate(speed, Waiter::ds))
+    {
+        const TransferConnectionController::Stats& after = mConnectionController->stats();
+        client->performanceStats.transferConnectionsAdded += after.connectionsAdded - before.connectionsAdded;
+        client->performanceStats.transferConnectionsRemoved += after.connectionsRemoved - before.connectionsRemoved;
+        client->performanceStats.transferRequestSizeChanges += after.requestSizeChanges - before.requestSizeChanges;
+
+        maxRequestSize = mConnectionController->requestSize();
+
+        LOG_debug << "Adapting transfer slot to " << mConnectionController->connections() << " connections (currently " << connections
+                  << "), max request size of " << maxRequestSize << " bytes. Speed: " << (speed / 1024) << " KB/s";
+    }
+
+    // new connections start on the next doio(), removed ones must finish their request first (the last one is removed each time)
+    connections = std::max(connections, mConnectionController->connections());
+    while (connections > mConnectionController->connections())
+    {
+        int last = connections - 1;
+        if (reqs[last])
+        {
+            if ((reqs[last]->status != REQ_READY && reqs[last]->status != REQ_DONE)
+                    || asyncIO[last] || transferbuf.getAsyncOutputBufferPointer(static_cast<unsigned>(last)))
+            {
+                break;
+            }
+            reqs[last].reset();
+        }
+        mReqSpeeds[last] = SpeedController();
+        connections--;
+    }
+}
+
 bool TransferSlot::tryRaidRecoveryFromHttpGetError(unsigned connectionNum, bool incrementErrors)
 {
     // If we are downloding a cloudraid file then we may be able to ignore one connection and download from the other 5.
@@ -1644,4 +1711,133 @@ std::pair<error, dstime> TransferSlot::processRaidReq(size_t connection, m_off_t
     return cloudRaid->checkTransferFailure();
 }
 
+TransferConnectionController::TransferConnectionController(int connections, int minConnections, int maxConnections,
+                                                           m_off_t requestSize, m_off_t minRequestSize, m_off_t maxRequestSize)
+    : mConnections(connections)
+    , mMinConnections(minConnections)
+    , mMaxConnections(maxConnections)
+    , mRequestSize(requestSize)
+    , mMinRequestSize(minRequestSize)
+    , mMaxRequestSize(maxRequestSize)
+{
+    assert(minConnections <= connections && connections <= maxConnections);
+    assert(minRequestSize <= requestSize && requestSize <= maxRequestSize);
+}
+
+void TransferConnectionController::requestFinished(m_off_t speed, dstime latency)
+{
+    ++mSamples;
+    mSpeedSum += speed;
+    mLatencySum += latency;
+}
+
+void TransferConnectionController::requestFailed()
+{
+    ++mFailures;
+}
+
+bool TransferConnectionController::evaluate(m_off_t transferSpeed, dstime now)
+{
+    if (mPeriodStart == NEVER)
+    {
+        mPeriodStart = now;
+        return false;
+    }
+
+    if (now - mPeriodStart < EVALUATION_PERIOD)
+    {
+        return false;
+    }
+
+    dstime latency = mSamples ? mLatencySum / mSamples : 0;
+    if (mSamples && (mMinLatency == NEVER || latency < mMinLatency))
+    {
+        mMinLatency = latency;
+    }
+
+    // hill climbing on the speed of the transfer: a connection is added (or removed) in a period,
+    // and the change is kept in the next one if the speed increased (or didn't decrease)
+    int connections = mConnections;
+    int probe = 0;
+    if (mFailures && mFailures * 4 >= mSamples + mFailures)
+    {
+        // at least a quarter of the requests failed
+        --connections;
+        mNextProbe = -1;
+        mHoldPeriods = HOLD_PERIODS;
+    }
+    else if (mProbe > 0 && transferSpeed < mSpeedBeforeProbe + mSpeedBeforeProbe / 10)
+    {
+        // the new connection didn't increase the speed by 10%, try with fewer
+        --connections;
+        mNextProbe = -1;
+    }
+    else if (mProbe < 0 && transferSpeed < mSpeedBeforeProbe - mSpeedBeforeProbe / 10)
+    {
+        // the removed connection was needed
+        ++connections;
+        mNextProbe = 1;
+        mHoldPeriods = HOLD_PERIODS;
+    }
+    else if (mSamples && latency > 4 * std::max<dstime>(mMinLatency, 1))
+    {
+        // the requests are being queued: the link is already saturated
+        --connections;
+        mNextProbe = -1;
+        mHoldPeriods = HOLD_PERIODS;
+    }
+    else if (mHoldPeriods)
+    {
+        --mHoldPeriods;
+    }
+    else if (transferSpeed > 0)
+    {
+        probe = mNextProbe;
+        connections += probe;
+    }
+
+    connections = std::min(std::max(connections, mMinConnections), mMaxConnections);
+    if (probe && connections == mConnections)
+    {
+        // at a bound, stay there for a while and then try the other way
+        probe = 0;
+        mNextProbe = -mNextProbe;
+        mHoldPeriods = HOLD_PERIODS;
+    }
+    mProbe = probe;
+    mSpeedBeforeProbe = transferSpeed;
+
+    m_off_t requestSize = mRequestSize;
+    if (mSamples)
+    {
+        // a few seconds of data per request, and more if the latency is high
+        m_off_t seconds = std::max<m_off_t>(REQUEST_SECONDS, 10 * latency / SpeedController::DS_PER_SECOND);
+        m_off_t size = mSpeedSum / mSamples * seconds;
+        size -= size % (1024 * 1024);
+        size = std::min(std::max(size, mMinRequestSize), mMaxRequestSize);
+
+        // ignore small variations of speed
+        if (size > mRequestSize + mRequestSize / 2 || size < mRequestSize - mRequestSize / 2
+                || ((size == mMinRequestSize || size == mMaxRequestSize) && size != mRequestSize))
+        {
+            requestSize = size;
+        }
+    }
+
+    bool changed = connections != mConnections || requestSize != mRequestSize;
+
+    mStats.connectionsAdded += connections > mConnections;
+    mStats.connectionsRemoved += connections < mConnections;
+    mStats.requestSizeChanges += requestSize != mRequestSize;
+    mConnections = connections;
+    mRequestSize = requestSize;
+
+    mPeriodStart = now;
+    mSamples = mFailures = 0;
+    mSpeedSum = 0;
+    mLatencySum = 0;
+
+    return changed;
+}
+
 } // namespace
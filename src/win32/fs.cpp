@@ -1846,20 +1846,6 @@ bool WinFileSystemAccess::issyncsupported(const LocalPath& localpathArg, bool& i
     return result;
 }
 
-bool reuseFingerprint(const FSNode& lhs, const FSNode& rhs)
-{
-    // it might look like fingerprint.crc comparison has been missed out here
-    // but that is intentional.  The point is to avoid re-fingerprinting files
-    // when we rescan a folder, if we already have good info about them and
-    // nothing we can see from outside the file had changed,
-    // mtime is the same, and no notifications arrived
-    // for this particular file.
-    return lhs.type == rhs.type
-        && lhs.fsid == rhs.fsid
-        && lhs.fingerprint.mtime == rhs.fingerprint.mtime
-        && lhs.fingerprint.size == rhs.fingerprint.size;
-};
-
 bool  WinFileSystemAccess::checkForSymlink(const LocalPath& lp)
 {
 
@@ -2029,6 +2015,7 @@ ScanResult WinFileSystemAccess::directoryScan(const LocalPath& path, handle expe
 
                 result.fingerprint.mtime = FileTime_to_POSIX((FILETIME*)&info->LastWriteTime);
                 result.fingerprint.size = (m_off_t)info->EndOfFile.QuadPart;
+                result.ctime = (m_time_t)info->ChangeTime.QuadPart;
 
                 if (info->ShortNameLength > 0)
                 {
@@ -2062,7 +2049,7 @@ ScanResult WinFileSystemAccess::directoryScan(const LocalPath& path, handle expe
                     // Fingerprint the file if it's new or changed
                     // (caller has to not supply 'known' items we aready know changed in case mtime+size is still a match)
                     auto it = known.find(result.localname);
-                    if (it != known.end() && reuseFingerprint(it->second, result))
+                    if (it != known.end() && result.canReuseFingerprint(it->second))
                     {
                         result.fingerprint = std::move(it->second.fingerprint);
                         known.erase(it);
@@ -0,0 +1,102 @@
+/**
+ * @file Http2_test.cpp
+ * @brief Tests for the HTTP/2 multiplexing of the network layer
+ *
+ * They need a server that speaks HTTP/2 over TLS, given by MEGA_HTTP2_TEST_URL
+ * (for instance https://localhost:8443/ served by nghttpd), and a libcurl with HTTP/2 support.
+ * Otherwise they are skipped.
+ */
+
+#include "mega.h"
+#include "test.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+using namespace mega;
+
+namespace
+{
+
+// Runs the network layer until all the requests have finished, or the timeout expires
+bool waitForRequests(HttpIO& httpio,
+                     WAIT_CLASS& waiter,
+                     const std::vector<std::unique_ptr<HttpReq>>& reqs,
+                     dstime timeout)
+{
+    WAIT_CLASS::bumpds();
+    dstime deadline = Waiter::ds + timeout;
+
+    for (;;)
+    {
+        httpio.doio();
+
+        bool pending = false;
+        for (auto& req : reqs)
+        {
+            pending |= req->status == REQ_INFLIGHT;
+        }
+        if (!pending)
+        {
+            return true;
+        }
+
+        WAIT_CLASS::bumpds();
+        if (Waiter::ds >= deadline)
+        {
+            return false;
+        }
+
+        waiter.init(10);
+        waiter.wakeupby(&httpio, Waiter::NEEDEXEC);
+        waiter.wait();
+        httpio.checkevents(&waiter);
+    }
+}
+
+} // namespace
+
+TEST(Http2, parallelRequestsShareOneConnection)
+{
+    const string url = Utils::getenv("MEGA_HTTP2_TEST_URL", "");
+    if (url.empty())
+    {
+        GTEST_SKIP() << "MEGA_HTTP2_TEST_URL is not set";
+    }
+
+    CurlHttpIO httpio;
+    WAIT_CLASS waiter;
+    string useragent = USER_AGENT;
+    httpio.setuseragent(&useragent);
+    if (!httpio.sethttp2(true))
+    {
+        GTEST_SKIP() << "libcurl has no HTTP/2 support";
+    }
+
+    // like the connections of a download, all started at once
+    const unsigned numRequests = 8;
+    std::vector<std::unique_ptr<HttpReq>> reqs;
+    for (unsigned i = 0; i < numRequests; ++i)
+    {
+        reqs.emplace_back(new HttpReq(true));
+        HttpReq& req = *reqs.back();
+        req.posturl = url;
+        req.type = REQ_BINARY;
+        req.method = METHOD_GET;
+        req.contentlength = -1;
+        req.httpio = &httpio;
+        httpio.post(&req);
+    }
+
+    ASSERT_TRUE(waitForRequests(httpio, waiter, reqs, 300)) << "Requests timed out";
+
+    int connections = 0;
+    for (auto& req : reqs)
+    {
+        ASSERT_EQ(req->status, REQ_SUCCESS) << "HTTP status " << req->httpstatus;
+        connections += req->mNewConnections;
+    }
+    ASSERT_EQ(connections, 1) << "The requests were not multiplexed over one connection";
+}
@@ -0,0 +1,143 @@
+/**
+ * @file AsyncIO_test.cpp
+ * @brief Unitary tests for the asynchronous file reads and writes
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+
+#include <memory>
+#include <vector>
+
+using namespace mega;
+
+// Like a parallel download: many writes in flight at once, followed by reads of the same data
+TEST(AsyncIO, parallelWritesThenReads)
+{
+    FSACCESS_CLASS fsAccess;
+    WAIT_CLASS waiter;
+    fsAccess.waiter = &waiter;
+
+    LocalPath path = LocalPath::fromAbsolutePath(".");
+    path.appendWithSeparator(LocalPath::fromRelativePath("asyncio_test.bin"), false);
+    fsAccess.unlinklocal(path);
+
+    const unsigned pieceSize = 64 * 1024;
+    const unsigned numPieces = 20;
+    const unsigned pad = SymmCipher::BLOCKSIZE;
+
+    std::vector<std::string> pieces;
+    for (unsigned i = 0; i < numPieces; ++i)
+    {
+        pieces.emplace_back(pieceSize, static_cast<char>('a' + i));
+    }
+
+    {
+        auto fa = fsAccess.newfileaccess();
+        if (!fa->asyncavailable())
+        {
+            GTEST_SKIP() << "Asynchronous file access is not available";
+        }
+        ASSERT_TRUE(fa->fopen(path, false, true, FSLogging::logOnError));
+
+        // out of order, as the connections of a download finish
+        std::vector<std::unique_ptr<AsyncIOContext>> writes;
+        for (unsigned i = numPieces; i--; )
+        {
+            writes.emplace_back(fa->asyncfwrite(reinterpret_cast<const byte*>(pieces[i].data()), pieceSize, m_off_t(i) * pieceSize));
+        }
+
+        for (auto& write : writes)
+        {
+            write->finish();
+            ASSERT_TRUE(write->finished);
+            ASSERT_FALSE(write->failed);
+        }
+    }
+
+    {
+        auto fa = fsAccess.newfileaccess();
+        ASSERT_TRUE(fa->fopen(path, FSLogging::logOnError));
+        ASSERT_EQ(fa->size, m_off_t(pieceSize) * numPieces);
+
+        std::vector<std::string> buffers(numPieces);
+        std::vector<std::unique_ptr<AsyncIOContext>> reads;
+        for (unsigned i = 0; i < numPieces; ++i)
+        {
+            reads.emplace_back(fa->asyncfread(&buffers[i], pieceSize, pad, m_off_t(i) * pieceSize, FSLogging::logOnError));
+        }
+
+        for (unsigned i = 0; i < numPieces; ++i)
+        {
+            reads[i]->finish();
+            ASSERT_FALSE(reads[i]->failed);
+            ASSERT_EQ(buffers[i].size(), pieceSize + pad);
+            ASSERT_EQ(buffers[i].substr(0, pieceSize), pieces[i]);
+            ASSERT_EQ(buffers[i].substr(pieceSize), std::string(pad, '\0'));
+        }
+
+        // the contexts must be deleted before the FileAccess
+        reads.clear();
+    }
+
+    fsAccess.unlinklocal(path);
+}
+
+// A read past the end of the file (it shrank since the transfer started) must not be retried forever
+TEST(AsyncIO, readPastEndIsNotRetried)
+{
+    FSACCESS_CLASS fsAccess;
+    WAIT_CLASS waiter;
+    fsAccess.waiter = &waiter;
+
+    LocalPath path = LocalPath::fromAbsolutePath(".");
+    path.appendWithSeparator(LocalPath::fromRelativePath("asyncio_short_test.bin"), false);
+    fsAccess.unlinklocal(path);
+
+    const unsigned fileSize = 1000;
+    const unsigned readSize = 64 * 1024;
+    const std::string content(fileSize, 'x');
+
+    {
+        auto fa = fsAccess.newfileaccess();
+        if (!fa->asyncavailable())
+        {
+            GTEST_SKIP() << "Asynchronous file access is not available";
+        }
+        ASSERT_TRUE(fa->fopen(path, false, true, FSLogging::logOnError));
+        ASSERT_TRUE(fa->fwrite(reinterpret_cast<const byte*>(content.data()), fileSize, 0));
+    }
+
+    {
+        auto fa = fsAccess.newfileaccess();
+        ASSERT_TRUE(fa->fopen(path, FSLogging::logOnError));
+
+        std::string buffer;
+        std::unique_ptr<AsyncIOContext> read(fa->asyncfread(&buffer, readSize, SymmCipher::BLOCKSIZE, 0, FSLogging::logOnError));
+        read->finish();
+        ASSERT_TRUE(read->finished);
+        ASSERT_FALSE(read->retry);
+        ASSERT_EQ(buffer.substr(0, fileSize), content);
+
+        read.reset();
+    }
+
+    fsAccess.unlinklocal(path);
+}
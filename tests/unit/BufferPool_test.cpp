@@ -0,0 +1,208 @@
+/**
+ * @file BufferPool_test.cpp
+ * @brief Unitary tests for the pool of transfer buffers
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega/bufferpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace mega;
+
+TEST(BufferPool, capacityClasses)
+{
+    ASSERT_EQ(BufferPool::capacityFor(1), BufferPool::ALIGNMENT);
+    ASSERT_EQ(BufferPool::capacityFor(4096), 4096u);
+    ASSERT_EQ(BufferPool::capacityFor(4097), 8192u);
+
+    // four classes between 1 MB and 2 MB
+    ASSERT_EQ(BufferPool::capacityFor(1024 * 1024), 1024u * 1024);
+    ASSERT_EQ(BufferPool::capacityFor(1024 * 1024 + 1), 1280u * 1024);
+    ASSERT_EQ(BufferPool::capacityFor(1300 * 1024), 1536u * 1024);
+    ASSERT_EQ(BufferPool::capacityFor(2047 * 1024), 2048u * 1024);
+
+    for (size_t size = 1; size < 16 * 1024 * 1024; size = size * 3 / 2 + 7)
+    {
+        size_t capacity = BufferPool::capacityFor(size);
+        ASSERT_GE(capacity, size);
+        ASSERT_EQ(capacity % BufferPool::ALIGNMENT, 0u);
+        ASSERT_LE(capacity, size + std::max(size / 4, BufferPool::ALIGNMENT));
+    }
+}
+
+TEST(BufferPool, reusesReleasedBuffers)
+{
+    BufferPool pool;
+
+    ASSERT_EQ(pool.acquire(0), nullptr);
+
+    byte* a = pool.acquire(1000000);
+    ASSERT_NE(a, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % BufferPool::ALIGNMENT, 0u);
+    memset(a, 0xAA, 1000000);
+    pool.release(a);
+
+    // same size class
+    byte* b = pool.acquire(1000000 - 100);
+    ASSERT_EQ(a, b);
+
+    // different size class
+    byte* c = pool.acquire(3000000);
+    ASSERT_NE(c, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(c) % BufferPool::ALIGNMENT, 0u);
+
+    auto stats = pool.stats();
+    ASSERT_EQ(stats.hits, 1u);
+    ASSERT_EQ(stats.misses, 2u);
+    ASSERT_EQ(stats.idleBytes, 0u);
+    ASSERT_EQ(stats.inUseBytes, BufferPool::capacityFor(1000000) + BufferPool::capacityFor(3000000));
+    ASSERT_EQ(stats.peakInUseBytes, stats.inUseBytes);
+
+    pool.release(b);
+    pool.release(c);
+    pool.release(nullptr);
+
+    stats = pool.stats();
+    ASSERT_EQ(stats.inUseBytes, 0u);
+    ASSERT_EQ(stats.idleBytes, BufferPool::capacityFor(1000000) + BufferPool::capacityFor(3000000));
+
+    pool.trim();
+    ASSERT_EQ(pool.stats().idleBytes, 0u);
+}
+
+TEST(BufferPool, idleMemoryCeiling)
+{
+    const size_t size = 1024 * 1024;
+    BufferPool pool(3 * size);
+
+    std::vector<byte*> buffers;
+    for (int i = 0; i < 5; ++i)
+    {
+        buffers.push_back(pool.acquire(size));
+    }
+    for (byte* buffer : buffers)
+    {
+        pool.release(buffer);
+    }
+
+    auto stats = pool.stats();
+    ASSERT_EQ(stats.idleBytes, 3 * size);
+    ASSERT_EQ(stats.discards, 2u);
+    ASSERT_EQ(stats.peakInUseBytes, 5 * size);
+
+    // lowering the ceiling frees the idle buffers above it
+    pool.setMaxIdleBytes(size);
+    ASSERT_EQ(pool.maxIdleBytes(), size);
+    ASSERT_EQ(pool.stats().idleBytes, size);
+
+    pool.setMaxIdleBytes(0);
+    ASSERT_EQ(pool.stats().idleBytes, 0u);
+    pool.release(pool.acquire(size));
+    ASSERT_EQ(pool.stats().idleBytes, 0u);
+    ASSERT_EQ(pool.stats().discards, 3u);
+}
+
+TEST(BufferPool, trimIfIdle)
+{
+    const size_t size = 1024 * 1024;
+    BufferPool pool;
+
+    pool.release(pool.acquire(size));
+    auto lastUse = std::chrono::steady_clock::now();
+    ASSERT_EQ(pool.stats().idleBytes, size);
+
+    // still in use recently
+    ASSERT_FALSE(pool.trimIfIdle(lastUse));
+    ASSERT_EQ(pool.stats().idleBytes, size);
+
+    ASSERT_TRUE(pool.trimIfIdle(lastUse + BufferPool::IDLE_TRIM_DELAY));
+    ASSERT_EQ(pool.stats().idleBytes, 0u);
+
+    // nothing left to free
+    ASSERT_FALSE(pool.trimIfIdle(lastUse + 2 * BufferPool::IDLE_TRIM_DELAY));
+}
+
+// Chunk-sized allocations as done by a download with several connections:
+// the pool only allocates for the first round and the buffers are reused afterwards
+TEST(BufferPool, chunkAllocationPattern)
+{
+    BufferPool pool;
+
+    const size_t connections = 6;
+    const int rounds = 200;
+    const size_t chunkSizes[] = { 1024 * 1024, 1024 * 1024 - 16 * 1024, 1000 * 1024 };
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        std::vector<byte*> buffers;
+        for (size_t i = 0; i < connections; ++i)
+        {
+            byte* buffer = pool.acquire(chunkSizes[(round + i) % 3]);
+            buffer[0] = buffer[chunkSizes[(round + i) % 3] - 1] = byte(round);
+            buffers.push_back(buffer);
+        }
+        for (byte* buffer : buffers)
+        {
+            pool.release(buffer);
+        }
+    }
+
+    auto stats = pool.stats();
+    ASSERT_EQ(stats.misses, connections);
+    ASSERT_EQ(stats.hits, connections * (rounds - 1));
+    ASSERT_EQ(stats.peakInUseBytes, connections * 1024 * 1024);
+}
+
+// Acquisitions and releases of chunk buffers per second, as in chunkAllocationPattern.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the throughput
+TEST(BufferPool, DISABLED_chunkAllocationThroughput)
+{
+    BufferPool pool;
+
+    const size_t connections = 6;
+    const int rounds = 20000;
+    const size_t chunkSizes[] = { 1024 * 1024, 1024 * 1024 - 16 * 1024, 1000 * 1024 };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        std::vector<byte*> buffers;
+        for (size_t i = 0; i < connections; ++i)
+        {
+            byte* buffer = pool.acquire(chunkSizes[(round + i) % 3]);
+            buffer[0] = buffer[chunkSizes[(round + i) % 3] - 1] = byte(round);
+            buffers.push_back(buffer);
+        }
+        for (byte* buffer : buffers)
+        {
+            pool.release(buffer);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(pool.stats().misses, connections);
+
+    RecordProperty("chunkBuffersPerSecond", int(double(connections) * rounds / elapsed.count()));
+}
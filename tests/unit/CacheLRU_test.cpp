@@ -830,3 +830,62 @@ TEST(CacheLRU, reduceCacheLRUSize)
     ASSERT_EQ(client->mNodeManager.getNodeCount(), numNodes + 4);
 
 }
+
+TEST(CacheLRU, byteBudget)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    std::shared_ptr<mega::Node> auxiliarNode(&folder);
+    client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+
+    // big attributes make the estimation of every file grow accordingly
+    std::string bigValue(1000, 'x');
+    std::vector<mega::NodeHandle> handles;
+    uint32_t numNodes = 20;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &folder);
+        file.attrs.map = std::map<mega::nameid, std::string>{{101, bigValue}, {110, "name" + std::to_string(index)}};
+        ASSERT_GT(file.getEstimatedMemoryUsage(), bigValue.size());
+        handles.push_back(file.nodeHandle());
+        auxiliarNode.reset(&file);
+        client->mNodeManager.addNode(auxiliarNode, true, false, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+    auxiliarNode.reset();
+
+    ASSERT_EQ(client->mNodeManager.getNumNodesAtCacheLRU(), numNodes + 2);
+    uint64_t bytesPerFile = client->mNodeManager.getCacheLRUBytes() / (numNodes + 2);
+    ASSERT_GT(bytesPerFile, 0u);
+
+    uint64_t maxBytes = 5 * bytesPerFile;
+    client->mNodeManager.setCacheLRUMaxBytes(maxBytes);
+    ASSERT_LE(client->mNodeManager.getCacheLRUBytes(), maxBytes);
+    ASSERT_LT(client->mNodeManager.getNumNodesAtCacheLRU(), 6u);
+    ASSERT_GT(client->mNodeManager.getNumNodesAtCacheLRU(), 0u);
+
+    // most recent file is still in RAM, oldest one has to be loaded from DB
+    uint64_t hits = client->mNodeManager.getNodeByHandleHits();
+    uint64_t misses = client->mNodeManager.getNodeByHandleMisses();
+    ASSERT_NE(client->mNodeManager.getNodeByHandle(handles.back()), nullptr);
+    ASSERT_EQ(client->mNodeManager.getNodeByHandleHits(), hits + 1);
+    ASSERT_NE(client->mNodeManager.getNodeByHandle(handles.front()), nullptr);
+    ASSERT_EQ(client->mNodeManager.getNodeByHandleMisses(), misses + 1);
+    ASSERT_LE(client->mNodeManager.getCacheLRUBytes(), maxBytes);
+}
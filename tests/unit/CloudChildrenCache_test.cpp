@@ -0,0 +1,213 @@
+/**
+ * @file CloudChildrenCache_test.cpp
+ * @brief Unitary tests for the projection of cloud children used by syncs
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+#include "mega/nodemanager.h"
+#include "utils.h"
+
+using namespace mega;
+
+namespace {
+
+NodeHandle folder(handle h)
+{
+    return NodeHandle().set6byte(h);
+}
+
+std::vector<CloudNode> children(NodeHandle parent, size_t count)
+{
+    std::vector<CloudNode> nodes(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        nodes[i].name = "child" + std::to_string(i);
+        nodes[i].type = FOLDERNODE;
+        nodes[i].handle = NodeHandle().set6byte(parent.as8byte() * 1000 + i + 1);
+        nodes[i].parentHandle = parent;
+        nodes[i].parentType = FOLDERNODE;
+    }
+    return nodes;
+}
+
+} // namespace
+
+TEST(CloudChildrenCache, getPutInvalidate)
+{
+    CloudChildrenCache cache;
+    std::vector<CloudNode> result;
+
+    ASSERT_FALSE(cache.get(folder(1), result));
+
+    cache.put(folder(1), children(folder(1), 3), cache.generation());
+    ASSERT_TRUE(cache.get(folder(1), result));
+    ASSERT_EQ(result.size(), 3u);
+    ASSERT_EQ(result[2].name, "child2");
+    ASSERT_EQ(result[2].parentHandle, folder(1));
+    ASSERT_EQ(cache.numNodes(), 3u);
+    ASSERT_EQ(cache.hits(), 1u);
+    ASSERT_EQ(cache.misses(), 1u);
+
+    // other folders don't affect it
+    cache.invalidate(folder(2));
+    ASSERT_TRUE(cache.get(folder(1), result));
+
+    cache.invalidate(folder(1));
+    ASSERT_FALSE(cache.get(folder(1), result));
+    ASSERT_EQ(cache.numNodes(), 0u);
+
+    cache.put(folder(1), children(folder(1), 2), cache.generation());
+    cache.clear();
+    ASSERT_FALSE(cache.get(folder(1), result));
+}
+
+TEST(CloudChildrenCache, discardsChildrenReadBeforeAChange)
+{
+    CloudChildrenCache cache;
+    std::vector<CloudNode> result;
+
+    // the tree changed while the children were being read
+    auto generation = cache.generation();
+    cache.invalidate(folder(7));
+    cache.put(folder(1), children(folder(1), 3), generation);
+    ASSERT_FALSE(cache.get(folder(1), result));
+
+    // children without name (no key yet) are not cached
+    auto undecrypted = children(folder(1), 3);
+    undecrypted[1].name.clear();
+    cache.put(folder(1), undecrypted, cache.generation());
+    ASSERT_FALSE(cache.get(folder(1), result));
+}
+
+TEST(CloudChildrenCache, dropsLeastRecentlyUsedFolders)
+{
+    CloudChildrenCache cache(10);
+    std::vector<CloudNode> result;
+
+    cache.put(folder(1), children(folder(1), 4), cache.generation());
+    cache.put(folder(2), children(folder(2), 4), cache.generation());
+
+    // folder 1 used more recently than folder 2
+    ASSERT_TRUE(cache.get(folder(1), result));
+
+    cache.put(folder(3), children(folder(3), 4), cache.generation());
+    ASSERT_EQ(cache.numNodes(), 8u);
+    ASSERT_FALSE(cache.get(folder(2), result));
+    ASSERT_TRUE(cache.get(folder(1), result));
+    ASSERT_TRUE(cache.get(folder(3), result));
+
+    // bigger than the limit on its own
+    cache.put(folder(4), children(folder(4), 11), cache.generation());
+    ASSERT_FALSE(cache.get(folder(4), result));
+
+    cache.setMaxNodes(4);
+    ASSERT_EQ(cache.maxNodes(), 4u);
+    ASSERT_EQ(cache.numNodes(), 4u);
+    ASSERT_TRUE(cache.get(folder(3), result));
+}
+
+TEST(CloudChildrenCache, invalidatedByNodeManager)
+{
+    MegaApp app;
+    SqliteDbAccess* dbAccess = new SqliteDbAccess(LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    auto& nodeManager = client->mNodeManager;
+    auto& cache = nodeManager.cloudChildrenCache();
+    std::vector<CloudNode> result;
+
+    // as the syncs do after reading the children from the node tree
+    auto cacheChildren = [&cache](const Node& parent)
+    {
+        cache.put(parent.nodeHandle(), children(parent.nodeHandle(), 2), cache.generation());
+    };
+
+    auto isCached = [&cache, &result](const Node& parent)
+    {
+        return cache.get(parent.nodeHandle(), result);
+    };
+
+    uint64_t index = 1;
+    NodeManager::MissingParentNodes missingParentNodes;
+    auto addNode = [&](nodetype_t type, Node* parent, const char* name, const char* key = nullptr) -> std::shared_ptr<Node>
+    {
+        auto& node = mt::makeNode(*client, type, NodeHandle().set6byte(index++), parent);
+        node.attrs.map['n'] = name;
+        if (key)
+        {
+            node.setkeyfromjson(key);
+        }
+
+        std::shared_ptr<Node> shared(&node);
+        nodeManager.addNode(shared, false, false, missingParentNodes);
+        return shared;
+    };
+
+    auto root = addNode(ROOTNODE, nullptr, "");
+    auto folderA = addNode(FOLDERNODE, root.get(), "folderA");
+    auto folderB = addNode(FOLDERNODE, root.get(), "folderB");
+
+    // new child (addNode_internal)
+    cacheChildren(*folderA);
+    auto file = addNode(FILENODE, folderA.get(), "file.txt");
+    ASSERT_FALSE(isCached(*folderA));
+
+    // rename (notifyNode_internal), other folders are kept
+    cacheChildren(*folderA);
+    cacheChildren(*folderB);
+    file->attrs.map['n'] = "renamed.txt";
+    file->changed.name = true;
+    nodeManager.notifyNode(file);
+    ASSERT_FALSE(isCached(*folderA));
+    ASSERT_TRUE(isCached(*folderB));
+
+    // move (Node::setparent), for the old parent and the new one
+    cacheChildren(*folderA);
+    cacheChildren(*folderB);
+    file->setparent(folderB);
+    ASSERT_FALSE(isCached(*folderA));
+    ASSERT_FALSE(isCached(*folderB));
+
+    // key arrival (applyKeys_internal): a file in a share whose key isn't known yet
+    const NodeHandle share = NodeHandle().set6byte(999);
+    std::string key = toNodeHandle(share) + ":" + Base64::btoa(std::string(FILENODEKEYLENGTH, 'K'));
+    auto undecrypted = addNode(FILENODE, folderB.get(), "", key.c_str());
+    ASSERT_FALSE(undecrypted->keyApplied());
+
+    cacheChildren(*folderB);
+    nodeManager.applyKeys(0);
+    ASSERT_TRUE(isCached(*folderB));
+
+    client->mNewKeyRepository[share] = std::vector<byte>(SymmCipher::KEYLENGTH, 'S');
+    nodeManager.applyKeys(0);
+    ASSERT_TRUE(undecrypted->keyApplied());
+    ASSERT_FALSE(isCached(*folderB));
+
+    // deletion (notifyNode_internal)
+    cacheChildren(*folderB);
+    file->changed.removed = true;
+    nodeManager.notifyNode(file);
+    ASSERT_FALSE(isCached(*folderB));
+}
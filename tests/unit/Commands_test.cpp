@@ -24,6 +24,7 @@
 #include <mega/json.h>
 #include <mega/megaapp.h>
 #include <mega/megaclient.h>
+#include <mega/request.h>
 #include <mega/types.h>
 
 using namespace std;
@@ -255,3 +256,70 @@ TEST(Commands, CommandQueryAds)
     command.procresult(r);
 }
 */
+
+namespace {
+
+class CommandMockup : public Command
+{
+public:
+    CommandMockup(const char* name, bool independent)
+    {
+        cmd(name);
+        mIndependent = independent;
+    }
+
+    bool procresult(Result, JSON&) override { return true; }
+};
+
+} // anonymous
+
+TEST(Commands, RequestDispatcher_pipelinesIndependentCommands)
+{
+    PrnGen rng;
+    RequestDispatcher reqs(rng);
+    reqs.setPipelining(true);
+
+    reqs.add(new CommandMockup("p", false));
+    reqs.add(new CommandMockup("uq", true));
+    reqs.add(new CommandMockup("a", false));
+    reqs.add(new CommandMockup("g", true));
+
+    // the ordered batch keeps the commands that aren't independent, in order
+    bool fetchingNodes = false;
+    bool v3 = false;
+    string id;
+    ASSERT_TRUE(reqs.readyToSend());
+    ASSERT_EQ(reqs.serverrequest(fetchingNodes, v3, nullptr, id), R"([{"a":"p"},{"a":"a"}])");
+    ASSERT_FALSE(reqs.readyToSend());
+
+    // the independent ones go in a batch of their own, sent while the ordered one is in flight
+    string pipelinedId;
+    ASSERT_TRUE(reqs.readyToSendPipelined(0));
+    ASSERT_EQ(reqs.serverrequestPipelined(0, v3, nullptr, pipelinedId), R"([{"a":"uq"},{"a":"g"}])");
+    ASSERT_NE(id, pipelinedId);
+    ASSERT_FALSE(reqs.readyToSendPipelined());
+
+    reqs.add(new CommandMockup("qbq", true));
+    ASSERT_FALSE(reqs.readyToSendPipelined(0));
+    ASSERT_TRUE(reqs.readyToSendPipelined(1));
+    string secondId;
+    ASSERT_EQ(reqs.serverrequestPipelined(1, v3, nullptr, secondId), R"([{"a":"qbq"}])");
+    ASSERT_NE(pipelinedId, secondId);
+
+    // a failed batch is resent unchanged, for idempotence
+    reqs.inflightFailurePipelined(0, RETRY_CONNECTIVITY);
+    ASSERT_TRUE(reqs.readyToSendPipelined(0));
+    string retryId;
+    ASSERT_EQ(reqs.serverrequestPipelined(0, v3, nullptr, retryId), R"([{"a":"uq"},{"a":"g"}])");
+    ASSERT_EQ(pipelinedId, retryId);
+
+    // without pipelining, independent commands wait in the ordered queue
+    reqs.setPipelining(false);
+    reqs.add(new CommandMockup("usl", true));
+    ASSERT_FALSE(reqs.readyToSendPipelined());
+    ASSERT_FALSE(reqs.readyToSend());
+
+    reqs.clear();
+    ASSERT_FALSE(reqs.cmdsInflight());
+    ASSERT_FALSE(reqs.readyToSendPipelined());
+}
@@ -19,6 +19,7 @@
 #include "mega.h"
 #include "../src/crypto/sodium.cpp"
 #include <math.h>
+#include <chrono>
 #include "gtest/gtest.h"
 
 using namespace mega;
@@ -393,3 +394,112 @@ TEST(Crypto, SymmCipher_isZeroKey)
     key_test6.replace(SymmCipher::BLOCKSIZE, SymmCipher::BLOCKSIZE, "0123456789ABCDEF");
     ASSERT_EQ(SymmCipher::isZeroKey(reinterpret_cast<byte*>(key_test6.data()), FILENODEKEYLENGTH), true);
 }
+
+namespace {
+
+// Restores the AES-NI ctr_crypt() kernel when a test that disabled it finishes
+struct HardwareCtrGuard
+{
+    ~HardwareCtrGuard()
+    {
+        SymmCipher::setHardwareCtr(true);
+    }
+};
+
+} // namespace
+
+// The fused AES-NI kernel must produce the same data and chunk MACs as the Crypto++ path,
+// including partial last blocks and chunks decrypted in several pieces
+TEST(Crypto, SymmCipher_ctr_crypt_hardware)
+{
+    if (!SymmCipher::hardwareCtrAvailable())
+    {
+        GTEST_SKIP() << "AES-NI not available";
+    }
+    HardwareCtrGuard guard;
+
+    PrnGen rng;
+    for (int i = 0; i < 200; i++)
+    {
+        SymmCipher cipher;
+        cipher.setkey(reinterpret_cast<const byte*>(rng.genstring(SymmCipher::KEYLENGTH).data()));
+
+        unsigned len = rng.genuint32(i % 10 ? 2000 : 300000);
+        m_off_t pos = m_off_t(rng.genuint32(1 << 20)) * SymmCipher::BLOCKSIZE;
+        SymmCipher::ctr_iv iv;
+        rng.genblock(reinterpret_cast<byte*>(&iv), sizeof iv);
+
+        // NUL-padded to BLOCKSIZE
+        string plain = rng.genstring(len);
+        plain.resize(len + SymmCipher::BLOCKSIZE);
+
+        // encryption, with and without MAC
+        string encrypted[2];
+        byte encryptMac[2][SymmCipher::BLOCKSIZE];
+        for (int hw = 0; hw < 2; hw++)
+        {
+            SymmCipher::setHardwareCtr(hw != 0);
+            encrypted[hw] = plain;
+            cipher.ctr_crypt(reinterpret_cast<byte*>(encrypted[hw].data()), len, pos, iv, encryptMac[hw], true);
+
+            string noMac = plain;
+            cipher.ctr_crypt(reinterpret_cast<byte*>(noMac.data()), len, pos, iv, nullptr, true);
+            ASSERT_EQ(noMac.substr(0, len), encrypted[hw].substr(0, len));
+        }
+        ASSERT_EQ(encrypted[0], encrypted[1]);
+        ASSERT_EQ(memcmp(encryptMac[0], encryptMac[1], sizeof encryptMac[0]), 0);
+
+        // decryption in two pieces, the second one continuing the MAC of the first
+        unsigned split = rng.genuint32(len / SymmCipher::BLOCKSIZE + 1) * SymmCipher::BLOCKSIZE;
+        for (int hw = 0; hw < 2; hw++)
+        {
+            SymmCipher::setHardwareCtr(hw != 0);
+            string data = encrypted[0];
+            byte mac[SymmCipher::BLOCKSIZE];
+            cipher.ctr_crypt(reinterpret_cast<byte*>(data.data()), split, pos, iv, mac, false, true);
+            cipher.ctr_crypt(reinterpret_cast<byte*>(data.data()) + split, len - split, pos + split, iv, mac, false, !split);
+
+            ASSERT_EQ(data.substr(0, len), plain.substr(0, len)) << "len " << len << " split " << split << " hw " << hw;
+            ASSERT_EQ(memcmp(mac, encryptMac[0], sizeof mac), 0) << "len " << len << " split " << split << " hw " << hw;
+        }
+    }
+}
+
+// Throughput of the chunk encryption (CTR + chunk MAC) with and without the AES-NI kernel.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the throughput
+TEST(Crypto, DISABLED_SymmCipher_ctr_crypt_throughput)
+{
+    HardwareCtrGuard guard;
+
+    const unsigned chunkSize = 1024 * 1024;
+    const int chunks = 32;
+
+    SymmCipher cipher;
+    PrnGen rng;
+    cipher.setkey(reinterpret_cast<const byte*>(rng.genstring(SymmCipher::KEYLENGTH).data()));
+
+    std::vector<byte> data(chunkSize + SymmCipher::BLOCKSIZE);
+    byte mac[SymmCipher::BLOCKSIZE];
+
+    for (int hw = 0; hw < 2; hw++)
+    {
+        if (hw && !SymmCipher::hardwareCtrAvailable())
+        {
+            break;
+        }
+        SymmCipher::setHardwareCtr(hw != 0);
+
+        for (bool encrypt : { true, false })
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < chunks; i++)
+            {
+                cipher.ctr_crypt(data.data(), chunkSize, m_off_t(i) * chunkSize, 0, mac, encrypt);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            RecordProperty(std::string(hw ? "aesni" : "cryptopp") + (encrypt ? "EncryptMBps" : "DecryptMBps"),
+                           int(chunks / elapsed.count()));
+        }
+    }
+}
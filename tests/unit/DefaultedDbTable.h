@@ -177,6 +177,18 @@ public:
     void createIndexes() override
     {
 
+    }
+    void startBulkLoad(bool) override
+    {
+
+    }
+    uint64_t getNodesVersion() const override
+    {
+        return 0;
+    }
+    std::shared_ptr<DBTableNodes> getReadOnlyTable(uint64_t&) override
+    {
+        return nullptr;
     }
     bool put(uint32_t, char*, unsigned) override
     {
@@ -0,0 +1,330 @@
+/**
+ * @file JSON_test.cpp
+ * @brief Unitary tests for the JSON scanner and the streaming JSON splitter
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mega/json.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+// Restores the default scanning of strings
+struct VectorScanRestorer
+{
+    ~VectorScanRestorer() { mega::JSON::useVectorScan(true); }
+};
+
+std::string randomStringContent(std::mt19937& rng)
+{
+    static const char chars[] = "abcXYZ019 _-+/=.:,{}[]";
+    static const char* escapes[] = {"\\\"", "\\\\", "\\n", "\\/", "\\u00e9"};
+
+    // long strings cross several 16-byte blocks
+    size_t length = rng() % 8 ? rng() % 24 : rng() % 200;
+    std::string s;
+    while (s.size() < length)
+    {
+        if (rng() % 10)
+        {
+            s += chars[rng() % (sizeof(chars) - 1)];
+        }
+        else
+        {
+            s += escapes[rng() % 5];
+        }
+    }
+    return s;
+}
+
+std::string randomValue(std::mt19937& rng, int depth)
+{
+    switch (depth > 3 ? rng() % 2 : rng() % 4)
+    {
+        case 0:
+            return std::to_string(static_cast<int>(rng() % 2000000) - 1000000) + (rng() % 4 ? "" : ".5");
+        case 1:
+            return '"' + randomStringContent(rng) + '"';
+        case 2:
+        {
+            std::string object = "{";
+            for (unsigned i = rng() % 4; i--; )
+            {
+                object += '"' + std::string(1, static_cast<char>('a' + rng() % 3)) + "\":" + randomValue(rng, depth + 1);
+                object += i ? "," : "";
+            }
+            return object + '}';
+        }
+        default:
+        {
+            std::string array = "[";
+            for (unsigned i = rng() % 4; i--; )
+            {
+                array += randomValue(rng, depth + 1) + (i ? "," : "");
+            }
+            return array + ']';
+        }
+    }
+}
+
+// Mostly malformed JSON
+std::string randomNoise(std::mt19937& rng)
+{
+    static const char chars[] = "\"\\{}[]:,-.0123456789eE+ aZ";
+    std::string s;
+    for (size_t length = rng() % 64; s.size() < length; )
+    {
+        s += chars[rng() % (sizeof(chars) - 1)];
+    }
+    return s;
+}
+
+// Copy of 'data' at the given offset from a 16-byte boundary
+struct MisalignedCopy
+{
+    MisalignedCopy(const std::string& data, size_t offset)
+        : mBuffer(offset + data.size() + 16, '\0')
+    {
+        size_t misalignment = reinterpret_cast<uintptr_t>(mBuffer.data()) & 15;
+        mData = mBuffer.data() + (16 - misalignment) % 16 + offset % 16;
+        memcpy(mData, data.data(), data.size());
+        mData[data.size()] = '\0';
+    }
+
+    std::vector<char> mBuffer;
+    char* mData;
+};
+
+// Results of storing every element of 'data', one after the other
+std::vector<std::string> storeObjects(const char* data)
+{
+    std::vector<std::string> results;
+    mega::JSON json(data);
+    for (int i = 0; i < 64 && *json.pos; ++i)
+    {
+        std::string value;
+        bool stored = json.storeobject(&value);
+        results.push_back(std::to_string(stored) + ' ' + std::to_string(json.pos - data) + ' ' + value);
+        if (!stored)
+        {
+            break;
+        }
+    }
+    return results;
+}
+
+// Log of callbacks triggered by a JSONSplitter fed with chunks of random sizes and alignments
+std::vector<std::string> splitChunks(const std::string& data, unsigned seed)
+{
+    std::vector<std::string> log;
+
+    std::map<std::string, std::function<bool(mega::JSON*)>> filters;
+    filters["{[f{"] = [&log](mega::JSON* json)
+    {
+        std::string object;
+        bool stored = json->storeobject(&object);
+        log.push_back("f: " + object);
+        return stored;
+    };
+    filters["{\"a"] = [&log](mega::JSON* json)
+    {
+        std::string value;
+        bool stored = json->storeobject(&value);
+        log.push_back("a: " + value);
+        return stored;
+    };
+    filters["{"] = [&log](mega::JSON*)
+    {
+        log.push_back("end");
+        return true;
+    };
+
+    std::mt19937 rng(seed);
+    mega::JSONSplitter splitter;
+    size_t received = 0;
+    size_t consumed = 0;
+    while (!splitter.hasFinished() && !splitter.hasFailed() && received < data.size())
+    {
+        received = std::min(data.size(), received + 1 + rng() % 40);
+        MisalignedCopy chunk(data.substr(consumed, received - consumed), rng() % 16);
+        consumed += static_cast<size_t>(splitter.processChunk(&filters, chunk.mData));
+    }
+
+    log.push_back("finished: " + std::to_string(splitter.hasFinished()) + " consumed: " + std::to_string(consumed));
+    return log;
+}
+
+} // namespace
+
+TEST(JSON, stringEndSkipsEscapedChars)
+{
+    VectorScanRestorer restorer;
+
+    for (bool vectorScan : {true, false})
+    {
+        mega::JSON::useVectorScan(vectorScan);
+
+        // every offset from a 16-byte boundary, so quotes and escapes fall at both sides of it
+        for (size_t offset = 0; offset < 32; ++offset)
+        {
+            std::string content = std::string(offset, 'x') + "\\\\\\\"y\\\\";
+            MisalignedCopy quoted(content + "\",", offset);
+            ASSERT_EQ(mega::JSON::stringEnd(quoted.mData), quoted.mData + content.size());
+
+            MisalignedCopy unterminated(content + "\\\"", offset);
+            ASSERT_EQ(mega::JSON::stringEnd(unterminated.mData), nullptr);
+
+            MisalignedCopy trailingEscape(content + "\\", offset);
+            ASSERT_EQ(mega::JSON::stringEnd(trailingEscape.mData), nullptr);
+        }
+    }
+}
+
+TEST(JSON, vectorScanMatchesScalarScan)
+{
+    VectorScanRestorer restorer;
+    std::mt19937 rng(20241016);
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        std::string data = i % 2 ? randomNoise(rng) : randomValue(rng, 0) + ',' + randomValue(rng, 0);
+        MisalignedCopy copy(data, rng() % 16);
+
+        mega::JSON::useVectorScan(false);
+        std::vector<std::string> expected = storeObjects(copy.mData);
+
+        mega::JSON::useVectorScan(true);
+        ASSERT_EQ(storeObjects(copy.mData), expected) << "JSON: " << data;
+    }
+}
+
+TEST(JSONSplitter, vectorScanMatchesScalarScan)
+{
+    VectorScanRestorer restorer;
+    std::mt19937 rng(20241017);
+
+    for (int i = 0; i < 500; ++i)
+    {
+        // like fetchnodes responses: objects in an array 'f', among other values
+        std::vector<std::string> fields;
+        std::string f = "\"f\":[";
+        unsigned numObjects = static_cast<unsigned>(rng() % 6);
+        for (unsigned j = 0; j < numObjects; ++j)
+        {
+            f += (j ? "," : "") + std::string("{\"h\":\"") + randomStringContent(rng) + "\",\"a\":" + randomValue(rng, 2) + '}';
+        }
+        fields.push_back(f + ']');
+        std::string a = randomStringContent(rng);
+        fields.push_back("\"a\":\"" + a + '"');
+        fields.push_back("\"b\":" + randomValue(rng, 0));
+        std::shuffle(fields.begin(), fields.end(), rng);
+        std::string data = '{' + fields[0] + ',' + fields[1] + ',' + fields[2] + '}';
+
+        unsigned seed = static_cast<unsigned>(rng());
+
+        mega::JSON::useVectorScan(false);
+        std::vector<std::string> expected = splitChunks(data, seed);
+        ASSERT_EQ(expected.back(), "finished: 1 consumed: " + std::to_string(data.size())) << "JSON: " << data;
+        ASSERT_EQ(std::count(expected.begin(), expected.end(), "a: " + a), 1) << "JSON: " << data;
+        ASSERT_EQ(static_cast<unsigned>(std::count_if(expected.begin(), expected.end(),
+                                                      [](const std::string& l) { return l.rfind("f: ", 0) == 0; })),
+                  numObjects) << "JSON: " << data;
+
+        mega::JSON::useVectorScan(true);
+        ASSERT_EQ(splitChunks(data, seed), expected) << "JSON: " << data;
+    }
+}
+
+TEST(JSON, viewsMatchCopies)
+{
+    std::mt19937 rng(20241018);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::string data = i % 2 ? randomNoise(rng) : randomValue(rng, 0) + ',' + randomValue(rng, 0);
+
+        mega::JSON copies(data);
+        mega::JSON views(data);
+        for (int j = 0; j < 64 && *copies.pos; ++j)
+        {
+            std::string value;
+            std::string_view view;
+            bool stored = copies.storeobject(&value);
+            ASSERT_EQ(views.storeobject(view), stored) << "JSON: " << data;
+            ASSERT_EQ(views.pos, copies.pos) << "JSON: " << data;
+            if (!stored)
+            {
+                break;
+            }
+            ASSERT_EQ(view, value) << "JSON: " << data;
+        }
+    }
+}
+
+TEST(JSON, getnameView)
+{
+    std::string data = "{\"name\":\"value\",\"\":1,\"last\":[]}";
+    mega::JSON json(data);
+    ASSERT_TRUE(json.enterobject());
+
+    ASSERT_EQ(json.getnameWithoutAdvance(), "name");
+    ASSERT_EQ(json.getnameView(), "name");
+    std::string_view value;
+    ASSERT_TRUE(json.storeobject(value));
+    ASSERT_EQ(value, "value");
+    // the view points into the buffer
+    ASSERT_EQ(value.data(), data.c_str() + 9);
+
+    ASSERT_EQ(json.getnameView(), "");
+    ASSERT_EQ(json.getint(), 1);
+
+    ASSERT_EQ(json.getname(), "last");
+    ASSERT_TRUE(json.storeobject(value));
+    ASSERT_EQ(value, "[]");
+    ASSERT_TRUE(json.leaveobject());
+}
+
+TEST(JSON, unescapeOnlyCopiesEscapedStrings)
+{
+    std::string buffer;
+
+    std::string_view plain = "no escapes here";
+    ASSERT_EQ(mega::JSON::unescape(plain, buffer).data(), plain.data());
+    ASSERT_TRUE(buffer.empty());
+
+    std::string_view escaped = "tab\\there \\\"quoted\\\" \\u00e9";
+    std::string expected(escaped);
+    mega::JSON::unescape(&expected);
+    std::string_view unescaped = mega::JSON::unescape(escaped, buffer);
+    ASSERT_EQ(unescaped, expected);
+    ASSERT_EQ(unescaped.data(), buffer.data());
+
+    ASSERT_EQ(mega::JSON::stringView("base64\",\"next\""), "base64");
+    ASSERT_EQ(mega::JSON::stringView("unterminated"), "unterminated");
+    ASSERT_TRUE(mega::JSON::stringView(nullptr).empty());
+}
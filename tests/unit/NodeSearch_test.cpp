@@ -0,0 +1,715 @@
+/**
+ * @file NodeSearch_test.cpp
+ * @brief Unitary test for searches of nodes in DB
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mega/megaclient.h>
+#include <mega/megaapp.h>
+#include <mega/utils.h>
+
+#include "utils.h"
+#include "mega.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+
+// Provides the interface expected by NodeSearchFilter::copyFrom()
+struct SearchFilter
+{
+    std::string name;
+    std::string description;
+    std::string tag;
+    mega::handle location = mega::UNDEF;
+    int category = mega::MIME_TYPE_UNKNOWN;
+
+    const char* byName() const { return name.c_str(); }
+    int byNodeType() const { return mega::TYPE_UNKNOWN; }
+    int byCategory() const { return category; }
+    int bySensitivity() const { return 0; }
+    int byFavourite() const { return 0; }
+    mega::handle byLocationHandle() const { return location; }
+    int64_t byCreationTimeLowerLimit() const { return 0; }
+    int64_t byCreationTimeUpperLimit() const { return 0; }
+    int64_t byModificationTimeLowerLimit() const { return 0; }
+    int64_t byModificationTimeUpperLimit() const { return 0; }
+    const std::string& byDescription() const { return description; }
+    const std::string& byTag() const { return tag; }
+};
+
+std::vector<mega::NodeHandle> search(mega::MegaClient& client, const SearchFilter& f, bool recursive)
+{
+    mega::NodeSearchFilter filter;
+    filter.copyFrom(f);
+
+    mega::sharedNode_vector nodes;
+    if (recursive)
+    {
+        filter.byAncestors({f.location, mega::UNDEF, mega::UNDEF});
+        nodes = client.mNodeManager.searchNodes(filter, 1 /*DEFAULT_ASC*/, mega::CancelToken(), mega::NodeSearchPage(0, 0));
+    }
+    else
+    {
+        nodes = client.mNodeManager.getChildren(filter, 1 /*DEFAULT_ASC*/, mega::CancelToken(), mega::NodeSearchPage(0, 0));
+    }
+
+    std::vector<mega::NodeHandle> handles;
+    for (const auto& n : nodes)
+    {
+        handles.push_back(n->nodeHandle());
+    }
+    return handles;
+}
+
+} // namespace
+
+TEST(NodeSearch, fullTextIndexMatchesUserFunctions)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    auto* state = dynamic_cast<mega::SqliteAccountState*>(client->sctable.get());
+    ASSERT_NE(state, nullptr);
+    if (!state->hasFullTextIndex())
+    {
+        GTEST_SKIP() << "SQLite library without FTS5 trigram tokenizer";
+    }
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    std::shared_ptr<mega::Node> auxiliarNode(&folder);
+    folder.attrs.map = std::map<mega::nameid, std::string>{{'n', "Folder"}};
+    client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+
+    const mega::nameid descriptionId = mega::AttrMap::string2nameid(mega::MegaClient::NODE_ATTRIBUTE_DESCRIPTION);
+    const mega::nameid tagsId = mega::AttrMap::string2nameid(mega::MegaClient::NODE_ATTRIBUTE_TAGS);
+
+    const std::vector<std::string> words{"Report", "photo", "INVOICE", "holiday", "Über", "draft", "a\"quote", "x*y", "Beach"};
+    const uint32_t numNodes = 3000;
+    mega::Node* nodeToRename = nullptr;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        mega::Node* parent = (i % 2) ? &folder : &rootNode;
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), parent);
+        std::string name = words[i % words.size()] + "_" + words[(i / words.size()) % words.size()] + std::to_string(i) + ".jpg";
+        file.attrs.map[static_cast<mega::nameid>('n')] = name;
+        if (i % 3 == 0)
+        {
+            file.attrs.map[descriptionId] = "Some " + words[(i / 3) % words.size()] + " description";
+        }
+        if (i % 5 == 0)
+        {
+            file.attrs.map[tagsId] = words[(i / 5) % words.size()] + ",tag" + std::to_string(i % 7);
+        }
+
+        auxiliarNode.reset(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+        if (i == 4)
+        {
+            nodeToRename = &file;
+        }
+    }
+
+    const std::vector<SearchFilter> filters{
+        {"report", "", "", rootNode.nodehandle},
+        {"*voic*", "", "", rootNode.nodehandle},
+        {"pho?o_", "", "", rootNode.nodehandle},
+        {"über", "", "", rootNode.nodehandle},
+        {"a\"quo", "", "", rootNode.nodehandle},
+        {"x*y", "", "", rootNode.nodehandle},
+        {"jp", "", "", rootNode.nodehandle},
+        {"", "DRAFT desc", "", rootNode.nodehandle},
+        {"", "", "beach", rootNode.nodehandle},
+        {"", "", "tag3", rootNode.nodehandle},
+        {"holiday", "holiday", "tag1", rootNode.nodehandle},
+        {"report", "", "", folder.nodehandle},
+    };
+
+    for (bool recursive : {true, false})
+    {
+        for (const auto& f : filters)
+        {
+            state->useFullTextIndex(true);
+            auto fullTextResults = search(*client, f, recursive);
+
+            state->useFullTextIndex(false);
+            auto results = search(*client, f, recursive);
+
+            EXPECT_EQ(fullTextResults, results) << "name: " << f.name << " description: " << f.description << " tag: " << f.tag;
+        }
+    }
+
+    // Index is updated when nodes change
+    ASSERT_NE(nodeToRename, nullptr);
+    nodeToRename->attrs.map[static_cast<mega::nameid>('n')] = "renamedNode.txt";
+    client->mNodeManager.saveNodeInDb(nodeToRename);
+
+    state->useFullTextIndex(true);
+    SearchFilter renamed{"renamedno", "", "", rootNode.nodehandle};
+    auto results = search(*client, renamed, true);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results.front(), nodeToRename->nodeHandle());
+}
+
+TEST(NodeSearch, fullTextIndexKeptAcrossReopen)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    auto* state = dynamic_cast<mega::SqliteAccountState*>(client->sctable.get());
+    ASSERT_NE(state, nullptr);
+    if (!state->hasFullTextIndex())
+    {
+        GTEST_SKIP() << "SQLite library without FTS5 trigram tokenizer";
+    }
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    // like MegaClient, the table is always in a transaction: changes are committed with commit() + begin()
+    std::vector<mega::Node*> files;
+    for (const char* name : {"first.txt", "second.txt", "third.txt"})
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &rootNode);
+        file.attrs.map = std::map<mega::nameid, std::string>{{'n', name}};
+        std::shared_ptr<mega::Node> auxiliarNode(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+        files.push_back(&file);
+
+        client->sctable->commit();
+        client->sctable->begin();
+    }
+
+    files.front()->attrs.map['n'] = "renamed.txt";
+    client->mNodeManager.saveNodeInDb(files.front());
+    client->sctable->commit();
+    client->sctable->begin();
+
+    // closed in the middle of a transaction, as the client does
+    unsigned builds = dbAccess->fullTextIndexBuilds();
+    client->mNodeManager.reset();
+    client->sctable.reset();
+    client->opensctable();
+
+    state = dynamic_cast<mega::SqliteAccountState*>(client->sctable.get());
+    ASSERT_NE(state, nullptr);
+    ASSERT_TRUE(state->hasFullTextIndex());
+    ASSERT_EQ(dbAccess->fullTextIndexBuilds(), builds) << "Full-text index rebuilt after a reopen";
+}
+
+TEST(NodeSearch, ancestryFollowsMoves)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    // root -> folderA
+    //      -> folderB -> folderC -> file
+    std::vector<mega::Node*> folders;
+    mega::Node* parent = &rootNode;
+    for (const char* name : {"folderA", "folderB", "folderC"})
+    {
+        auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), name[6] == 'C' ? parent : &rootNode);
+        folder.attrs.map = std::map<mega::nameid, std::string>{{'n', name}};
+        std::shared_ptr<mega::Node> auxiliarNode(&folder);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+        folders.push_back(&folder);
+        parent = &folder;
+    }
+    mega::Node& folderA = *folders[0];
+    mega::Node& folderB = *folders[1];
+
+    auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), parent);
+    file.attrs.map = std::map<mega::nameid, std::string>{{'n', "picture.jpg"}};
+    std::shared_ptr<mega::Node> auxiliarNode(&file);
+    client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+
+    SearchFilter underA{"picture", "", "", folderA.nodehandle};
+    SearchFilter underB{"picture", "", "", folderB.nodehandle};
+
+    ASSERT_TRUE(client->mNodeManager.isAncestor(file.nodeHandle(), folderB.nodeHandle(), mega::CancelToken()));
+    ASSERT_TRUE(client->mNodeManager.isAncestor(file.nodeHandle(), rootNode.nodeHandle(), mega::CancelToken()));
+    ASSERT_FALSE(client->mNodeManager.isAncestor(file.nodeHandle(), folderA.nodeHandle(), mega::CancelToken()));
+    ASSERT_FALSE(client->mNodeManager.isAncestor(file.nodeHandle(), file.nodeHandle(), mega::CancelToken()));
+    ASSERT_EQ(search(*client, underA, true).size(), 0u);
+    ASSERT_EQ(search(*client, underB, true).size(), 1u);
+
+    // move folderB (and its whole subtree) into folderA
+    folderB.parenthandle = folderA.nodehandle;
+    client->mNodeManager.saveNodeInDb(&folderB);
+
+    ASSERT_TRUE(client->mNodeManager.isAncestor(file.nodeHandle(), folderA.nodeHandle(), mega::CancelToken()));
+    ASSERT_TRUE(client->mNodeManager.isAncestor(file.nodeHandle(), folderB.nodeHandle(), mega::CancelToken()));
+    ASSERT_TRUE(client->mNodeManager.isAncestor(file.nodeHandle(), rootNode.nodeHandle(), mega::CancelToken()));
+    ASSERT_EQ(search(*client, underA, true), std::vector<mega::NodeHandle>{file.nodeHandle()});
+    ASSERT_EQ(search(*client, underB, true), std::vector<mega::NodeHandle>{file.nodeHandle()});
+}
+
+TEST(NodeSearch, parallelUnserialization)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+    client->mNodeManager.setCacheLRUMaxSize(10);
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    const uint32_t numNodes = 3000;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &rootNode);
+        file.attrs.map = std::map<mega::nameid, std::string>{{101, "foo"}, {'n', "file" + std::to_string(i)}};
+        std::shared_ptr<mega::Node> auxiliarNode(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+
+    // nodes are not in RAM anymore, so they have to be unserialized
+    ASSERT_LT(client->mNodeManager.getNumberNodesInRam(), 20u);
+
+    SearchFilter filter{"file", "", "", rootNode.nodehandle};
+    client->mNodeManager.setUnserializationThreads(4);
+    auto parallelResults = search(*client, filter, false);
+    ASSERT_EQ(parallelResults.size(), numNodes);
+    ASSERT_LT(client->mNodeManager.getNumberNodesInRam(), 20u);
+
+    // several searches sharing the threads of the pool
+    std::vector<std::vector<mega::NodeHandle>> concurrentResults(3);
+    std::vector<std::thread> searchers;
+    for (size_t i = 0; i < concurrentResults.size(); ++i)
+    {
+        searchers.emplace_back([&, i]() { concurrentResults[i] = search(*client, filter, i % 2 == 0); });
+    }
+    for (auto& t : searchers)
+    {
+        t.join();
+    }
+
+    client->mNodeManager.setUnserializationThreads(0);
+    auto results = search(*client, filter, false);
+    ASSERT_EQ(parallelResults, results);
+
+    for (auto& r : concurrentResults)
+    {
+        ASSERT_EQ(r.size(), numNodes);
+    }
+}
+
+TEST(NodeSearch, bulkLoad)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    // like fetchnodes: indexes are dropped out of any transaction, then nodes are inserted
+    ASSERT_TRUE(client->sctable->inTransaction());
+    client->sctable->commit();
+    client->mNodeManager.setBulkLoadRelaxedSync(true);
+    client->mNodeManager.startBulkLoad();
+    client->sctable->begin();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    folder.attrs.map = std::map<mega::nameid, std::string>{{'n', "folder"}};
+    std::shared_ptr<mega::Node> auxiliarFolder(&folder);
+    client->mNodeManager.addNode(auxiliarFolder, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarFolder.get());
+
+    const uint32_t numNodes = 100;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &folder);
+        file.attrs.map = std::map<mega::nameid, std::string>{{'n', "file" + std::to_string(i)}};
+        std::shared_ptr<mega::Node> auxiliarNode(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+
+    client->mNodeManager.initCompleted();
+    client->sctable->commit();
+    client->sctable->begin();
+
+    ASSERT_TRUE(client->mNodeManager.ready());
+    ASSERT_EQ(rootNode.getCounter().files, numNodes);
+    ASSERT_EQ(rootNode.getCounter().folders, 1u);
+    ASSERT_EQ(client->mNodeManager.getNumberOfChildrenFromNode(folder.nodeHandle()), numNodes);
+
+    SearchFilter filter{"file1", "", "", rootNode.nodehandle};
+    ASSERT_EQ(search(*client, filter, true).size(), 11u); // file1, file10..file19
+
+    filter.location = folder.nodehandle;
+    ASSERT_EQ(search(*client, filter, false).size(), 11u);
+}
+
+TEST(NodeSearch, cursorPagination)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    // many ties in every sort key, so they're resolved by name and handle
+    for (uint32_t i = 0; i < 60; i++)
+    {
+        auto type = i % 5 ? mega::nodetype_t::FILENODE : mega::nodetype_t::FOLDERNODE;
+        auto& node = mt::makeNode(*client, type, mega::NodeHandle().set6byte(index++), &rootNode);
+        node.attrs.map = std::map<mega::nameid, std::string>{{'n', (i % 2 ? "file" : "FILE") + std::to_string(i % 7)}};
+        if (i % 3) node.attrs.map[mega::AttrMap::string2nameid("fav")] = "1";
+        if (i % 4) node.attrs.map[mega::AttrMap::string2nameid("lbl")] = std::to_string(i % 4);
+        node.size = type == mega::nodetype_t::FILENODE ? i % 6 : -1;
+        node.ctime = i % 8;
+        node.mtime = i % 9;
+        std::shared_ptr<mega::Node> auxiliarNode(&node);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+
+    mega::NodeSearchFilter filter;
+    SearchFilter f{"file", "", "", rootNode.nodehandle};
+    filter.copyFrom(f);
+
+    for (int order : {0, 1, 2, 3, 4, 5, 6, 7, 8, 17, 18, 19, 20})
+    {
+        auto all = client->mNodeManager.getChildren(filter, order, mega::CancelToken(), mega::NodeSearchPage(0, 0));
+        ASSERT_EQ(all.size(), 60u);
+
+        // pages of 7 nodes, every one starting after the last node of the previous page
+        mega::sharedNode_vector byChildren;
+        mega::sharedNode_vector bySearch;
+        mega::NodeSearchPage page(0, 7);
+        while (byChildren.size() < all.size())
+        {
+            auto children = client->mNodeManager.getChildren(filter, order, mega::CancelToken(), page);
+            ASSERT_FALSE(children.empty()) << "order " << order;
+            byChildren.insert(byChildren.end(), children.begin(), children.end());
+
+            mega::NodeSearchFilter searchFilter = filter;
+            searchFilter.byAncestors({rootNode.nodehandle, mega::UNDEF, mega::UNDEF});
+            auto found = client->mNodeManager.searchNodes(searchFilter, order, mega::CancelToken(), page);
+            bySearch.insert(bySearch.end(), found.begin(), found.end());
+
+            page = mega::NodeSearchPage(mega::NodeSearchCursor(*children.back()), 7);
+        }
+
+        ASSERT_EQ(byChildren, all) << "order " << order;
+        ASSERT_EQ(bySearch, all) << "order " << order;
+        ASSERT_TRUE(client->mNodeManager.getChildren(filter, order, mega::CancelToken(), page).empty());
+    }
+}
+
+TEST(NodeSearch, concurrentReadersAndWriter)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    folder.attrs.map = std::map<mega::nameid, std::string>{{'n', "folder"}};
+    std::shared_ptr<mega::Node> auxiliarFolder(&folder);
+    client->mNodeManager.addNode(auxiliarFolder, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarFolder.get());
+
+    client->sctable->commit();
+    client->sctable->begin();
+
+    const uint64_t firstFile = index;
+    const uint32_t numNodes = 2000;
+    std::atomic<bool> writerDone{false};
+
+    // writer: adds files to the folder, committing them in batches (like the client thread)
+    std::thread writer([&]()
+    {
+        for (uint32_t i = 0; i < numNodes; i++)
+        {
+            auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(firstFile + i), &folder);
+            file.attrs.map = std::map<mega::nameid, std::string>{{'n', "file" + std::to_string(i)}};
+            std::shared_ptr<mega::Node> auxiliarNode(&file);
+            client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+            client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+
+            if (i % 100 == 99)
+            {
+                client->sctable->commit();
+                client->sctable->begin();
+            }
+        }
+
+        writerDone = true;
+    });
+
+    // readers: results only contain files and, as nodes are only added, they never shrink
+    std::atomic<bool> unexpectedResults{false};
+    std::atomic<uint32_t> numQueries{0};
+    auto reader = [&](bool recursive)
+    {
+        SearchFilter filter{"file", "", "", recursive ? rootNode.nodehandle : folder.nodehandle};
+        size_t lastSize = 0;
+        do
+        {
+            auto results = search(*client, filter, recursive);
+            bool onlyFiles = std::all_of(results.begin(), results.end(), [firstFile](mega::NodeHandle h)
+            {
+                return h.as8byte() >= firstFile && h.as8byte() < firstFile + numNodes;
+            });
+
+            if (!onlyFiles || results.size() < lastSize)
+            {
+                unexpectedResults = true;
+            }
+
+            lastSize = results.size();
+            ++numQueries;
+        } while (!writerDone);
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back(reader, i % 2 == 0);
+    }
+
+    writer.join();
+    for (auto& r : readers)
+    {
+        r.join();
+    }
+
+    ASSERT_FALSE(unexpectedResults);
+    ASSERT_GT(numQueries, 0u);
+
+    SearchFilter filter{"file", "", "", rootNode.nodehandle};
+    ASSERT_EQ(search(*client, filter, true).size(), numNodes);
+
+    filter.location = folder.nodehandle;
+    ASSERT_EQ(search(*client, filter, false).size(), numNodes);
+    ASSERT_EQ(client->mNodeManager.getNumberOfChildrenFromNode(folder.nodeHandle()), numNodes);
+}
+
+TEST(NodeSearch, byCategory)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    auto& folder = mt::makeNode(*client, mega::nodetype_t::FOLDERNODE, mega::NodeHandle().set6byte(index++), &rootNode);
+    folder.attrs.map = std::map<mega::nameid, std::string>{{'n', "photos.jpg"}}; // folders have no category
+    std::shared_ptr<mega::Node> auxiliarFolder(&folder);
+    client->mNodeManager.addNode(auxiliarFolder, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarFolder.get());
+
+    std::map<std::string, mega::Node*> files;
+    for (const char* name : {"a.jpg", "b.png", "c.mp4", "d.pdf", "e.docx", "f.xlsx", "g", "h.zip"})
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &folder);
+        file.attrs.map = std::map<mega::nameid, std::string>{{'n', name}};
+        std::shared_ptr<mega::Node> auxiliarNode(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+        files[name] = &file;
+    }
+
+    auto count = [&client, &rootNode, &folder](int category, bool recursive)
+    {
+        SearchFilter filter{"", "", "", recursive ? rootNode.nodehandle : folder.nodehandle, category};
+        return search(*client, filter, recursive).size();
+    };
+
+    for (bool recursive : {true, false})
+    {
+        ASSERT_EQ(count(mega::MIME_TYPE_PHOTO, recursive), 2u);
+        ASSERT_EQ(count(mega::MIME_TYPE_VIDEO, recursive), 1u);
+        ASSERT_EQ(count(mega::MIME_TYPE_ALL_DOCS, recursive), 3u);
+        ASSERT_EQ(count(mega::MIME_TYPE_ARCHIVE, recursive), 1u);
+        ASSERT_EQ(count(mega::MIME_TYPE_OTHERS, recursive), 1u);
+    }
+
+    // the category is updated when the node is renamed
+    files["g"]->attrs.map['n'] = "g.gif";
+    client->mNodeManager.saveNodeInDb(files["g"]);
+    ASSERT_EQ(count(mega::MIME_TYPE_PHOTO, true), 3u);
+    ASSERT_EQ(count(mega::MIME_TYPE_OTHERS, true), 0u);
+}
+
+// Searches by substring of name, description and tags, with and without the full-text index.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the time of each one
+TEST(NodeSearch, DISABLED_fullTextIndexSearchTime)
+{
+    mega::MegaApp app;
+    mega::SqliteDbAccess* dbAccess = new mega::SqliteDbAccess(mega::LocalPath::fromAbsolutePath("."));
+
+    auto client = mt::makeClient(app, dbAccess);
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    client->opensctable();
+
+    auto* state = dynamic_cast<mega::SqliteAccountState*>(client->sctable.get());
+    ASSERT_NE(state, nullptr);
+    if (!state->hasFullTextIndex())
+    {
+        GTEST_SKIP() << "SQLite library without FTS5 trigram tokenizer";
+    }
+
+    uint64_t index = 1;
+
+    mega::NodeManager::MissingParentNodes missingParentNodes;
+    auto& rootNode = mt::makeNode(*client, mega::nodetype_t::ROOTNODE, mega::NodeHandle().set6byte(index++), nullptr);
+    std::shared_ptr<mega::Node> auxiliarRootNode(&rootNode);
+    client->mNodeManager.addNode(auxiliarRootNode, false, true, missingParentNodes);
+    client->mNodeManager.saveNodeInDb(auxiliarRootNode.get());
+
+    const mega::nameid descriptionId = mega::AttrMap::string2nameid(mega::MegaClient::NODE_ATTRIBUTE_DESCRIPTION);
+    const mega::nameid tagsId = mega::AttrMap::string2nameid(mega::MegaClient::NODE_ATTRIBUTE_TAGS);
+
+    const std::vector<std::string> words{"Report", "photo", "INVOICE", "holiday", "draft", "Beach", "budget", "scan"};
+    const uint32_t numNodes = 50000;
+    for (uint32_t i = 0; i < numNodes; i++)
+    {
+        auto& file = mt::makeNode(*client, mega::nodetype_t::FILENODE, mega::NodeHandle().set6byte(index++), &rootNode);
+        file.attrs.map[static_cast<mega::nameid>('n')] = words[i % words.size()] + "_" + std::to_string(i) + ".jpg";
+        file.attrs.map[descriptionId] = "Some " + words[(i / 3) % words.size()] + " description";
+        file.attrs.map[tagsId] = words[(i / 5) % words.size()] + ",tag" + std::to_string(i % 7);
+
+        std::shared_ptr<mega::Node> auxiliarNode(&file);
+        client->mNodeManager.addNode(auxiliarNode, false, true, missingParentNodes);
+        client->mNodeManager.saveNodeInDb(auxiliarNode.get());
+    }
+    client->sctable->commit();
+    client->sctable->begin();
+
+    const std::vector<SearchFilter> filters{
+        {"invoice_4", "", "", rootNode.nodehandle},
+        {"*lida*", "", "", rootNode.nodehandle},
+        {"", "draft desc", "", rootNode.nodehandle},
+        {"", "", "beach", rootNode.nodehandle},
+    };
+
+    for (bool useIndex : {true, false})
+    {
+        state->useFullTextIndex(useIndex);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& f : filters)
+        {
+            search(*client, f, true);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        // in the XML report (--gtest_output=xml)
+        RecordProperty(useIndex ? "fullTextIndexMicroseconds" : "userFunctionsMicroseconds", int(elapsed.count()));
+    }
+}
@@ -0,0 +1,267 @@
+/**
+ * @file NotificationQueue_test.cpp
+ * @brief Unitary tests for the queue of filesystem notifications of syncs
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace mega;
+
+TEST(BoundedMpscQueue, fullAndEmpty)
+{
+    BoundedMpscQueue<int> queue(3);
+    ASSERT_EQ(queue.capacity(), 4u);
+    ASSERT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int value = i;
+        ASSERT_TRUE(queue.tryPush(std::move(value)));
+    }
+
+    int value = 4;
+    ASSERT_FALSE(queue.tryPush(std::move(value)));
+    ASSERT_EQ(queue.size(), 4u);
+
+    // a slot is reused as soon as its value is popped
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(value, 0);
+    value = 4;
+    ASSERT_TRUE(queue.tryPush(std::move(value)));
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(BoundedMpscQueue, severalProducers)
+{
+    const int numProducers = 4;
+    const int perProducer = 200000;
+
+    BoundedMpscQueue<int> queue(256);
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&queue, p]()
+        {
+            for (int i = 0; i < perProducer; ++i)
+            {
+                int value = p * perProducer + i;
+                while (!queue.tryPush(std::move(value)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // each value once, and in order for each producer
+    std::vector<int> next(numProducers, 0);
+    for (int popped = 0; popped < numProducers * perProducer; )
+    {
+        int value;
+        if (!queue.tryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        int p = value / perProducer;
+        ASSERT_EQ(value % perProducer, next[p]++);
+        ++popped;
+    }
+
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+#ifdef ENABLE_SYNC
+
+namespace {
+
+LocalNode* fakeNode(uintptr_t n)
+{
+    // never dereferenced by the queue
+    return reinterpret_cast<LocalNode*>(n * 64);
+}
+
+Notification notification(uintptr_t node, const string& path, Notification::ScanRequirement sr = Notification::NEEDS_PARENT_SCAN)
+{
+    return Notification(0, sr, LocalPath::fromRelativePath(path), fakeNode(node));
+}
+
+} // namespace
+
+TEST(NotificationQueue, popBatchSkipsRepeats)
+{
+    NotificationQueue queue;
+
+    ASSERT_TRUE(queue.pushBack(notification(1, "a")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "b")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "a")));
+    ASSERT_TRUE(queue.pushBack(notification(2, "a")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "a", Notification::FOLDER_NEEDS_SELF_SCAN)));
+    ASSERT_TRUE(queue.pushBack(notification(1, "b")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "c")));
+
+    // the batch is filled with distinct notifications
+    vector<Notification> batch;
+    ASSERT_TRUE(queue.popBatch(batch, 4));
+    ASSERT_EQ(batch.size(), 4u);
+    ASSERT_EQ(batch[0].path, LocalPath::fromRelativePath("a"));
+    ASSERT_EQ(batch[1].path, LocalPath::fromRelativePath("b"));
+    ASSERT_EQ(batch[2].localnode, fakeNode(2));
+    ASSERT_EQ(batch[3].scanRequirement, Notification::FOLDER_NEEDS_SELF_SCAN);
+    ASSERT_EQ(queue.coalescedCount(), 1u);
+
+    // repeats are only looked for within a batch
+    ASSERT_TRUE(queue.pushBack(notification(1, "c")));
+    ASSERT_TRUE(queue.popBatch(batch, 6));
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_EQ(batch[0].path, LocalPath::fromRelativePath("b"));
+    ASSERT_EQ(batch[1].path, LocalPath::fromRelativePath("c"));
+    ASSERT_EQ(queue.coalescedCount(), 2u);
+
+    ASSERT_FALSE(queue.popBatch(batch, 6));
+    ASSERT_TRUE(batch.empty());
+}
+
+TEST(NotificationQueue, dropsWhenFull)
+{
+    NotificationQueue queue(2);
+
+    ASSERT_TRUE(queue.pushBack(notification(1, "a")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "b")));
+    ASSERT_FALSE(queue.pushBack(notification(1, "c")));
+    ASSERT_FALSE(queue.pushBack(notification(1, "d")));
+    ASSERT_EQ(queue.droppedCount(), 2u);
+
+    vector<Notification> batch;
+    ASSERT_TRUE(queue.popBatch(batch, 10));
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_TRUE(queue.pushBack(notification(1, "c")));
+}
+
+TEST(NotificationQueue, replaceLocalNodePointers)
+{
+    NotificationQueue queue;
+
+    ASSERT_TRUE(queue.pushBack(notification(1, "a")));
+    ASSERT_TRUE(queue.pushBack(notification(2, "b")));
+    ASSERT_TRUE(queue.pushBack(notification(1, "c")));
+
+    queue.replaceLocalNodePointers(fakeNode(1), (LocalNode*)~0);
+
+    vector<Notification> batch;
+    ASSERT_TRUE(queue.popBatch(batch, 10));
+    ASSERT_EQ(batch.size(), 3u);
+    ASSERT_TRUE(batch[0].invalidated());
+    ASSERT_FALSE(batch[1].invalidated());
+    ASSERT_TRUE(batch[2].invalidated());
+}
+
+// Notifications per second from 4 threads, each one repeating every notification 4 times
+// like inotify does for a file written by an untar, with the previous deque and with the queue.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the throughput
+TEST(NotificationQueue, DISABLED_throughputFromSeveralThreads)
+{
+    const int numProducers = 4;
+    const int perProducer = 250000;
+    const int repeats = 4;
+
+    auto produce = [&](std::function<void(Notification&&)> push)
+    {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; ++p)
+        {
+            producers.emplace_back([push, p]()
+            {
+                for (int i = 0; i < perProducer; ++i)
+                {
+                    push(notification(uintptr_t(p + 1), "file" + std::to_string(i / repeats)));
+                }
+            });
+        }
+        return producers;
+    };
+
+    {
+        ThreadSafeDeque<Notification> deque;
+
+        auto start = std::chrono::steady_clock::now();
+        auto producers = produce([&](Notification&& n) { deque.pushBack(std::move(n)); });
+
+        Notification n;
+        for (int popped = 0; popped < numProducers * perProducer; )
+        {
+            if (deque.popFront(n)) ++popped;
+            else std::this_thread::yield();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (auto& t : producers) t.join();
+
+        RecordProperty("dequeNotificationsPerSecond", int(numProducers * perProducer / elapsed.count()));
+    }
+
+    {
+        NotificationQueue queue;
+
+        auto start = std::chrono::steady_clock::now();
+        auto producers = produce([&](Notification&& n)
+        {
+            while (!queue.pushBack(std::move(n)))
+            {
+                std::this_thread::yield();
+            }
+        });
+
+        vector<Notification> batch;
+        size_t processed = 0;
+        while (processed + queue.coalescedCount() < size_t(numProducers * perProducer))
+        {
+            if (queue.popBatch(batch, 1024)) processed += batch.size();
+            else std::this_thread::yield();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (auto& t : producers) t.join();
+
+        RecordProperty("queueNotificationsPerSecond", int(numProducers * perProducer / elapsed.count()));
+        RecordProperty("queueRepeatsSkipped", int(queue.coalescedCount()));
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file Raid_test.cpp
+ * @brief Unitary tests for the CloudRAID parity functions
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+#include "mega/raid.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+// Splits 'data' (a multiple of RAIDLINE) into the six parts of a CloudRAID file
+std::vector<std::vector<byte>> splitRaidParts(const std::vector<byte>& data)
+{
+    size_t lines = data.size() / RAIDLINE;
+    std::vector<std::vector<byte>> parts(RAIDPARTS, std::vector<byte>(lines * RAIDSECTOR));
+    for (size_t k = 0; k < lines; ++k)
+    {
+        for (unsigned j = 1; j < RAIDPARTS; ++j)
+        {
+            for (unsigned b = 0; b < RAIDSECTOR; ++b)
+            {
+                byte v = data[k * RAIDLINE + (j - 1) * RAIDSECTOR + b];
+                parts[j][k * RAIDSECTOR + b] = v;
+                parts[0][k * RAIDSECTOR + b] ^= v;
+            }
+        }
+    }
+    return parts;
+}
+
+std::vector<byte> randomData(size_t size)
+{
+    std::mt19937 rng(static_cast<unsigned>(size));
+    std::vector<byte> data(size);
+    for (auto& b : data)
+    {
+        b = static_cast<byte>(rng());
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(Raid, combineRaidLines)
+{
+    for (size_t lines : { 1, 2, 3, 64, 1001 })
+    {
+        std::vector<byte> data = randomData(lines * RAIDLINE);
+        auto parts = splitRaidParts(data);
+
+        // no missing part, without and with parity, then each of the data parts missing
+        for (unsigned missing = 0; missing < RAIDPARTS + 1; ++missing)
+        {
+            const byte* inputs[RAIDPARTS];
+            for (unsigned j = 0; j < RAIDPARTS; ++j)
+            {
+                inputs[j] = (missing < RAIDPARTS && j == missing) ? nullptr : parts[j].data();
+            }
+
+            std::vector<byte> output(data.size() + RAIDSECTOR, 0xEE);
+            combineRaidLines(output.data(), inputs, lines);
+
+            ASSERT_TRUE(std::equal(data.begin(), data.end(), output.begin())) << lines << " lines, missing part " << missing;
+            ASSERT_EQ(output.back(), 0xEE) << "written past the end";
+        }
+    }
+}
+
+TEST(Raid, recoverRaidLines)
+{
+    const size_t lines = 257;
+    std::vector<byte> data = randomData(lines * RAIDLINE);
+    auto parts = splitRaidParts(data);
+
+    for (unsigned missing = 0; missing < EFFECTIVE_RAIDPARTS; ++missing)
+    {
+        std::vector<byte> damaged = data;
+        for (size_t k = 0; k < lines; ++k)
+        {
+            std::fill_n(damaged.begin() + static_cast<ptrdiff_t>(k * RAIDLINE + missing * RAIDSECTOR), RAIDSECTOR, byte(0));
+        }
+
+        // a single line, then the rest
+        recoverRaidLines(damaged.data(), parts[0].data(), missing, 1);
+        recoverRaidLines(damaged.data() + RAIDLINE, parts[0].data() + RAIDSECTOR, missing, lines - 1);
+        ASSERT_EQ(damaged, data) << "missing part " << missing;
+    }
+}
+
+// Throughput of the assembly of RAID lines from all the data parts and with one of them recovered from parity.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the throughput
+TEST(Raid, DISABLED_combineRaidLinesThroughput)
+{
+    const size_t lines = 64 * 1024;  // 5 MB of file data
+    const int rounds = 40;
+
+    std::vector<byte> data = randomData(lines * RAIDLINE);
+    auto parts = splitRaidParts(data);
+    std::vector<byte> output(data.size());
+
+    for (unsigned missing : { 0u, 3u })
+    {
+        const byte* inputs[RAIDPARTS];
+        for (unsigned j = 0; j < RAIDPARTS; ++j)
+        {
+            inputs[j] = (missing && j == missing) ? nullptr : parts[j].data();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            combineRaidLines(output.data(), inputs, lines);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        ASSERT_EQ(output, data);
+
+        RecordProperty(missing ? "oneMissingPartMBps" : "noMissingPartsMBps",
+                       int(double(data.size()) * rounds / (1024 * 1024) / elapsed.count()));
+    }
+}
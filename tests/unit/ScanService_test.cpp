@@ -0,0 +1,203 @@
+/**
+ * @file ScanService_test.cpp
+ * @brief Unitary tests for the scans of local folders
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Folders with files, removed at the end of the test
+class ScanTree
+{
+public:
+    ScanTree(const std::string& name, unsigned numFolders, unsigned filesPerFolder)
+        : mRoot(fs::absolute(name))
+    {
+        fs::remove_all(mRoot);
+
+        for (unsigned i = 0; i < numFolders; ++i)
+        {
+            fs::path folder = mRoot / ("d" + std::to_string(i));
+            fs::create_directories(folder);
+
+            for (unsigned j = 0; j < filesPerFolder; ++j)
+            {
+                std::ofstream(folder / ("f" + std::to_string(j))) << i << "/" << j;
+            }
+
+            mFolders.emplace_back(LocalPath::fromAbsolutePath(folder.u8string()));
+        }
+    }
+
+    ~ScanTree()
+    {
+        std::error_code ec;
+        fs::remove_all(mRoot, ec);
+    }
+
+    const std::vector<LocalPath>& folders() const { return mFolders; }
+
+private:
+    fs::path mRoot;
+    std::vector<LocalPath> mFolders;
+};
+
+struct QueuedScan
+{
+    ScanService::RequestPtr request;
+    handle owner;
+};
+
+// Queues a scan of each folder, assigned in blocks to 'numOwners' owners like the folders of several syncs
+std::vector<QueuedScan> queueScans(ScanService& service, const std::vector<LocalPath>& folders, handle numOwners, shared_ptr<Waiter> waiter)
+{
+    FSACCESS_CLASS fsAccess;
+    std::vector<QueuedScan> scans;
+
+    for (size_t i = 0; i < folders.size(); ++i)
+    {
+        auto fa = fsAccess.newfileaccess();
+        EXPECT_TRUE(fa->fopen(folders[i], FSLogging::logOnError));
+
+        handle owner = i * numOwners / folders.size();
+        scans.push_back({ service.queueScan(folders[i], fa->fsid, false, {}, waiter, owner), owner });
+    }
+
+    return scans;
+}
+
+void waitForScans(const std::vector<QueuedScan>& scans)
+{
+    for (auto& scan : scans)
+    {
+        while (!scan.request->completed())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+class ScanThreadsRestorer
+{
+public:
+    ~ScanThreadsRestorer() { ScanService::setNumThreads(mNumThreads); }
+
+private:
+    size_t mNumThreads = ScanService::numThreads();
+};
+
+} // namespace
+
+TEST(ScanService, numThreads)
+{
+    ScanThreadsRestorer restorer;
+
+    ASSERT_GE(ScanService::defaultNumThreads(), 1u);
+    ASSERT_LE(ScanService::defaultNumThreads(), 4u);
+
+    ScanService::setNumThreads(3);
+    ASSERT_EQ(ScanService::numThreads(), 3u);
+
+    ScanService::setNumThreads(0);
+    ASSERT_EQ(ScanService::numThreads(), 1u);
+}
+
+TEST(ScanService, scansFoldersOfSeveralOwners)
+{
+    ScanThreadsRestorer restorer;
+    ScanService::setNumThreads(3);
+
+    const unsigned numFolders = 40;
+    const unsigned filesPerFolder = 25;
+    ScanTree tree("scanservice_test", numFolders, filesPerFolder);
+
+    auto waiter = std::make_shared<WAIT_CLASS>();
+    ScanService service;
+    auto scans = queueScans(service, tree.folders(), 4, waiter);
+
+    // the requests already queued are scanned by the new threads
+    ScanService::setNumThreads(2);
+
+    waitForScans(scans);
+
+    for (auto& scan : scans)
+    {
+        ASSERT_EQ(scan.request->completionResult(), SCAN_SUCCESS);
+
+        auto results = scan.request->resultNodes();
+        ASSERT_EQ(results.size(), filesPerFolder);
+        for (auto& node : results)
+        {
+            ASSERT_EQ(node.type, FILENODE);
+            ASSERT_TRUE(node.fingerprint.isvalid);
+            ASSERT_NE(node.fsid, UNDEF);
+        }
+    }
+}
+
+// Scans of a synthetic tree of 1M files (1000 folders of 1000 files) split in 10 syncs,
+// with one thread and with the default number of them.
+// It takes a while to create the tree: run it with --gtest_also_run_disabled_tests
+// and --gtest_output=xml to get the throughput
+TEST(ScanService, DISABLED_scanThroughputMillionEntries)
+{
+    ScanThreadsRestorer restorer;
+
+    const unsigned numFolders = 1000;
+    const unsigned filesPerFolder = 1000;
+    ScanTree tree("scanservice_benchmark", numFolders, filesPerFolder);
+
+    auto waiter = std::make_shared<WAIT_CLASS>();
+
+    for (size_t numThreads : { size_t(1), ScanService::defaultNumThreads() })
+    {
+        ScanService::setNumThreads(numThreads);
+        ScanService service;
+
+        auto start = std::chrono::steady_clock::now();
+        auto scans = queueScans(service, tree.folders(), 10, waiter);
+        waitForScans(scans);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        size_t entries = 0;
+        for (auto& scan : scans)
+        {
+            ASSERT_EQ(scan.request->completionResult(), SCAN_SUCCESS);
+            entries += scan.request->resultNodes().size();
+        }
+        ASSERT_EQ(entries, size_t(numFolders) * filesPerFolder);
+
+        // in the XML report (--gtest_output=xml)
+        RecordProperty("entriesPerSecondWith" + std::to_string(numThreads) + "Threads",
+                       int(double(entries) / elapsed.count()));
+    }
+}
@@ -16,8 +16,10 @@
  * program.
  */
 
+#include <map>
 #include <memory>
 #include <numeric>
+#include <set>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -1139,5 +1141,273 @@ TEST_F(SyncConfigStoreTest, Write)
 
 } // SyncConfigTests
 
+namespace LocalNodeTests
+{
+
+using namespace mega;
+
+struct LocalNodeRecord
+  : public LocalNodeCore
+{
+    bool serialize(string*) const override
+    {
+        return false;
+    }
+}; // LocalNodeRecord
+
+TEST(LocalNodeCore, ScannedDetailsRoundTrip)
+{
+    LocalNodeRecord node;
+    node.type = FILENODE;
+    node.fsid_lastSynced = 3;
+    node.localname = LocalPath::fromRelativePath("f");
+    node.syncedCloudNodeHandle.set6byte(1);
+    node.syncedFingerprint.size = 100;
+    node.syncedFingerprint.mtime = 200;
+    node.syncedFingerprint.crc = { 1, 2, 3, 4 };
+    node.syncedFingerprint.isvalid = true;
+    node.scannedCtime = 1700000000123456789ll;
+
+    // Scanned as it was synced: only the ctime is stored.
+    string asSynced;
+    ASSERT_TRUE(node.write(asSynced, 7, node.fsid_lastSynced, node.syncedFingerprint));
+    {
+        LocalNodeRecord loaded;
+        uint32_t parentID = 0;
+        ASSERT_TRUE(loaded.read(asSynced, parentID));
+        EXPECT_EQ(parentID, 7u);
+        EXPECT_EQ(loaded.syncedFingerprint, node.syncedFingerprint);
+        EXPECT_EQ(loaded.scannedCtime, node.scannedCtime);
+        EXPECT_FALSE(loaded.scannedFromDb);
+    }
+
+    // Changed since it was synced: the scanned details are stored as well.
+    FileFingerprint changed = node.syncedFingerprint;
+    changed.size = 150;
+    changed.crc[0] = 9;
+
+    string pending;
+    ASSERT_TRUE(node.write(pending, 7, 4, changed));
+    {
+        LocalNodeRecord loaded;
+        uint32_t parentID = 0;
+        ASSERT_TRUE(loaded.read(pending, parentID));
+        EXPECT_EQ(loaded.syncedFingerprint, node.syncedFingerprint);
+        EXPECT_EQ(loaded.scannedCtime, node.scannedCtime);
+        ASSERT_TRUE(loaded.scannedFromDb);
+        EXPECT_EQ(loaded.scannedFromDb->fsid, 4u);
+        EXPECT_EQ(loaded.scannedFromDb->fingerprint, changed);
+    }
+
+    // Not scanned.
+    string unscanned;
+    ASSERT_TRUE(node.write(unscanned, 7, UNDEF, FileFingerprint()));
+    {
+        LocalNodeRecord loaded;
+        uint32_t parentID = 0;
+        ASSERT_TRUE(loaded.read(unscanned, parentID));
+        EXPECT_EQ(loaded.scannedCtime, 0);
+        EXPECT_FALSE(loaded.scannedFromDb);
+    }
+
+    EXPECT_LT(unscanned.size(), asSynced.size());
+    EXPECT_LT(asSynced.size(), pending.size());
+}
+
+TEST(FSNode, CanReuseFingerprint)
+{
+    FSNode known;
+    known.type = FILENODE;
+    known.fsid = 3;
+    known.fingerprint.size = 100;
+    known.fingerprint.mtime = 200;
+    known.ctime = 300;
+
+    FSNode scanned = known.clone();
+    EXPECT_TRUE(scanned.canReuseFingerprint(known));
+
+    // Rewritten keeping its size and mtime.
+    scanned.ctime = 301;
+    EXPECT_FALSE(scanned.canReuseFingerprint(known));
+
+    // Unknown ctime (from an older database), as before.
+    known.ctime = 0;
+    EXPECT_TRUE(scanned.canReuseFingerprint(known));
+
+    scanned.fingerprint.mtime = 201;
+    EXPECT_FALSE(scanned.canReuseFingerprint(known));
+
+    scanned = known.clone();
+    scanned.fsid = 4;
+    EXPECT_FALSE(scanned.canReuseFingerprint(known));
+}
+
+// Enough of a LocalNode to be stored in a ChildTable
+struct NamedChild
+{
+    LocalPath localname;
+    unique_ptr<LocalPath> slocalname;
+};
+
+vector<NamedChild> namedChildren(size_t count)
+{
+    vector<NamedChild> children(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "IMG_20240101_%06zu.jpg", i);
+        children[i].localname = LocalPath::fromRelativePath(name);
+        children[i].slocalname = std::make_unique<LocalPath>(LocalPath::fromRelativePath("IMG_" + std::to_string(i) + ".JPG"));
+    }
+    return children;
+}
+
+// Heap used by std::map nodes
+size_t gMapAllocatedBytes = 0;
+
+template<typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        gMapAllocatedBytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        gMapAllocatedBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+TEST(ChildTable, SetFindErase)
+{
+    auto children = namedChildren(1000);
+    ChildTable<NamedChild> table;
+
+    for (auto& child : children)
+    {
+        table.set(&child);
+    }
+    ASSERT_EQ(table.size(), children.size());
+
+    for (auto& child : children)
+    {
+        ASSERT_EQ(table.find(child.localname), &child);
+    }
+    ASSERT_EQ(table.find(LocalPath::fromRelativePath("missing")), nullptr);
+
+    // Another child with the same name replaces the first one.
+    NamedChild clash;
+    clash.localname = children[10].localname;
+    table.set(&clash);
+    ASSERT_EQ(table.size(), children.size());
+    ASSERT_EQ(table.find(clash.localname), &clash);
+    ASSERT_FALSE(table.erase(&children[10]));
+    ASSERT_TRUE(table.erase(&clash));
+    table.set(&children[10]);
+
+    // The entries after the removed ones are still found.
+    for (size_t i = 0; i < children.size(); i += 2)
+    {
+        ASSERT_TRUE(table.erase(&children[i]));
+    }
+    ASSERT_EQ(table.size(), children.size() / 2);
+
+    std::set<NamedChild*> iterated(table.begin(), table.end());
+    ASSERT_EQ(iterated.size(), table.size());
+
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+        ASSERT_EQ(table.find(children[i].localname), i % 2 ? &children[i] : nullptr);
+        ASSERT_EQ(iterated.count(&children[i]), i % 2);
+    }
+
+    // Tables shrink as they empty.
+    auto halfEmptyBytes = table.allocatedBytes();
+    for (size_t i = 1; i < children.size() - 2; i += 2)
+    {
+        ASSERT_TRUE(table.erase(&children[i]));
+    }
+    ASSERT_LT(table.allocatedBytes(), halfEmptyBytes);
+    ASSERT_EQ(table.find(children.back().localname), &children.back());
+
+    ASSERT_TRUE(table.erase(&children.back()));
+    ASSERT_TRUE(table.empty());
+    ASSERT_TRUE(table.begin() == table.end());
+    ASSERT_EQ(table.allocatedBytes(), sizeof(table));
+}
+
+TEST(ChildTable, ByShortname)
+{
+    auto children = namedChildren(20);
+    ChildTable<NamedChild> table(true);
+
+    for (auto& child : children)
+    {
+        table.set(&child);
+    }
+
+    ASSERT_EQ(table.find(*children[7].slocalname), &children[7]);
+    ASSERT_EQ(table.find(children[7].localname), nullptr);
+    ASSERT_TRUE(table.erase(&children[7]));
+    ASSERT_EQ(table.find(*children[7].slocalname), nullptr);
+}
+
+// Memory used to index the children of folders of several sizes by name,
+// with a std::map of copies of the names and with a ChildTable
+TEST(ChildTable, MemoryPerChild)
+{
+    using NamedChildMap = std::map<LocalPath, NamedChild*, std::less<LocalPath>,
+                                   CountingAllocator<std::pair<const LocalPath, NamedChild*>>>;
+
+    for (size_t folderSize : { 4, 32, 1000 })
+    {
+        auto children = namedChildren(folderSize);
+
+        size_t mapBytes = 0;
+        {
+            NamedChildMap map;
+            for (auto& child : children)
+            {
+                auto it = map.emplace(child.localname, &child).first;
+
+                // the copy of the name, out of the small string buffer
+                if (it->first.rawValue().capacity() > 15)
+                {
+                    mapBytes += it->first.rawValue().capacity() + 1;
+                }
+            }
+            mapBytes += gMapAllocatedBytes + sizeof(map);
+        }
+        ASSERT_EQ(gMapAllocatedBytes, 0u);
+
+        ChildTable<NamedChild> table;
+        for (auto& child : children)
+        {
+            table.set(&child);
+        }
+        size_t tableBytes = table.allocatedBytes();
+
+        ASSERT_LT(tableBytes, mapBytes) << folderSize << " children per folder";
+    }
+}
+
+} // LocalNodeTests
+
 #endif
 
@@ -21,6 +21,7 @@
 #include <mega/megaclient.h>
 #include <mega/megaapp.h>
 #include <mega/transfer.h>
+#include <mega/transferslot.h>
 
 #include "DefaultedFileSystemAccess.h"
 #include "utils.h"
@@ -29,6 +30,55 @@
 namespace
 {
 
+// Stand-in for a throttled link: each connection is limited by its window over the round trip
+// time (the bandwidth-delay product), and all of them share the capacity of the link
+struct ThrottledLink
+{
+    m_off_t capacity;
+    m_off_t perConnection;
+    mega::dstime latency = 1;
+
+    m_off_t connectionSpeed(int connections) const
+    {
+        return std::min<m_off_t>(perConnection, capacity / connections);
+    }
+};
+
+// Runs 'periods' evaluation periods of the controller with one request per connection and period,
+// and returns the connections used in each of them
+std::vector<int> runPeriods(mega::TransferConnectionController& controller, const ThrottledLink& link, int periods, mega::dstime& now, unsigned failures = 0)
+{
+    using mega::TransferConnectionController;
+
+    std::vector<int> used;
+    for (int p = 0; p < periods; ++p)
+    {
+        int connections = controller.connections();
+        used.push_back(connections);
+
+        m_off_t speed = link.connectionSpeed(connections);
+        for (int i = 0; i < connections; ++i)
+        {
+            controller.requestFinished(speed, link.latency);
+        }
+        for (unsigned i = 0; i < failures; ++i)
+        {
+            controller.requestFailed();
+        }
+
+        now += TransferConnectionController::EVALUATION_PERIOD;
+        controller.evaluate(speed * connections, now);
+    }
+    return used;
+}
+
+size_t countOf(const std::vector<int>& used, int connections)
+{
+    return static_cast<size_t>(std::count(used.begin(), used.end(), connections));
+}
+
+const m_off_t MB = 1024 * 1024;
+
 void checkTransfers(const mega::Transfer& exp, const mega::Transfer& act)
 {
     ASSERT_EQ(exp.type, act.type);
@@ -86,4 +136,70 @@ TEST(Transfer, serialize_unserialize)
     checkTransfers(tf, *newTf);
 }
 
+TEST(TransferConnectionController, growsOnHighBandwidthDelayLink)
+{
+    mega::dstime now = 100;
+    mega::TransferConnectionController controller(4, 1, 6, 16 * MB, MB, 16 * MB);
+    controller.evaluate(0, now);
+
+    // 10 MB/s per connection, 100 MB/s in total
+    auto used = runPeriods(controller, { 100 * MB, 10 * MB }, 60, now);
+
+    ASSERT_EQ(used[3], 6);
+    used.erase(used.begin(), used.begin() + 10);
+    ASSERT_GE(countOf(used, 6), used.size() * 3 / 4);
+    ASSERT_EQ(countOf(used, 6) + countOf(used, 5), used.size());
+
+    ASSERT_EQ(controller.requestSize(), 16 * MB);
+    ASSERT_EQ(controller.stats().connectionsAdded, controller.stats().connectionsRemoved + 2);
+}
+
+TEST(TransferConnectionController, shrinksOnSlowLink)
+{
+    mega::dstime now = 100;
+    mega::TransferConnectionController controller(4, 1, 6, 16 * MB, MB, 16 * MB);
+    controller.evaluate(0, now);
+
+    // a single connection is enough for 1 MB/s
+    auto used = runPeriods(controller, { MB, 10 * MB }, 60, now);
+
+    used.erase(used.begin(), used.begin() + 10);
+    ASSERT_GE(countOf(used, 1), used.size() * 3 / 4);
+    ASSERT_EQ(countOf(used, 1) + countOf(used, 2), used.size());
+
+    // a few seconds of data per request
+    ASSERT_GE(controller.requestSize(), 2 * MB);
+    ASSERT_LE(controller.requestSize(), 4 * MB);
+    ASSERT_GT(controller.stats().requestSizeChanges, 0u);
+}
+
+TEST(TransferConnectionController, findsNeededConnections)
+{
+    mega::dstime now = 100;
+    mega::TransferConnectionController controller(1, 1, 6, 16 * MB, MB, 16 * MB);
+    controller.evaluate(0, now);
 
+    // three connections of 10 MB/s fill the link
+    auto used = runPeriods(controller, { 30 * MB, 10 * MB }, 60, now);
+
+    used.erase(used.begin(), used.begin() + 10);
+    ASSERT_GE(countOf(used, 3), used.size() * 3 / 4);
+    ASSERT_EQ(countOf(used, 3) + countOf(used, 2) + countOf(used, 4), used.size());
+}
+
+TEST(TransferConnectionController, backsOffOnErrors)
+{
+    mega::dstime now = 100;
+    mega::TransferConnectionController controller(4, 1, 6, 16 * MB, MB, 16 * MB);
+    controller.evaluate(0, now);
+
+    // half of the requests fail
+    auto used = runPeriods(controller, { 100 * MB, 10 * MB }, 5, now, 4);
+
+    ASSERT_EQ(used, std::vector<int>({ 4, 3, 2, 1, 1 }));
+    ASSERT_EQ(controller.stats().connectionsRemoved, 3u);
+    ASSERT_EQ(controller.stats().connectionsAdded, 0u);
+
+    // and nothing changes until a period is over
+    ASSERT_FALSE(controller.evaluate(MB, now + mega::TransferConnectionController::EVALUATION_PERIOD - 1));
+}
@@ -0,0 +1,232 @@
+/**
+ * @file Waiter_test.cpp
+ * @brief Unitary tests for the waiter of file descriptors
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mega.h"
+
+#ifndef WIN32
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace mega;
+
+namespace {
+
+struct Pipe
+{
+    int fds[2] = { -1, -1 };
+
+    Pipe()
+    {
+        if (!pipe(fds))
+        {
+            fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        }
+    }
+
+    ~Pipe()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    int readEnd() const { return fds[0]; }
+    void signal() const { EXPECT_EQ(write(fds[1], "x", 1), 1); }
+    void drain() const
+    {
+        char buf[16];
+        while (read(fds[0], buf, sizeof buf) > 0);
+    }
+};
+
+// one waiting cycle with a timeout of 'maxds' deciseconds and the per-cycle fds
+int waitCycle(PosixWaiter& waiter, dstime maxds, const std::vector<int>& readFds = {})
+{
+    waiter.init(maxds);
+    for (int fd : readFds)
+    {
+        MEGA_FD_SET(fd, &waiter.rfds);
+        waiter.bumpmaxfd(fd);
+    }
+    return waiter.wait();
+}
+
+void checkReadiness(PosixWaiter& waiter)
+{
+    Pipe watched, cycle, idle;
+    ASSERT_GE(watched.readEnd(), 0);
+    ASSERT_GE(cycle.readEnd(), 0);
+    ASSERT_GE(idle.readEnd(), 0);
+
+    waiter.watch(watched.readEnd(), true, false);
+    waiter.watch(idle.readEnd(), true, false);
+
+    // watched fd, without adding it again in the cycle
+    watched.signal();
+    ASSERT_TRUE(waitCycle(waiter, 10) & Waiter::NEEDEXEC);
+    ASSERT_TRUE(MEGA_FD_ISSET(watched.readEnd(), &waiter.rfds));
+    ASSERT_FALSE(MEGA_FD_ISSET(idle.readEnd(), &waiter.rfds));
+    watched.drain();
+
+    // fd added only for this cycle
+    cycle.signal();
+    ASSERT_TRUE(waitCycle(waiter, 10, { cycle.readEnd() }) & Waiter::NEEDEXEC);
+    ASSERT_TRUE(MEGA_FD_ISSET(cycle.readEnd(), &waiter.rfds));
+    ASSERT_FALSE(MEGA_FD_ISSET(watched.readEnd(), &waiter.rfds));
+
+    // and not waited for in the next cycle, even if it's still readable
+    waitCycle(waiter, 1);
+    ASSERT_FALSE(MEGA_FD_ISSET(cycle.readEnd(), &waiter.rfds));
+    cycle.drain();
+
+    // a per-cycle fd closed and reopened with the same number between cycles is still waited for
+    {
+        auto closed = std::make_unique<Pipe>();
+        int fd = closed->readEnd();
+        waitCycle(waiter, 1, { fd });
+        closed.reset();
+
+        Pipe reopened;
+        ASSERT_EQ(reopened.readEnd(), fd);
+        reopened.signal();
+        ASSERT_TRUE(waitCycle(waiter, 10, { fd }) & Waiter::NEEDEXEC);
+        ASSERT_TRUE(MEGA_FD_ISSET(fd, &waiter.rfds));
+        waitCycle(waiter, 0);
+    }
+
+    // an unwatched fd isn't reported anymore
+    waiter.unwatch(watched.readEnd());
+    watched.signal();
+    waitCycle(waiter, 1);
+    ASSERT_FALSE(MEGA_FD_ISSET(watched.readEnd(), &waiter.rfds));
+
+    // notify() leaves the wait before the timeout
+    auto start = std::chrono::steady_clock::now();
+    waiter.notify();
+    ASSERT_TRUE(waitCycle(waiter, 100) & Waiter::NEEDEXEC);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    waiter.unwatch(idle.readEnd());
+}
+
+#if defined(USE_EPOLL)
+// Waiting cycles with 1000 watched sockets, as many connections of transfers, and one of them ready,
+// with epoll and with poll(). 'finished' gets the time taken by the cycles with each one
+void waitCyclesWithManyFds(int cycles, const std::function<void(bool epoll, std::chrono::steady_clock::duration)>& finished)
+{
+    const unsigned numFds = 1000;
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) || limit.rlim_cur < 2 * numFds + 64)
+    {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 2 * numFds + 64);
+        if (setrlimit(RLIMIT_NOFILE, &limit) || limit.rlim_cur < 2 * numFds + 64)
+        {
+            GTEST_SKIP() << "Not enough file descriptors available";
+        }
+    }
+
+    std::vector<Pipe> pipes(numFds);
+    for (auto& p : pipes)
+    {
+        ASSERT_GE(p.readEnd(), 0);
+    }
+
+    for (bool epoll : { true, false })
+    {
+        PosixWaiter waiter;
+        if (waiter.useEpoll(epoll) != epoll)
+        {
+            continue;
+        }
+
+        for (auto& p : pipes)
+        {
+            waiter.watch(p.readEnd(), true, false);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < cycles; ++i)
+        {
+            const Pipe& ready = pipes[(i * 7) % numFds];
+            ready.signal();
+            ASSERT_TRUE(waitCycle(waiter, 10) & Waiter::NEEDEXEC);
+            ASSERT_TRUE(MEGA_FD_ISSET(ready.readEnd(), &waiter.rfds));
+            ready.drain();
+        }
+        finished(epoll, std::chrono::steady_clock::now() - start);
+
+        for (auto& p : pipes)
+        {
+            waiter.unwatch(p.readEnd());
+        }
+    }
+}
+#endif
+
+} // namespace
+
+TEST(Waiter, watchedAndCycleFds)
+{
+    PosixWaiter waiter;
+    checkReadiness(waiter);
+}
+
+TEST(Waiter, watchedAndCycleFdsWithPoll)
+{
+    PosixWaiter waiter;
+    ASSERT_FALSE(waiter.useEpoll(false));
+    checkReadiness(waiter);
+}
+
+TEST(Waiter, manyWatchedFds)
+{
+#if defined(USE_EPOLL)
+    waitCyclesWithManyFds(200, [](bool, std::chrono::steady_clock::duration) {});
+#else
+    GTEST_SKIP() << "Built without epoll";
+#endif
+}
+
+// Latency of a waiting cycle with 1000 watched fds.
+// Run it with --gtest_also_run_disabled_tests and --gtest_output=xml to get the latency
+TEST(Waiter, DISABLED_loopLatencyWithManyFds)
+{
+#if defined(USE_EPOLL)
+    const int cycles = 2000;
+    waitCyclesWithManyFds(cycles, [cycles](bool epoll, std::chrono::steady_clock::duration elapsed)
+    {
+        RecordProperty(epoll ? "epollNanosecondsPerCycle" : "pollNanosecondsPerCycle",
+                       int(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / cycles));
+    });
+#else
+    GTEST_SKIP() << "Built without epoll";
+#endif
+}
+
+#endif